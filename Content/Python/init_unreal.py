@@ -1,59 +1,142 @@
-# Copyright 2022 Proletariat, Inc.
-
-import unreal
-import os
-import openpyxl
-
-@unreal.uclass()
-class PMXlsxImporterPythonBridgeImpl(unreal.PMXlsxImporterPythonBridge):
-
-    @unreal.ufunction(override = True)
-    def read_worksheet_names(self, absolute_file_path):
-        unreal.log("Reading xlsx file \"{0}\"".format(absolute_file_path))
-
-        workbook = openpyxl.load_workbook(absolute_file_path, read_only=True, data_only = True)
-        unreal.log("All sheet names: {0}".format(workbook.sheetnames))
-        return workbook.sheetnames
-
-    def parse_headers(self, row):
-        headers = []
-        for cell in row:
-            headers.append(cell.value)
-        return headers
-
-    @unreal.ufunction(override = True)
-    def read_worksheet(self, absolute_file_path, worksheet_name):
-        workbook = openpyxl.load_workbook(absolute_file_path, read_only=True, data_only=True)
-        worksheet = workbook[worksheet_name]
-
-        results = []
-
-        # with unreal.ScopedEditorTransaction("Import from xlsx") as transaction:
-        # with unreal.ScopedSlowTask(worksheet.rows.length, "Importing from xlsx") as slow_task:
-        # slow_task.make_dialog(True)
-        headers = None
-        row_index = 0
-        for row in worksheet.rows:
-            #if slow_task.should_cancel():
-            #    break
-            #slow_task.enter_progress_frame(i)
-
-            if headers == None:
-                headers = self.parse_headers(row)
-                continue
-
-            result = unreal.PMXlsxImporterPythonBridgeDataAssetInfo()
-
-            column_index = 0
-            for cell in row:
-                # unreal.log("{0}: {1} {2}".format(column_index, headers[column_index], cell.value))
-                # force keys and values to strings because unreal doesn't know how to convert other types automatically, and we want to pass a TMap<FString, FString> to unreal
-                result.data[str(headers[column_index])] = str(cell.value) 
-                column_index += 1
-
-            result.asset_name = result.data['Name']
-            results.append(result)
-
-            row_index += 1
-
-        return results
+# Copyright 2022 Proletariat, Inc.
+
+import unreal
+import os
+import datetime
+import openpyxl
+
+@unreal.uclass()
+class PMXlsxImporterPythonBridgeImpl(unreal.PMXlsxImporterPythonBridge):
+
+    @unreal.ufunction(override = True)
+    def read_worksheet_names(self, absolute_file_path):
+        unreal.log("Reading xlsx file \"{0}\"".format(absolute_file_path))
+
+        workbook = openpyxl.load_workbook(absolute_file_path, read_only=True, data_only = True)
+        unreal.log("All sheet names: {0}".format(workbook.sheetnames))
+        return workbook.sheetnames
+
+    def parse_cell(self, cell):
+        # Returns the typed cell and the string the C++ side sees in FPMXlsxImporterPythonBridgeDataAssetInfo::Data
+        value = cell.value
+        result = unreal.PMXlsxImporterPythonBridgeCell()
+        if value is None:
+            result.type = unreal.PMXlsxImporterCellType.EMPTY
+        elif getattr(cell, 'data_type', None) == 'e':
+            result.type = unreal.PMXlsxImporterCellType.ERROR
+        # bool is a subclass of int, so check it first
+        elif isinstance(value, bool):
+            result.type = unreal.PMXlsxImporterCellType.BOOL
+            result.number = 1.0 if value else 0.0
+        elif isinstance(value, (int, float)):
+            result.type = unreal.PMXlsxImporterCellType.NUMBER
+            result.number = float(value)
+        elif isinstance(value, (datetime.datetime, datetime.date)):
+            if not isinstance(value, datetime.datetime):
+                value = datetime.datetime.combine(value, datetime.time())
+            result.type = unreal.PMXlsxImporterCellType.DATE_TIME
+            result.date_time = unreal.DateTime(value.year, value.month, value.day, value.hour, value.minute, value.second, value.microsecond // 1000)
+            # str() of a datetime isn't ISO8601, which is what ParseDateTime expects
+            return result, value.isoformat(timespec='milliseconds') + 'Z'
+        else:
+            result.type = unreal.PMXlsxImporterCellType.STRING
+        return result, str(value)
+
+    def parse_headers(self, row):
+        headers = []
+        for cell in row:
+            headers.append(cell.value)
+        return headers
+
+    @unreal.ufunction(override = True)
+    def read_worksheet(self, absolute_file_path, worksheet_name):
+        workbook = openpyxl.load_workbook(absolute_file_path, read_only=True, data_only=True)
+        return self.parse_worksheet(workbook[worksheet_name])
+
+    @unreal.ufunction(override = True)
+    def read_worksheets(self, absolute_file_path, worksheet_names):
+        # Load the workbook once for every worksheet instead of once per worksheet
+        workbook = openpyxl.load_workbook(absolute_file_path, read_only=True, data_only=True)
+
+        results = []
+        for worksheet_name in worksheet_names:
+            if worksheet_name not in workbook.sheetnames:
+                unreal.log_error("{0} does not have a worksheet named {1}".format(absolute_file_path, worksheet_name))
+                continue
+
+            result = unreal.PMXlsxImporterPythonBridgeWorksheet()
+            result.worksheet_name = worksheet_name
+            result.rows = self.parse_worksheet(workbook[worksheet_name])
+            results.append(result)
+
+        return results
+
+    def parse_worksheet(self, worksheet):
+        results = []
+
+        # read_only worksheets stop at the last row of the <dimension> element. Some writers leave it at "A1", which
+        # would hide every row after the headers, so read to the end of the worksheet instead.
+        if worksheet.max_row is not None and worksheet.max_row <= 1:
+            worksheet.reset_dimensions()
+
+        header_row = next(worksheet.iter_rows(max_row=1), None)
+        if header_row is None:
+            return results
+        headers = self.parse_headers(header_row)
+
+        # Formatted cells pad every row out to the worksheet's last column. Only read as far as the last header.
+        while len(headers) > 0 and headers[-1] is None:
+            headers.pop()
+        if len(headers) == 0:
+            return results
+
+        header_strings = [str(header) for header in headers if header is not None]
+
+        settings = unreal.get_default_object(unreal.PMXlsxImporterSettings)
+        max_consecutive_blank_rows = settings.get_editor_property('max_consecutive_blank_rows')
+
+        # with unreal.ScopedEditorTransaction("Import from xlsx") as transaction:
+        # with unreal.ScopedSlowTask(worksheet.rows.length, "Importing from xlsx") as slow_task:
+        # slow_task.make_dialog(True)
+        num_blank_rows = 0
+        for row in worksheet.iter_rows(min_row=2, max_col=len(headers)):
+            #if slow_task.should_cancel():
+            #    break
+            #slow_task.enter_progress_frame(i)
+
+            # Only rows with values become entries, so blank rows cost nothing on the C++ side
+            result = None
+            for column_index, cell in enumerate(row):
+                # Cells without values or headers would only be thrown away
+                if cell.value is None or headers[column_index] is None:
+                    continue
+
+                if result is None:
+                    result = unreal.PMXlsxImporterPythonBridgeDataAssetInfo()
+
+                # unreal.log("{0}: {1} {2}".format(column_index, headers[column_index], cell.value))
+                # force keys and values to strings because unreal doesn't know how to convert other types automatically, and we want to pass a TMap<FString, FString> to unreal
+                # typed values go in cells so that numbers, booleans and dates don't have to be parsed from those strings
+                header = str(headers[column_index])
+                typed_cell, string_value = self.parse_cell(cell)
+                result.data[header] = string_value
+                result.cells[header] = typed_cell
+
+            if result is None:
+                num_blank_rows += 1
+                if max_consecutive_blank_rows > 0 and num_blank_rows >= max_consecutive_blank_rows:
+                    unreal.log("Stopped reading worksheet {0} after {1} blank rows. Raise Max Consecutive Blank Rows in XLSX Import settings if there is data after them.".format(worksheet.title, num_blank_rows))
+                    break
+                continue
+            num_blank_rows = 0
+
+            # Every header needs a value, so that a column that is blank in every row still exists, like it does with
+            # the native reader, instead of every row reporting that it is missing
+            for header in header_strings:
+                if header not in result.data:
+                    result.data[header] = ''
+
+            result.asset_name = result.data['Name'] if 'Name' in result.data else ''
+            results.append(result)
+
+        return results
@@ -1,379 +1,829 @@
-// Copyright 2022 Proletariat, Inc.
-
-#include "PMXlsxDataAsset.h"
-#include "Misc/DefaultValueHelper.h"
-#include "PMXlsxImporterLog.h"
-#include "Engine/AssetManager.h"
-#include "EditorAssetLibrary.h"
-#include "Exporters/Exporter.h"
-#include "UnrealExporter.h"
-
-static const TCHAR* const IMPORT_FROM_XLSX_METADATA_TAG = TEXT("ImportFromXLSX");
-
-static const TCHAR* const TRUE_TEXT = TEXT("TRUE");
-static const TCHAR* const FALSE_TEXT = TEXT("FALSE");
-
-#ifdef WITH_EDITOR
-void UPMXlsxDataAsset::ImportFromXLSX(const TMap<FString, FString>& Values, FPMXlsxImporterContextLogger& InOutErrors)
-{
-	auto ScopedErrorContext = InOutErrors.PushContext(FString::Printf(TEXT(": %s %s"), *GetClass()->GetName(), *GetName()));
-	ImportFromXLSXImpl(Values, InOutErrors);
-}
-
-void UPMXlsxDataAsset::ImportFromXLSXImpl(const TMap<FString, FString>& Values, FPMXlsxImporterContextLogger& InOutErrors)
-{
-	UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("Importing data from python to %s %s"), *GetClass()->GetName(), *GetName());
-	for (auto& kvp : Values)
-	{
-		UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("\t%s: %s"), *kvp.Key, *kvp.Value);
-	}
-
-	// Keep a copy around to see if anything actually gets changed.
-	// It would be more accurate to pull Original from what's currently checked into source control,
-	// but that would be very slow.
-	UPMXlsxDataAsset* Original = DuplicateObject(this, nullptr, GetFName());
-
-	// https://ikrima.dev/ue4guide/engine-programming/uobject-reflection/uobject-reflection/
-	UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("Iterating over properties of %s %s"), *GetClass()->GetName(), *GetName());
-	for (TFieldIterator<FProperty> PropertyIterator(GetClass(), EFieldIteratorFlags::IncludeSuper); PropertyIterator; ++PropertyIterator)
-	{
-		FString CPPName = PropertyIterator->GetNameCPP();
-		FString CPPType = PropertyIterator->GetCPPType();
-		auto ScopedErrorContext = InOutErrors.PushContext(FString::Printf(TEXT(".%s %s"), *CPPName, *CPPType));
-
-		bool bHasImportMetadata = PropertyIterator->HasMetaData(IMPORT_FROM_XLSX_METADATA_TAG);
-		if (!bHasImportMetadata)
-		{
-			UE_LOG(LogPMXlsxImporter, VeryVerbose,
-				TEXT("\tSkipping %s %s because it does not have metadata tag %s"),
-				*CPPType, *CPPName, IMPORT_FROM_XLSX_METADATA_TAG
-			);
-			continue;
-		}
-
-		const FString* Value = Values.Find(CPPName);
-		if (Value == nullptr)
-		{
-			InOutErrors.Logf(TEXT("No value found (are you missing a column named \"%s\"?)"), *CPPName);
-			continue;
-		}
-
-		ParseValue(**PropertyIterator, *Value, PropertyIterator->ContainerPtrToValuePtr<void>(this), InOutErrors);
-	}
-
-	// Telling Unreal to save a file guarantees the file becomes modified even if there aren't meaningful changes to
-	// that file's data. We only want to check out and save modified assets.
-	if (WasModified(Original))
-	{
-		if (!UEditorAssetLibrary::CheckoutLoadedAsset(this))
-		{
-			// CheckoutLoadedAsset will print its own errors, but we want to add one here so that we can
-			// properly track if the run as a whole succeeded or not.
-			InOutErrors.Logf(TEXT("Unable to checkout asset %s"), *GetName());
-			return;
-		}
-		// No reason to mark the package as dirty. We know we need to save right now.
-		if (!UEditorAssetLibrary::SaveLoadedAsset(this, /*bOnlyIfIsDirty:*/ false))
-		{
-			// SaveLoadedAsset will print its own errors, but we want to add one here so that we can
-			// properly track if the run as a whole succeeded or not.
-			InOutErrors.Logf(TEXT("Unable to save asset %s"), *GetName());
-			return;
-		}
-	}
-}
-
-void UPMXlsxDataAsset::Validate(const UPMXlsxDataAsset* Previous, FPMXlsxImporterContextLogger& InOutErrors) const
-{
-	auto ScopedErrorContext = InOutErrors.PushContext(FString::Printf(TEXT(": %s %s"), *GetClass()->GetName(), *GetName()));
-
-	ValidateImpl(InOutErrors);
-	ValidateAgainstPreviousImpl(Previous, InOutErrors);
-}
-
-void UPMXlsxDataAsset::ValidateImpl(FPMXlsxImporterContextLogger& InOutErrors) const
-{
-	UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("Validating properties of %s %s"), *GetClass()->GetName(), *GetName());
-	for (TFieldIterator<FProperty> PropertyIterator(GetClass(), EFieldIteratorFlags::IncludeSuper); PropertyIterator; ++PropertyIterator)
-	{
-		FString CPPName = PropertyIterator->GetNameCPP();
-		FString CPPType = PropertyIterator->GetCPPType();
-		auto ScopedErrorContext = InOutErrors.PushContext(FString::Printf(TEXT(".%s %s"), *CPPName, *CPPType));
-
-		bool bHasImportMetadata = PropertyIterator->HasMetaData(IMPORT_FROM_XLSX_METADATA_TAG);
-		if (!bHasImportMetadata)
-		{
-			continue;
-		}
-
-		const void* Value = PropertyIterator->ContainerPtrToValuePtr<void>(this);
-
-		if (PropertyIterator->IsA<FStructProperty>())
-		{
-			if (CPPType == TEXT("FPrimaryAssetType"))
-			{
-				ValidatePrimaryAssetType(*(const FPrimaryAssetType*)Value, InOutErrors);
-			}
-			else if (CPPType == TEXT("FPrimaryAssetId"))
-			{
-				ValidatePrimaryAssetId(*(const FPrimaryAssetId*)Value, InOutErrors);
-			}
-		}
-	}
-}
-
-bool UPMXlsxDataAsset::WasModified(UPMXlsxDataAsset* Original)
-{
-	// Export this and Original as text, then compare the text
-	// See UAssetToolsImpl::DumpAssetToTempFile
-	const FExportObjectInnerContext Context;
-	const uint32 FLAGS = PPF_ExportsNotFullyQualified | PPF_Copy | PPF_Delimited;
-
-	FStringOutputDevice OriginalArchive;
-	UExporter::ExportToOutputDevice(&Context, Original, nullptr, OriginalArchive, TEXT("copy"), 0, FLAGS, false, Original->GetOuter());
-
-	FStringOutputDevice UpdatedArchive;
-	UExporter::ExportToOutputDevice(&Context, this, nullptr, UpdatedArchive, TEXT("copy"), 0, FLAGS, false, GetOuter());
-
-	bool bWasModified = !OriginalArchive.Equals(UpdatedArchive, ESearchCase::CaseSensitive);
-	UE_LOG(LogPMXlsxImporter, Verbose, TEXT("%s %s modified"), *GetName(), bWasModified ? TEXT("WAS") : TEXT("was NOT"));
-
-	if (bWasModified)
-	{
-		UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("Orignal: %s"), *OriginalArchive);
-		UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("Updated: %s"), *UpdatedArchive);
-	}
-	else
-	{
-		UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("%s"), *OriginalArchive);
-	}
-
-	return bWasModified;
-}
-
-bool UPMXlsxDataAsset::ParseValue(FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
-{
-	if (Property.IsA<FBoolProperty>())
-	{
-		return ParseBool(Value, *(bool*)Result, InOutErrors);
-	}
-	else if (Property.IsA<FInt8Property>())
-	{
-		return ParseInt<int8>(Value, *(int8*)Result, InOutErrors);
-	}
-	else if (Property.IsA<FInt16Property>())
-	{
-		return ParseInt<int16>(Value, *(int16*)Result, InOutErrors);
-	}
-	else if (Property.IsA<FIntProperty>())
-	{
-		return ParseInt<int32>(Value, *(int32*)Result, InOutErrors);
-	}
-	else if (Property.IsA<FInt64Property>())
-	{
-		return ParseInt<int64>(Value, *(int64*)Result, InOutErrors);
-	}
-	else if (Property.IsA<FByteProperty>())
-	{
-		return ParseInt<uint8>(Value, *(uint8*)Result, InOutErrors);
-	}
-	else if (Property.IsA<FUInt16Property>())
-	{
-		return ParseInt<uint16>(Value, *(uint16*)Result, InOutErrors);
-	}
-	else if (Property.IsA<FUInt32Property>())
-	{
-		return ParseInt<uint32>(Value, *(uint32*)Result, InOutErrors);
-	}
-	// FUint64Property is not supported - see ParseInt
-
-	else if (Property.IsA<FEnumProperty>())
-	{
-		FEnumProperty* EnumProp = CastField<FEnumProperty>(&Property);
-		FNumericProperty* UnderlyingProp = EnumProp->GetUnderlyingProperty();
-		UEnum* Enum = EnumProp->GetEnum();
-		if (UnderlyingProp->IsA<FInt8Property>())
-		{
-			return ParseEnum<int8>(Value, *Enum, *(int8*)Result, InOutErrors);
-		}
-		else if (UnderlyingProp->IsA<FInt16Property>())
-		{
-			return ParseEnum<int16>(Value, *Enum, *(int16*)Result, InOutErrors);
-		}
-		else if (UnderlyingProp->IsA<FIntProperty>())
-		{
-			return ParseEnum<int32>(Value, *Enum, *(int32*)Result, InOutErrors);
-		}
-		else if (UnderlyingProp->IsA<FInt64Property>())
-		{
-			return ParseEnum<int64>(Value, *Enum, *(int64*)Result, InOutErrors);
-		}
-		else if (UnderlyingProp->IsA<FByteProperty>())
-		{
-			return ParseEnum<uint8>(Value, *Enum, *(uint8*)Result, InOutErrors);
-		}
-		else if (UnderlyingProp->IsA<FUInt16Property>())
-		{
-			return ParseEnum<uint16>(Value, *Enum, *(uint16*)Result, InOutErrors);
-		}
-		else if (UnderlyingProp->IsA<FUInt32Property>())
-		{
-			return ParseEnum<uint32>(Value, *Enum, *(uint32*)Result, InOutErrors);
-		}
-		// uint64 is not supported - see ParseEnum
-	}
-	else if (Property.IsA<FTextProperty>())
-	{
-		return ParseText(Property.GetNameCPP(), Value, *(FText*)Result, InOutErrors);
-	}
-	else if (Property.IsA<FStructProperty>())
-	{
-		const FString CPPType = Property.GetCPPType();
-
-		if (CPPType == TEXT("FDateTime"))
-		{
-			return ParseDateTime(Value, *(FDateTime*)Result, InOutErrors);
-		}
-	}
-	else if (Property.IsA<FArrayProperty>())
-	{
-		FArrayProperty* ArrayProp = CastField<FArrayProperty>(&Property);
-		return ParseArray(*ArrayProp, Value, Result, InOutErrors);
-	}
-
-	// Property is not explictly supported by this class, but maybe Unreal supports it natively
-	if (Property.ImportText(*Value, Result, PPF_None, this, &InOutErrors))
-	{
-		return true;
-	}
-
-	InOutErrors.Log(TEXT("Type not supported"));
-	return false;
-}
-
-bool UPMXlsxDataAsset::ParseBool(const FString& Value, bool& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
-{
-	if (Value.Equals(TRUE_TEXT, ESearchCase::IgnoreCase))
-	{
-		OutResult = true;
-		return true;
-	}
-	else if (Value.Equals(FALSE_TEXT, ESearchCase::IgnoreCase))
-	{
-		OutResult = false;
-		return true; // successfully parsed a false value
-	}
-
-	int32 IntResult = 0;
-	if (FDefaultValueHelper::ParseInt(Value, IntResult))
-	{
-		OutResult = (bool)IntResult;
-		return true;
-	}
-
-	AddUnableToParseError(Value, InOutErrors);
-	return false;
-}
-
-bool UPMXlsxDataAsset::ParseInt64Internal(const FString& Value, int64& OutResult)
-{
-	if (FDefaultValueHelper::ParseInt64(Value, OutResult))
-	{
-		return true;
-	}
-
-	// XLSX might save an int as, for example, "2.0". That's valid, but needs to be parsed as a double then converted to an int.
-	double DoubleResult;
-	if (FDefaultValueHelper::ParseDouble(Value, DoubleResult) && FMath::RoundToZero(DoubleResult) == DoubleResult)
-	{
-		OutResult = (int64)DoubleResult;
-		return true;
-	}
-
-	// Let the caller add the error
-	return false;
-}
-
-bool UPMXlsxDataAsset::ParseDateTime(const FString& Value, FDateTime& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
-{
-	if (FDateTime::ParseIso8601(*Value, OutResult))
-	{
-		return true;
-	}
-
-	AddUnableToParseError(Value, InOutErrors);
-	return false;
-}
-
-bool UPMXlsxDataAsset::ParseText(const FString& PropName, const FString& Value, FText& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
-{
-	OutResult = FText::FromString(Value);
-	OutResult = FText::ChangeKey(GetClass()->GetName(), FString::Printf(TEXT("%s.%s"), *GetName(), *PropName), OutResult);
-	return true;
-}
-
-bool UPMXlsxDataAsset::ParseArray(const FArrayProperty& Property, const FString& Value, void* OutResult, FPMXlsxImporterContextLogger& InOutErrors)
-{
-	// See JsonObjectConverter.cpp
-	FScriptArrayHelper ArrayHelper(&Property, OutResult);
-
-	if (Value.IsEmpty())
-	{
-		ArrayHelper.EmptyValues();
-		return true;
-	}
-
-	TArray<FString> Values;
-	// TODO support other delimiters via metadata
-	int32 ArrayLength = Value.ParseIntoArray(Values, TEXT(","), /*bCullEmpty:*/ false);
-
-	ArrayHelper.Resize(ArrayLength);
-
-	bool bAllParsed = true;
-	for (int32 Index = 0; Index < ArrayLength; ++Index)
-	{
-		auto ScopedErrorContext = InOutErrors.PushContext(FString::Printf(TEXT("[%i]"), Index));
-
-		const FString TrimmedValue = Values[Index].TrimStartAndEnd();
-		bAllParsed &= ParseValue(*Property.Inner, TrimmedValue, ArrayHelper.GetRawPtr(Index), InOutErrors);
-	}
-
-	return bAllParsed;
-}
-
-void UPMXlsxDataAsset::ValidatePrimaryAssetType(const FPrimaryAssetType& AssetType, FPMXlsxImporterContextLogger& InOutErrors) const
-{
-	if (!AssetType.IsValid())
-	{
-		return; // Explicitly invalid PrimaryAssetTypes (NAME_None) are allowed
-	}
-
-	UAssetManager& AssetManager = UAssetManager::Get();
-	FPrimaryAssetTypeInfo Info;
-	if (!AssetManager.GetPrimaryAssetTypeInfo(AssetType, Info))
-	{
-		InOutErrors.Logf(TEXT("PrimaryAssetType %s does not exist"), *AssetType.ToString());
-	}
-}
-
-void UPMXlsxDataAsset::ValidatePrimaryAssetId(const FPrimaryAssetId& AssetId, FPMXlsxImporterContextLogger& InOutErrors) const
-{
-	if (!AssetId.IsValid())
-	{
-		return; // Explictly invalid PrimaryAssetIds (NAME_None:NAME_None) are allowed
-	}
-
-	UAssetManager& AssetManager = UAssetManager::Get();
-	FAssetData AssetData;
-	if (!AssetManager.GetPrimaryAssetData(AssetId, AssetData))
-	{
-		InOutErrors.Logf(TEXT("PrimaryAssetId %s does not exist"), *AssetId.ToString());
-	}
-}
-
-void UPMXlsxDataAsset::AddUnableToParseError(const FString& Value, FPMXlsxImporterContextLogger& InOutErrors)
-{
-	InOutErrors.Logf(TEXT("Unable to parse %s"), *Value);
-}
-
-#endif
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxDataAsset.h"
+#include "Misc/DefaultValueHelper.h"
+#include "Containers/StringView.h"
+#include "PMXlsxImporterLog.h"
+#include "PMXlsxImporterEnumLookup.h"
+#include "PMXlsxImporterImportPlan.h"
+#include "PMXlsxImporterParserRegistry.h"
+#include "PMXlsxImporterPrimaryAssetSnapshot.h"
+#include "PMXlsxImporterPythonBridge.h"
+#include "PMXlsxImporterStructParsers.h"
+#include "PMXlsxImporterValueParser.h"
+#include "PMXlsxImporterWorksheet.h"
+#include "Engine/AssetManager.h"
+#include "Exporters/Exporter.h"
+#include "UnrealExporter.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+static const TCHAR* const TRUE_TEXT = TEXT("TRUE");
+static const TCHAR* const FALSE_TEXT = TEXT("FALSE");
+
+#ifdef WITH_EDITOR
+// Set by ParsePlannedValue so UPMXlsxDataAsset::ParseValue can skip resolving the parse function for the property
+// currently being imported, even when a subclass's ParseValue override is called first
+static thread_local const FPMXlsxImporterImportPlanProperty* GActivePlanProperty = nullptr;
+// Also set by ParsePlannedValue. UPMXlsxDataAsset::ParseValue only parses GActiveCell if it's asked to parse
+// GActiveValue, so overrides that pass a different string to Super::ParseValue still get that string parsed.
+static thread_local const FString* GActiveValue = nullptr;
+static thread_local const FPMXlsxImporterPythonBridgeCell* GActiveCell = nullptr;
+
+// Set by ImportStagedFromXLSX so UPMXlsxDataAsset::ImportFromXLSXImpl can apply values parsed on worker threads,
+// even when a subclass's ImportFromXLSXImpl override is called first
+static const FPMXlsxImporterImportPlanStagedRow* GStagedRow = nullptr;
+
+// Set by ImportRowFromXLSX so UPMXlsxDataAsset::ImportFromXLSXImpl can read the row straight from its worksheet,
+// including its typed cells. Values is the map passed to ImportFromXLSX, which is empty if RequiresValueMap returns false.
+struct FPMXlsxImporterImportingRow
+{
+	const FPMXlsxImporterImportPlanColumns* Columns = nullptr;
+	int32 Row = INDEX_NONE;
+	const TMap<FString, FString>* Values = nullptr;
+};
+static FPMXlsxImporterImportingRow GImportingRow;
+
+// Set by SetPrimaryAssetSnapshot while assets are validated in parallel. Only read by worker threads.
+static const FPMXlsxImporterPrimaryAssetSnapshot* GPrimaryAssetSnapshot = nullptr;
+
+bool UPMXlsxDataAsset::ImportFromXLSX(const TMap<FString, FString>& Values, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_ImportFromXLSX);
+	auto ScopedErrorContext = InOutErrors.PushObjectContext(*this);
+
+	// ImportFromXLSXImpl marks the package dirty if it modifies anything. Clear the flag first so that changes made
+	// before this import (e.g. by hand in the editor) don't count as modifications.
+	UPackage* Package = GetOutermost();
+	const bool bWasDirty = Package->IsDirty();
+	Package->SetDirtyFlag(false);
+
+	ImportFromXLSXImpl(Values, InOutErrors);
+
+	const bool bWasModified = Package->IsDirty();
+	Package->SetDirtyFlag(bWasDirty || bWasModified);
+	return bWasModified;
+}
+
+void UPMXlsxDataAsset::ImportFromXLSXImpl(const TMap<FString, FString>& Values, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	const FPMXlsxImporterImportPlan& Plan = FPMXlsxImporterImportPlan::Get(*GetClass());
+
+	// Only read from the importing row's worksheet, and use its staged row, if an override hasn't passed in different
+	// values
+	const bool bIsImportingRow = GImportingRow.Values == &Values;
+	const FPMXlsxImporterImportPlanColumns* Columns = bIsImportingRow ? GImportingRow.Columns : nullptr;
+	const FPMXlsxImporterWorksheet* Worksheet = Columns != nullptr ? &Columns->Worksheet : nullptr;
+	const int32 Row = GImportingRow.Row;
+	const FPMXlsxImporterImportPlanStagedRow* StagedRow = (bIsImportingRow && GStagedRow != nullptr && &GStagedRow->Plan == &Plan) ? GStagedRow : nullptr;
+	GStagedRow = nullptr;
+	GImportingRow = FPMXlsxImporterImportingRow();
+
+	// Columns were looked up for the plan the row was going to be imported with. Look them up again if that plan has
+	// since been rebuilt.
+	TOptional<FPMXlsxImporterImportPlanColumns> RebuiltColumns;
+	if (Columns != nullptr && &Columns->Plan != &Plan)
+	{
+		RebuiltColumns.Emplace(Plan, *Worksheet);
+		Columns = RebuiltColumns.GetPtrOrNull();
+	}
+
+	UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("Importing data from python to %s %s"), *GetClass()->GetName(), *GetName());
+	if (Worksheet != nullptr)
+	{
+		for (int32 Column = 0; Column < Worksheet->GetNumColumns(); ++Column)
+		{
+			UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("\t%s: %s"), *Worksheet->GetHeaders()[Column], *FString(Worksheet->GetValue(Row, Column)));
+		}
+	}
+	else
+	{
+		for (auto& kvp : Values)
+		{
+			UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("\t%s: %s"), *kvp.Key, *kvp.Value);
+		}
+	}
+
+	// Keep a copy of the imported properties around to see if anything actually gets changed.
+	// It would be more accurate to pull Original from what's currently checked into source control,
+	// but that would be very slow.
+	UPMXlsxDataAsset* Original = RequiresOriginalForWasModified() ? DuplicateObject(this, nullptr, GetFName()) : nullptr;
+	TOptional<FPMXlsxImporterImportPlanSnapshot> Snapshot;
+	if (Original == nullptr)
+	{
+		Snapshot.Emplace(Plan, *this);
+	}
+
+	// Values read from Worksheet are copied into ValueBuffer one at a time
+	FString ValueBuffer;
+	const TArray<FPMXlsxImporterImportPlanProperty>& PlanProperties = Plan.GetProperties();
+	for (int32 PropertyIndex = 0; PropertyIndex < PlanProperties.Num(); ++PropertyIndex)
+	{
+		const FPMXlsxImporterImportPlanProperty& PlanProperty = PlanProperties[PropertyIndex];
+		void* Result = PlanProperty.Property->ContainerPtrToValuePtr<void>(this);
+
+		if (StagedRow != nullptr && StagedRow->ParsedProperties[PropertyIndex])
+		{
+			const int32 FirstError = PropertyIndex == 0 ? 0 : StagedRow->ErrorCounts[PropertyIndex - 1];
+			InOutErrors.AppendErrors(StagedRow->Errors, FirstError, StagedRow->ErrorCounts[PropertyIndex]);
+			PlanProperty.Property->CopyCompleteValue(Result, StagedRow->ParsedValues->GetValuePtr(PlanProperty));
+			continue;
+		}
+
+		ParsePlannedProperty(PlanProperty, Worksheet, Row, Columns != nullptr ? Columns->Columns[PropertyIndex] : INDEX_NONE, &Values, ValueBuffer, Result, InOutErrors);
+	}
+
+	// Telling Unreal to save a file guarantees the file becomes modified even if there aren't meaningful changes to
+	// that file's data. We only want to check out and save modified assets, so only those are marked dirty.
+	// FPMXlsxImporterSettingsEntry::ParseData collects them to be checked out and saved together.
+	bool bWasModified = false;
+	if (Original != nullptr)
+	{
+		bWasModified = WasModified(Original);
+	}
+	else
+	{
+		const FPMXlsxImporterImportPlanProperty* ModifiedProperty = Snapshot->FindModifiedProperty(*this);
+		bWasModified = ModifiedProperty != nullptr;
+		UE_LOG(LogPMXlsxImporter, Verbose, TEXT("%s %s modified%s%s"),
+			*GetName(), bWasModified ? TEXT("WAS") : TEXT("was NOT"),
+			bWasModified ? TEXT(": ") : TEXT(""), bWasModified ? *ModifiedProperty->Name : TEXT("")
+		);
+	}
+
+	if (bWasModified)
+	{
+		GetOutermost()->SetDirtyFlag(true);
+	}
+}
+
+void UPMXlsxDataAsset::Validate(const UPMXlsxDataAsset* Previous, FPMXlsxImporterContextLogger& InOutErrors) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_ValidateAsset);
+	auto ScopedErrorContext = InOutErrors.PushObjectContext(*this);
+
+	ValidateImpl(InOutErrors);
+	ValidateAgainstPreviousImpl(Previous, InOutErrors);
+}
+
+void UPMXlsxDataAsset::ValidateImpl(FPMXlsxImporterContextLogger& InOutErrors) const
+{
+	UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("Validating properties of %s %s"), *GetClass()->GetName(), *GetName());
+	const FPMXlsxImporterImportPlan& Plan = FPMXlsxImporterImportPlan::Get(*GetClass());
+	for (const FPMXlsxImporterImportPlanProperty& PlanProperty : Plan.GetProperties())
+	{
+		if (PlanProperty.Validation == FPMXlsxImporterImportPlanProperty::EValidation::None)
+		{
+			continue;
+		}
+
+		auto ScopedErrorContext = InOutErrors.PushPropertyContext(*PlanProperty.Property);
+		const void* Value = PlanProperty.Property->ContainerPtrToValuePtr<void>(this);
+
+		if (PlanProperty.Validation == FPMXlsxImporterImportPlanProperty::EValidation::PrimaryAssetType)
+		{
+			ValidatePrimaryAssetType(*(const FPrimaryAssetType*)Value, InOutErrors);
+		}
+		else if (PlanProperty.Validation == FPMXlsxImporterImportPlanProperty::EValidation::PrimaryAssetId)
+		{
+			ValidatePrimaryAssetId(*(const FPrimaryAssetId*)Value, InOutErrors);
+		}
+	}
+}
+
+bool UPMXlsxDataAsset::WasModified(UPMXlsxDataAsset* Original)
+{
+	// Export this and Original as text, then compare the text
+	// See UAssetToolsImpl::DumpAssetToTempFile
+	const FExportObjectInnerContext Context;
+	const uint32 FLAGS = PPF_ExportsNotFullyQualified | PPF_Copy | PPF_Delimited;
+
+	FStringOutputDevice OriginalArchive;
+	UExporter::ExportToOutputDevice(&Context, Original, nullptr, OriginalArchive, TEXT("copy"), 0, FLAGS, false, Original->GetOuter());
+
+	FStringOutputDevice UpdatedArchive;
+	UExporter::ExportToOutputDevice(&Context, this, nullptr, UpdatedArchive, TEXT("copy"), 0, FLAGS, false, GetOuter());
+
+	bool bWasModified = !OriginalArchive.Equals(UpdatedArchive, ESearchCase::CaseSensitive);
+	UE_LOG(LogPMXlsxImporter, Verbose, TEXT("%s %s modified"), *GetName(), bWasModified ? TEXT("WAS") : TEXT("was NOT"));
+
+	if (bWasModified)
+	{
+		UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("Orignal: %s"), *OriginalArchive);
+		UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("Updated: %s"), *UpdatedArchive);
+	}
+	else
+	{
+		UE_LOG(LogPMXlsxImporter, VeryVerbose, TEXT("%s"), *OriginalArchive);
+	}
+
+	return bWasModified;
+}
+
+bool UPMXlsxDataAsset::ParseValue(FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	const bool bIsActivePlanProperty = GActivePlanProperty != nullptr && GActivePlanProperty->Property == &Property;
+	if (bIsActivePlanProperty && GActiveCell != nullptr && GActiveValue == &Value && GActivePlanProperty->ParseCellFunction != nullptr &&
+		GActivePlanProperty->ParseCellFunction(*this, Property, *GActiveCell, Result))
+	{
+		return true;
+	}
+
+	const FPMXlsxImporterParseFunction ParseFunction = bIsActivePlanProperty
+		? GActivePlanProperty->ParseFunction
+		: FPMXlsxImporterParserRegistry::Get().Find(Property);
+	if (ParseFunction != nullptr)
+	{
+		return ParseFunction(*this, Property, Value, Result, InOutErrors);
+	}
+
+	// Property is not explictly supported by this class, but maybe Unreal supports it natively
+	if (Property.ImportText(*Value, Result, PPF_None, this, &InOutErrors))
+	{
+		return true;
+	}
+
+	InOutErrors.Log(TEXT("Type not supported"));
+	return false;
+}
+
+void UPMXlsxDataAsset::SetPrimaryAssetSnapshot(const FPMXlsxImporterPrimaryAssetSnapshot* Snapshot)
+{
+	check(IsInGameThread());
+	GPrimaryAssetSnapshot = Snapshot;
+}
+
+void UPMXlsxDataAsset::StageFromXLSX(FPMXlsxImporterImportPlanStagedRow& Row)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_StageFromXLSX);
+	const TArray<FPMXlsxImporterImportPlanProperty>& PlanProperties = Row.Plan.GetProperties();
+	Row.ParsedValues = MakeUnique<FPMXlsxImporterImportPlanSnapshot>(Row.Plan, *this);
+	Row.ParsedProperties.Init(false, PlanProperties.Num());
+	Row.ErrorCounts.SetNumUninitialized(PlanProperties.Num());
+	FString ValueBuffer;
+
+	for (int32 PropertyIndex = 0; PropertyIndex < PlanProperties.Num(); ++PropertyIndex)
+	{
+		const FPMXlsxImporterImportPlanProperty& PlanProperty = PlanProperties[PropertyIndex];
+		if (PlanProperty.bCanParseOnWorkerThreads)
+		{
+			ParsePlannedProperty(PlanProperty, &Row.Columns.Worksheet, Row.Row, Row.Columns.Columns[PropertyIndex], nullptr, ValueBuffer, Row.ParsedValues->GetValuePtr(PlanProperty), Row.Errors);
+			Row.ParsedProperties[PropertyIndex] = true;
+		}
+		Row.ErrorCounts[PropertyIndex] = Row.Errors.Num();
+	}
+}
+
+bool UPMXlsxDataAsset::ImportStagedFromXLSX(const FPMXlsxImporterImportPlanStagedRow& Row, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	check(IsInGameThread());
+	TGuardValue<const FPMXlsxImporterImportPlanStagedRow*> StagedRowGuard(GStagedRow, &Row);
+	return ImportRowFromXLSX(Row.Columns, Row.Row, InOutErrors);
+}
+
+bool UPMXlsxDataAsset::ImportRowFromXLSX(const FPMXlsxImporterImportPlanColumns& Columns, int32 Row, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	check(IsInGameThread());
+	TMap<FString, FString> Values;
+	if (RequiresValueMap())
+	{
+		Columns.Worksheet.MakeValueMap(Row, Values);
+	}
+
+	FPMXlsxImporterImportingRow ImportingRow;
+	ImportingRow.Columns = &Columns;
+	ImportingRow.Row = Row;
+	ImportingRow.Values = &Values;
+	TGuardValue<FPMXlsxImporterImportingRow> ImportingRowGuard(GImportingRow, ImportingRow);
+	return ImportFromXLSX(Values, InOutErrors);
+}
+
+bool UPMXlsxDataAsset::ImportRowFromXLSX(const FPMXlsxImporterWorksheet& Worksheet, int32 Row, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	const FPMXlsxImporterImportPlanColumns Columns(FPMXlsxImporterImportPlan::Get(*GetClass()), Worksheet);
+	return ImportRowFromXLSX(Columns, Row, InOutErrors);
+}
+
+void UPMXlsxDataAsset::ParsePlannedProperty(const FPMXlsxImporterImportPlanProperty& PlanProperty, const FPMXlsxImporterWorksheet* Worksheet, int32 Row, int32 Column, const TMap<FString, FString>* Values, FString& ValueBuffer, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	auto ScopedErrorContext = InOutErrors.PushPropertyContext(*PlanProperty.Property);
+
+	const FString* Value = nullptr;
+	FPMXlsxImporterPythonBridgeCell Cell;
+	bool bHasCell = false;
+	if (Worksheet != nullptr)
+	{
+		if (Column != INDEX_NONE)
+		{
+			Worksheet->CopyValue(Row, Column, ValueBuffer);
+			Value = &ValueBuffer;
+			if (PlanProperty.ParseCellFunction != nullptr)
+			{
+				Cell = Worksheet->GetCell(Row, Column);
+				bHasCell = true;
+			}
+		}
+	}
+	else if (Values != nullptr)
+	{
+		Value = Values->FindByHash(PlanProperty.NameHash, PlanProperty.Name);
+	}
+
+	if (Value == nullptr)
+	{
+		InOutErrors.Logf(TEXT("No value found (are you missing a column named \"%s\"?)"), *PlanProperty.Name);
+		return;
+	}
+
+	ParsePlannedValue(PlanProperty, *Value, bHasCell ? &Cell : nullptr, Result, InOutErrors);
+}
+
+bool UPMXlsxDataAsset::ParsePlannedValue(const FPMXlsxImporterImportPlanProperty& PlanProperty, const FString& Value, const FPMXlsxImporterPythonBridgeCell* Cell, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	TGuardValue<const FPMXlsxImporterImportPlanProperty*> ActivePlanPropertyGuard(GActivePlanProperty, &PlanProperty);
+	TGuardValue<const FString*> ActiveValueGuard(GActiveValue, &Value);
+	TGuardValue<const FPMXlsxImporterPythonBridgeCell*> ActiveCellGuard(GActiveCell, Cell);
+	return ParseValue(*PlanProperty.Property, Value, Result, InOutErrors);
+}
+
+void UPMXlsxDataAsset::RegisterDefaultParsers(FPMXlsxImporterParserRegistry& Registry)
+{
+	// None of these load objects or modify the asset they parse for
+	Registry.RegisterPropertyParser(FBoolProperty::StaticClass(), &ParseBoolProperty, /*bThreadSafe:*/ true, &ParseBoolCell);
+
+	Registry.RegisterPropertyParser(FInt8Property::StaticClass(), &ParseIntProperty<int8>, /*bThreadSafe:*/ true, &ParseIntCell<int8>);
+	Registry.RegisterPropertyParser(FInt16Property::StaticClass(), &ParseIntProperty<int16>, /*bThreadSafe:*/ true, &ParseIntCell<int16>);
+	Registry.RegisterPropertyParser(FIntProperty::StaticClass(), &ParseIntProperty<int32>, /*bThreadSafe:*/ true, &ParseIntCell<int32>);
+	Registry.RegisterPropertyParser(FInt64Property::StaticClass(), &ParseIntProperty<int64>, /*bThreadSafe:*/ true, &ParseIntCell<int64>);
+	Registry.RegisterPropertyParser(FByteProperty::StaticClass(), &ParseIntProperty<uint8>, /*bThreadSafe:*/ true, &ParseIntCell<uint8>);
+	Registry.RegisterPropertyParser(FUInt16Property::StaticClass(), &ParseIntProperty<uint16>, /*bThreadSafe:*/ true, &ParseIntCell<uint16>);
+	Registry.RegisterPropertyParser(FUInt32Property::StaticClass(), &ParseIntProperty<uint32>, /*bThreadSafe:*/ true, &ParseIntCell<uint32>);
+	// FUint64Property is not supported - see ParseInt
+
+	// Parsed from strings by ImportText, same as if they had no parser, but number cells can skip the string
+	Registry.RegisterPropertyParser(FFloatProperty::StaticClass(), &ParseFloatProperty, /*bThreadSafe:*/ true, &ParseFloatCell<float>);
+	Registry.RegisterPropertyParser(FDoubleProperty::StaticClass(), &ParseFloatProperty, /*bThreadSafe:*/ true, &ParseFloatCell<double>);
+	// Same as ImportText, which doesn't load anything for names either, but lets FName arrays be parsed in bulk
+	Registry.RegisterPropertyParser(FNameProperty::StaticClass(), &ParseNameProperty, /*bThreadSafe:*/ true);
+
+	Registry.RegisterEnumParser(FInt8Property::StaticClass(), &ParseEnumProperty<int8>, /*bThreadSafe:*/ true, &ParseEnumCell<int8>);
+	Registry.RegisterEnumParser(FInt16Property::StaticClass(), &ParseEnumProperty<int16>, /*bThreadSafe:*/ true, &ParseEnumCell<int16>);
+	Registry.RegisterEnumParser(FIntProperty::StaticClass(), &ParseEnumProperty<int32>, /*bThreadSafe:*/ true, &ParseEnumCell<int32>);
+	Registry.RegisterEnumParser(FInt64Property::StaticClass(), &ParseEnumProperty<int64>, /*bThreadSafe:*/ true, &ParseEnumCell<int64>);
+	Registry.RegisterEnumParser(FByteProperty::StaticClass(), &ParseEnumProperty<uint8>, /*bThreadSafe:*/ true, &ParseEnumCell<uint8>);
+	Registry.RegisterEnumParser(FUInt16Property::StaticClass(), &ParseEnumProperty<uint16>, /*bThreadSafe:*/ true, &ParseEnumCell<uint16>);
+	Registry.RegisterEnumParser(FUInt32Property::StaticClass(), &ParseEnumProperty<uint32>, /*bThreadSafe:*/ true, &ParseEnumCell<uint32>);
+	// uint64 is not supported - see ParseEnum
+
+	Registry.RegisterPropertyParser(FTextProperty::StaticClass(), &ParseTextProperty, /*bThreadSafe:*/ true);
+	Registry.RegisterPropertyParser(FArrayProperty::StaticClass(), &ParseArrayProperty, /*bThreadSafe:*/ true);
+
+	Registry.RegisterStructParser(TBaseStructure<FDateTime>::Get(), &ParseDateTimeProperty, /*bThreadSafe:*/ true, &ParseDateTimeCell);
+	// FVector, FPrimaryAssetId, FGameplayTag and the other engine structs that would otherwise need ImportText
+	FPMXlsxImporterStructParsers::Register(Registry);
+}
+
+bool UPMXlsxDataAsset::ParseBoolProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	return Asset.ParseBool(Value, *(bool*)Result, InOutErrors);
+}
+
+template<typename TInt>
+bool UPMXlsxDataAsset::ParseIntProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	return Asset.ParseInt<TInt>(Value, *(TInt*)Result, InOutErrors);
+}
+
+template<typename TInt>
+bool UPMXlsxDataAsset::ParseEnumProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	return Asset.ParseEnum<TInt>(Value, *CastFieldChecked<FEnumProperty>(&Property)->GetEnum(), *(TInt*)Result, InOutErrors);
+}
+
+bool UPMXlsxDataAsset::ParseTextProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	return Asset.ParseText(Property.GetNameCPP(), Value, *(FText*)Result, InOutErrors);
+}
+
+bool UPMXlsxDataAsset::ParseDateTimeProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	return Asset.ParseDateTime(Value, *(FDateTime*)Result, InOutErrors);
+}
+
+bool UPMXlsxDataAsset::ParseArrayProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	return Asset.ParseArray(*CastFieldChecked<FArrayProperty>(&Property), Value, Result, InOutErrors);
+}
+
+bool UPMXlsxDataAsset::ParseFloatProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	// ImportText converts through a double too, so this gives the same result for the numbers it accepts
+	double DoubleResult = 0.0;
+	if (FPMXlsxImporterValueParser::ParseDouble(FStringView(*Value, Value.Len()), DoubleResult))
+	{
+		CastFieldChecked<FNumericProperty>(&Property)->SetFloatingPointPropertyValue(Result, DoubleResult);
+		return true;
+	}
+
+	if (Property.ImportText(*Value, Result, PPF_None, &Asset, &InOutErrors))
+	{
+		return true;
+	}
+
+	Asset.AddUnableToParseError(Value, InOutErrors);
+	return false;
+}
+
+bool UPMXlsxDataAsset::ParseNameProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	*(FName*)Result = FName(*Value);
+	return true;
+}
+
+bool UPMXlsxDataAsset::CellToInt64(const FPMXlsxImporterPythonBridgeCell& Cell, int64& OutResult)
+{
+	// -2^63 and 2^63 are exact as doubles, unlike the int64 limits
+	if (Cell.Type != EPMXlsxImporterCellType::Number || FMath::RoundToZero(Cell.Number) != Cell.Number ||
+		Cell.Number < -9223372036854775808.0 || Cell.Number >= 9223372036854775808.0)
+	{
+		return false;
+	}
+
+	OutResult = (int64)Cell.Number;
+	return true;
+}
+
+bool UPMXlsxDataAsset::ParseBoolCell(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result)
+{
+	if (Cell.Type == EPMXlsxImporterCellType::Bool)
+	{
+		*(bool*)Result = Cell.Number != 0.0;
+		return true;
+	}
+
+	// Same as ParseBool, which accepts integers
+	int64 IntResult = 0;
+	if (CellToInt64(Cell, IntResult))
+	{
+		*(bool*)Result = IntResult != 0;
+		return true;
+	}
+	return false;
+}
+
+template<typename TInt>
+bool UPMXlsxDataAsset::ParseIntCell(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result)
+{
+	// Out of range values are left to ParseInt to report
+	int64 Result64 = 0;
+	if (!CellToInt64(Cell, Result64) || Result64 < (int64)TNumericLimits<TInt>::Min() || Result64 > (int64)TNumericLimits<TInt>::Max())
+	{
+		return false;
+	}
+
+	*(TInt*)Result = (TInt)Result64;
+	return true;
+}
+
+template<typename TInt>
+bool UPMXlsxDataAsset::ParseEnumCell(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result)
+{
+	int64 Result64 = 0;
+	if (!CellToInt64(Cell, Result64) || !FPMXlsxImporterEnumLookup::Get(*CastFieldChecked<FEnumProperty>(&Property)->GetEnum()).IsValidValue(Result64))
+	{
+		return false;
+	}
+
+	*(TInt*)Result = (TInt)Result64;
+	return true;
+}
+
+template<typename TFloat>
+bool UPMXlsxDataAsset::ParseFloatCell(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result)
+{
+	if (Cell.Type != EPMXlsxImporterCellType::Number)
+	{
+		return false;
+	}
+
+	*(TFloat*)Result = (TFloat)Cell.Number;
+	return true;
+}
+
+bool UPMXlsxDataAsset::ParseDateTimeCell(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result)
+{
+	if (Cell.Type != EPMXlsxImporterCellType::DateTime)
+	{
+		return false;
+	}
+
+	*(FDateTime*)Result = Cell.DateTime;
+	return true;
+}
+
+bool UPMXlsxDataAsset::ParseBool(const FString& Value, bool& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	if (Value.Equals(TRUE_TEXT, ESearchCase::IgnoreCase))
+	{
+		OutResult = true;
+		return true;
+	}
+	else if (Value.Equals(FALSE_TEXT, ESearchCase::IgnoreCase))
+	{
+		OutResult = false;
+		return true; // successfully parsed a false value
+	}
+
+	int32 IntResult = 0;
+	if (FDefaultValueHelper::ParseInt(Value, IntResult))
+	{
+		OutResult = (bool)IntResult;
+		return true;
+	}
+
+	AddUnableToParseError(Value, InOutErrors);
+	return false;
+}
+
+bool UPMXlsxDataAsset::ParseInt64Internal(const FString& Value, int64& OutResult)
+{
+	// Handles almost every cell, including "2.0", without FDefaultValueHelper's validation pass and conversion
+	if (FPMXlsxImporterValueParser::ParseInt64(FStringView(*Value, Value.Len()), OutResult))
+	{
+		return true;
+	}
+
+	if (FDefaultValueHelper::ParseInt64(Value, OutResult))
+	{
+		return true;
+	}
+
+	// XLSX might save an int as, for example, "2.0". That's valid, but needs to be parsed as a double then converted to an int.
+	double DoubleResult;
+	if (FDefaultValueHelper::ParseDouble(Value, DoubleResult) && FMath::RoundToZero(DoubleResult) == DoubleResult)
+	{
+		OutResult = (int64)DoubleResult;
+		return true;
+	}
+
+	// Let the caller add the error
+	return false;
+}
+
+bool UPMXlsxDataAsset::ParseEnumInternal(const FString& Value, const UEnum& EnumType, int64& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	const FPMXlsxImporterEnumLookup& Lookup = FPMXlsxImporterEnumLookup::Get(EnumType);
+	if (Lookup.FindValueByName(FStringView(*Value, Value.Len()), OutResult))
+	{
+		return true;
+	}
+
+	if (ParseInt64Internal(Value, OutResult))
+	{
+		if (Lookup.IsValidValue(OutResult))
+		{
+			return true;
+		}
+
+		InOutErrors.Logf(TEXT("%lld is not a valid value for %s"), OutResult, *EnumType.GetName());
+		return false;
+	}
+
+	AddUnableToParseError(Value, InOutErrors);
+	return false;
+}
+
+bool UPMXlsxDataAsset::ParseDateTime(const FString& Value, FDateTime& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	// Dates written by either reader are parsed by the first one. Date cells without a date format end up as numbers.
+	const FStringView ValueView(*Value, Value.Len());
+	if (FPMXlsxImporterValueParser::ParseIso8601(ValueView, OutResult) || FDateTime::ParseIso8601(*Value, OutResult) ||
+		FPMXlsxImporterValueParser::ParseSerialDate(ValueView, OutResult))
+	{
+		return true;
+	}
+
+	AddUnableToParseError(Value, InOutErrors);
+	return false;
+}
+
+bool UPMXlsxDataAsset::ParseText(const FString& PropName, const FString& Value, FText& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	OutResult = FText::FromString(Value);
+	OutResult = FText::ChangeKey(GetClass()->GetName(), FString::Printf(TEXT("%s.%s"), *GetName(), *PropName), OutResult);
+	return true;
+}
+
+// Returns the index of the first Delimiter in Value at or after Start, or Value.Len() if there isn't one.
+// Case sensitive, like FString::ParseIntoArray.
+static int32 FindArrayDelimiter(FStringView Value, FStringView Delimiter, int32 Start)
+{
+	const int32 Last = Value.Len() - Delimiter.Len();
+	for (int32 Index = Start; Index <= Last; ++Index)
+	{
+		if (Value[Index] == Delimiter[0] && FCString::Strncmp(Value.GetData() + Index, Delimiter.GetData(), Delimiter.Len()) == 0)
+		{
+			return Index;
+		}
+	}
+	return Value.Len();
+}
+
+// Empty elements count, so there's always one more element than there are delimiters
+static int32 CountArrayElements(FStringView Value, FStringView Delimiter)
+{
+	int32 NumElements = 1;
+	for (int32 Index = FindArrayDelimiter(Value, Delimiter, 0); Index < Value.Len(); Index = FindArrayDelimiter(Value, Delimiter, Index + Delimiter.Len()))
+	{
+		++NumElements;
+	}
+	return NumElements;
+}
+
+// Calls ParseElement(Index, Element) with each trimmed element of Value, which are views into Value. Returns whether
+// every call returned true.
+template<typename TParseElement>
+static bool ForEachArrayElement(FStringView Value, FStringView Delimiter, TParseElement ParseElement)
+{
+	bool bAllParsed = true;
+	int32 Index = 0;
+	int32 Start = 0;
+	for (;;)
+	{
+		const int32 End = FindArrayDelimiter(Value, Delimiter, Start);
+		bAllParsed &= ParseElement(Index++, Value.Mid(Start, End - Start).TrimStartAndEnd());
+		if (End == Value.Len())
+		{
+			return bAllParsed;
+		}
+		Start = End + Delimiter.Len();
+	}
+}
+
+// Reuses Buffer's allocation for the next element
+static const FString& CopyArrayElement(FStringView Element, FString& Buffer)
+{
+	Buffer.Reset(Element.Len());
+	Buffer.AppendChars(Element.GetData(), Element.Len());
+	return Buffer;
+}
+
+bool UPMXlsxDataAsset::ParseArray(const FArrayProperty& Property, const FString& Value, void* OutResult, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	// See JsonObjectConverter.cpp
+	FScriptArrayHelper ArrayHelper(&Property, OutResult);
+
+	if (Value.IsEmpty())
+	{
+		ArrayHelper.EmptyValues();
+		return true;
+	}
+
+	// Arrays imported by the plan already know their delimiter
+	const bool bIsActivePlanProperty = GActivePlanProperty != nullptr && GActivePlanProperty->Property == &Property;
+	FString PropertyDelimiter;
+	if (!bIsActivePlanProperty)
+	{
+		PropertyDelimiter = FPMXlsxImporterImportPlan::GetArrayDelimiter(Property);
+	}
+	const FString& Delimiter = bIsActivePlanProperty ? GActivePlanProperty->ArrayDelimiter : PropertyDelimiter;
+	const FStringView ValueView(*Value, Value.Len());
+	const FStringView DelimiterView(*Delimiter, Delimiter.Len());
+
+	// Elements are parsed straight into the array, so it's only resized once
+	ArrayHelper.Resize(CountArrayElements(ValueView, DelimiterView));
+
+	// Unless this class's ParseValue handles them itself, or their parser has been replaced in the registry, the most
+	// common element types are parsed in bulk, straight from each view. Elements the view parsers don't accept are
+	// copied into ElementBuffer, which is only allocated once, and parsed by the same functions as single values,
+	// which also report any errors.
+	FProperty& Inner = *Property.Inner;
+	const FPMXlsxImporterParseFunction InnerParseFunction = CanParseArraysInBulk() ? FPMXlsxImporterParserRegistry::Get().Find(Inner) : nullptr;
+	FString ElementBuffer;
+
+	if (Inner.GetClass() == FIntProperty::StaticClass() && InnerParseFunction == &ParseIntProperty<int32>)
+	{
+		int32* Elements = (int32*)ArrayHelper.GetRawPtr(0);
+		return ForEachArrayElement(ValueView, DelimiterView, [this, Elements, &ElementBuffer, &InOutErrors](int32 Index, FStringView Element)
+		{
+			int64 Result64 = 0;
+			if (FPMXlsxImporterValueParser::ParseInt64(Element, Result64) && Result64 >= MIN_int32 && Result64 <= MAX_int32)
+			{
+				Elements[Index] = (int32)Result64;
+				return true;
+			}
+
+			auto ScopedErrorContext = InOutErrors.PushIndexContext(Index);
+			return ParseInt<int32>(CopyArrayElement(Element, ElementBuffer), Elements[Index], InOutErrors);
+		});
+	}
+
+	if (Inner.GetClass() == FFloatProperty::StaticClass() && InnerParseFunction == &ParseFloatProperty)
+	{
+		float* Elements = (float*)ArrayHelper.GetRawPtr(0);
+		return ForEachArrayElement(ValueView, DelimiterView, [this, &Inner, Elements, &ElementBuffer, &InOutErrors](int32 Index, FStringView Element)
+		{
+			double DoubleResult = 0.0;
+			if (FPMXlsxImporterValueParser::ParseDouble(Element, DoubleResult))
+			{
+				Elements[Index] = (float)DoubleResult;
+				return true;
+			}
+
+			auto ScopedErrorContext = InOutErrors.PushIndexContext(Index);
+			return ParseFloatProperty(*this, Inner, CopyArrayElement(Element, ElementBuffer), &Elements[Index], InOutErrors);
+		});
+	}
+
+	if (Inner.GetClass() == FNameProperty::StaticClass() && InnerParseFunction == &ParseNameProperty)
+	{
+		// Names are made straight from each view
+		FName* Elements = (FName*)ArrayHelper.GetRawPtr(0);
+		return ForEachArrayElement(ValueView, DelimiterView, [Elements](int32 Index, FStringView Element)
+		{
+			Elements[Index] = FName(Element.Len(), Element.GetData());
+			return true;
+		});
+	}
+
+	const FEnumProperty* InnerEnumProperty = CastField<FEnumProperty>(&Inner);
+	if (InnerEnumProperty != nullptr && InnerParseFunction == &ParseEnumProperty<uint8>)
+	{
+		const UEnum& Enum = *InnerEnumProperty->GetEnum();
+		const FPMXlsxImporterEnumLookup& Lookup = FPMXlsxImporterEnumLookup::Get(Enum);
+		uint8* Elements = (uint8*)ArrayHelper.GetRawPtr(0);
+		return ForEachArrayElement(ValueView, DelimiterView, [this, &Enum, &Lookup, Elements, &ElementBuffer, &InOutErrors](int32 Index, FStringView Element)
+		{
+			int64 Result64 = 0;
+			if (Lookup.FindValueByName(Element, Result64) || (FPMXlsxImporterValueParser::ParseInt64(Element, Result64) && Lookup.IsValidValue(Result64)))
+			{
+				Elements[Index] = (uint8)Result64;
+				return true;
+			}
+
+			auto ScopedErrorContext = InOutErrors.PushIndexContext(Index);
+			return ParseEnum<uint8>(CopyArrayElement(Element, ElementBuffer), Enum, Elements[Index], InOutErrors);
+		});
+	}
+
+	// Everything else goes through ParseValue, so overrides still see each element
+	return ForEachArrayElement(ValueView, DelimiterView, [this, &Inner, &ArrayHelper, &ElementBuffer, &InOutErrors](int32 Index, FStringView Element)
+	{
+		auto ScopedErrorContext = InOutErrors.PushIndexContext(Index);
+		return ParseValue(Inner, CopyArrayElement(Element, ElementBuffer), ArrayHelper.GetRawPtr(Index), InOutErrors);
+	});
+}
+
+void UPMXlsxDataAsset::ValidatePrimaryAssetType(const FPrimaryAssetType& AssetType, FPMXlsxImporterContextLogger& InOutErrors) const
+{
+	if (!AssetType.IsValid())
+	{
+		return; // Explicitly invalid PrimaryAssetTypes (NAME_None) are allowed
+	}
+
+	if (GPrimaryAssetSnapshot != nullptr)
+	{
+		if (!GPrimaryAssetSnapshot->HasPrimaryAssetType(AssetType))
+		{
+			InOutErrors.Logf(TEXT("PrimaryAssetType %s does not exist"), *AssetType.ToString());
+		}
+		return;
+	}
+
+	UAssetManager& AssetManager = UAssetManager::Get();
+	FPrimaryAssetTypeInfo Info;
+	if (!AssetManager.GetPrimaryAssetTypeInfo(AssetType, Info))
+	{
+		InOutErrors.Logf(TEXT("PrimaryAssetType %s does not exist"), *AssetType.ToString());
+	}
+}
+
+void UPMXlsxDataAsset::ValidatePrimaryAssetId(const FPrimaryAssetId& AssetId, FPMXlsxImporterContextLogger& InOutErrors) const
+{
+	if (!AssetId.IsValid())
+	{
+		return; // Explictly invalid PrimaryAssetIds (NAME_None:NAME_None) are allowed
+	}
+
+	if (GPrimaryAssetSnapshot != nullptr)
+	{
+		if (!GPrimaryAssetSnapshot->HasPrimaryAssetId(AssetId))
+		{
+			InOutErrors.Logf(TEXT("PrimaryAssetId %s does not exist"), *AssetId.ToString());
+		}
+		return;
+	}
+
+	UAssetManager& AssetManager = UAssetManager::Get();
+	FAssetData AssetData;
+	if (!AssetManager.GetPrimaryAssetData(AssetId, AssetData))
+	{
+		InOutErrors.Logf(TEXT("PrimaryAssetId %s does not exist"), *AssetId.ToString());
+	}
+}
+
+void UPMXlsxDataAsset::AddUnableToParseError(const FString& Value, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	InOutErrors.Logf(TEXT("Unable to parse %s"), *Value);
+}
+
+#endif
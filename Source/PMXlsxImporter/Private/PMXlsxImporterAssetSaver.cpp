@@ -0,0 +1,210 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterAssetSaver.h"
+#include "PMXlsxDataAsset.h"
+#include "PMXlsxImporterLog.h"
+#include "PMXlsxImporterStats.h"
+#include "ISourceControlModule.h"
+#include "ISourceControlProvider.h"
+#include "SourceControlOperations.h"
+#include "SourceControlHelpers.h"
+#include "FileHelpers.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Misc/ScopeExit.h"
+
+FPMXlsxImporterAssetSaver::FPMXlsxImporterAssetSaver()
+	: Provider(ISourceControlModule::Get().GetProvider())
+{
+}
+
+FPMXlsxImporterAssetSaver::FPMXlsxImporterAssetSaver(ISourceControlProvider& InProvider)
+	: Provider(InProvider)
+{
+}
+
+void FPMXlsxImporterAssetSaver::Add(UPMXlsxDataAsset& Asset, const FString& Workbook, const FString& Worksheet)
+{
+	Assets.Add({ &Asset, Workbook, Worksheet });
+}
+
+void FPMXlsxImporterAssetSaver::CheckOutAndSave(FPMXlsxImporterContextLogger& InOutErrors, FPMXlsxImporterStats* Stats)
+{
+	if (Assets.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<UPackage*> Packages;
+	Packages.Reserve(Assets.Num());
+	for (int32 Index = 0; Index < Assets.Num(); ++Index)
+	{
+		const FAsset& Asset = Assets[Index];
+		if (!Asset.Asset.IsValid())
+		{
+			auto ScopedErrorContext = InOutErrors.PushWorksheetContext(Asset.Workbook, Asset.Worksheet);
+			InOutErrors.Log(TEXT("A modified asset was garbage collected before it could be saved"));
+			continue;
+		}
+
+		UPackage* Package = Asset.Asset->GetOutermost();
+		if (!PackageAssets.Contains(Package))
+		{
+			PackageAssets.Add(Package, Index);
+			Packages.Add(Package);
+		}
+	}
+	ON_SCOPE_EXIT
+	{
+		Assets.Reset();
+		PackageAssets.Reset();
+	};
+
+	UE_LOG(LogPMXlsxImporter, Log, TEXT("Checking out and saving %i modified assets"), Packages.Num());
+
+	TArray<UPackage*> PackagesToSave;
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_CheckOut);
+		FPMXlsxImporterStats::FScopedTimer Timer(Stats, EPMXlsxImporterPhase::CheckOut, FString());
+		PackagesToSave = CheckOut(Packages, InOutErrors);
+	}
+	if (PackagesToSave.Num() == 0)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_Save);
+	FPMXlsxImporterStats::FScopedTimer Timer(Stats, EPMXlsxImporterPhase::Save, FString());
+
+	// SavePackages prints its own errors but doesn't say which packages failed. Packages that fail to save stay
+	// dirty, so check each one to properly track if the run as a whole succeeded or not.
+	UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, /*bOnlyDirty:*/ false);
+	int32 NumSaved = 0;
+	for (UPackage* Package : PackagesToSave)
+	{
+		if (Package->IsDirty())
+		{
+			LogPackageError(InOutErrors, *Package, FString::Printf(TEXT("Unable to save asset %s"), *Package->GetName()));
+		}
+		else
+		{
+			++NumSaved;
+		}
+	}
+
+	if (Stats != nullptr)
+	{
+		Stats->FindOrAddRow(FString()).NumAssetsSaved += NumSaved;
+	}
+}
+
+TArray<UPackage*> FPMXlsxImporterAssetSaver::CheckOut(const TArray<UPackage*>& Packages, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	if (!Provider.IsEnabled())
+	{
+		// No source control, e.g. the "None" provider. Nothing to check out.
+		return Packages;
+	}
+
+	TArray<UPackage*> PackagesToSave;
+	if (!Provider.IsAvailable())
+	{
+		for (const UPackage* Package : Packages)
+		{
+			LogPackageError(InOutErrors, *Package, FString::Printf(TEXT("Unable to checkout asset %s: source control is unavailable"), *Package->GetName()));
+		}
+		return PackagesToSave;
+	}
+
+	const TArray<FString> Filenames = SourceControlHelpers::PackageFilenames(Packages);
+
+	// Update every file's status in one operation so that the GetState calls below only read the provider's cache
+	if (Provider.Execute(ISourceControlOperation::Create<FUpdateStatus>(), Filenames) != ECommandResult::Succeeded)
+	{
+		for (const UPackage* Package : Packages)
+		{
+			LogPackageError(InOutErrors, *Package, FString::Printf(TEXT("Unable to checkout asset %s: could not query source control state"), *Package->GetName()));
+		}
+		return PackagesToSave;
+	}
+
+	TArray<UPackage*> PackagesToCheckOut;
+	TArray<FString> FilenamesToCheckOut;
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
+	{
+		UPackage* Package = Packages[Index];
+		const FSourceControlStatePtr State = Provider.GetState(Filenames[Index], EStateCacheUsage::Use);
+		if (!State.IsValid())
+		{
+			LogPackageError(InOutErrors, *Package, FString::Printf(TEXT("Unable to checkout asset %s: source control state is invalid"), *Package->GetName()));
+		}
+		else if (State->IsCheckedOut() || State->IsAdded() || !State->IsSourceControlled())
+		{
+			PackagesToSave.Add(Package);
+		}
+		else if (State->CanCheckout())
+		{
+			PackagesToCheckOut.Add(Package);
+			FilenamesToCheckOut.Add(Filenames[Index]);
+		}
+		else
+		{
+			FString CheckedOutBy;
+			if (State->IsCheckedOutOther(&CheckedOutBy))
+			{
+				LogPackageError(InOutErrors, *Package, FString::Printf(TEXT("Unable to checkout asset %s: checked out by %s"), *Package->GetName(), *CheckedOutBy));
+			}
+			else if (!State->IsCurrent())
+			{
+				LogPackageError(InOutErrors, *Package, FString::Printf(TEXT("Unable to checkout asset %s: not at the latest revision"), *Package->GetName()));
+			}
+			else
+			{
+				LogPackageError(InOutErrors, *Package, FString::Printf(TEXT("Unable to checkout asset %s"), *Package->GetName()));
+			}
+		}
+	}
+
+	if (FilenamesToCheckOut.Num() == 0)
+	{
+		return PackagesToSave;
+	}
+
+	// A failed checkout may still have checked out some of the files, so check the result file by file either way
+	Provider.Execute(ISourceControlOperation::Create<FCheckOut>(), FilenamesToCheckOut);
+	for (int32 Index = 0; Index < PackagesToCheckOut.Num(); ++Index)
+	{
+		const FSourceControlStatePtr State = Provider.GetState(FilenamesToCheckOut[Index], EStateCacheUsage::Use);
+		if (State.IsValid() && State->IsCheckedOut())
+		{
+			PackagesToSave.Add(PackagesToCheckOut[Index]);
+		}
+		else
+		{
+			LogPackageError(InOutErrors, *PackagesToCheckOut[Index], FString::Printf(TEXT("Unable to checkout asset %s"), *PackagesToCheckOut[Index]->GetName()));
+		}
+	}
+
+	return PackagesToSave;
+}
+
+void FPMXlsxImporterAssetSaver::LogPackageError(FPMXlsxImporterContextLogger& InOutErrors, const UPackage& Package, const FString& Message) const
+{
+	const int32* Index = PackageAssets.Find(&Package);
+	if (Index == nullptr)
+	{
+		InOutErrors.Log(*Message);
+		return;
+	}
+
+	const FAsset& Asset = Assets[*Index];
+	auto ScopedErrorContext = InOutErrors.PushWorksheetContext(Asset.Workbook, Asset.Worksheet);
+	if (const UPMXlsxDataAsset* DataAsset = Asset.Asset.Get())
+	{
+		auto ScopedAssetContext = InOutErrors.PushObjectContext(*DataAsset);
+		InOutErrors.Log(*Message);
+	}
+	else
+	{
+		InOutErrors.Log(*Message);
+	}
+}
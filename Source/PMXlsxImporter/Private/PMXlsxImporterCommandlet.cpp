@@ -1,34 +1,60 @@
-// Copyright 2022 Proletariat, Inc.
-
-#include "PMXlsxImporterCommandlet.h"
-#include "PMXlsxImporterLog.h"
-#include "PMXlsxImporterSettings.h"
-#include "PMXlsxImporterContextLogger.h"
-
-int32 UPMXlsxImporterCommandlet::Main(const FString& Params)
-{
-	const TCHAR* CHECKED_OUT_SWTICH = TEXT("c");
-
-	TArray<FString> Tokens;
-	TArray<FString> Switches;
-	ParseCommandLine(*Params, Tokens, Switches);
-
-	// From PythonScriptCommandlet.cpp: tick once to ensure that any start-up scripts have been run
-	FTicker::GetCoreTicker().Tick(0.0f);
-
-	const UPMXlsxImporterSettings* SettingsCDO = GetDefault<UPMXlsxImporterSettings>();
-	FPMXlsxImporterContextLogger Errors;
-	if (Switches.Contains(CHECKED_OUT_SWTICH))
-	{
-		SettingsCDO->ImportCheckedOut(Errors);
-	}
-	else
-	{
-		SettingsCDO->ImportAll(Errors);
-	}
-
-	UE_LOG(LogPMXlsxImporter, Log, TEXT("Import run completed with %i errors"), Errors.Num());
-	Errors.Flush();
-
-	return Errors.Num();
-}
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterCommandlet.h"
+#include "PMXlsxImporterLog.h"
+#include "PMXlsxImporterSettings.h"
+#include "PMXlsxImporterContextLogger.h"
+#include "PMXlsxImporterErrorReport.h"
+#include "PMXlsxImporterStats.h"
+
+int32 UPMXlsxImporterCommandlet::Main(const FString& Params)
+{
+	const TCHAR* CHECKED_OUT_SWTICH = TEXT("c");
+	const TCHAR* FULL_IMPORT_SWITCH = TEXT("full");
+	const TCHAR* STREAMING_SWITCH = TEXT("streaming");
+	const TCHAR* REPORT_PARAM = TEXT("report=");
+	const TCHAR* STATS_PARAM = TEXT("stats=");
+
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	ParseCommandLine(*Params, Tokens, Switches);
+
+	// From PythonScriptCommandlet.cpp: tick once to ensure that any start-up scripts have been run
+	FTicker::GetCoreTicker().Tick(0.0f);
+
+	if (Switches.Contains(STREAMING_SWITCH))
+	{
+		// Not saved to config, so only this run streams
+		GetMutableDefault<UPMXlsxImporterSettings>()->bStreamingImport = true;
+	}
+
+	const UPMXlsxImporterSettings* SettingsCDO = GetDefault<UPMXlsxImporterSettings>();
+	FPMXlsxImporterContextLogger Errors;
+	FPMXlsxImporterStats Stats;
+	const bool bFullImport = Switches.Contains(FULL_IMPORT_SWITCH);
+	if (Switches.Contains(CHECKED_OUT_SWTICH))
+	{
+		SettingsCDO->ImportCheckedOut(Errors, bFullImport, &Stats);
+	}
+	else
+	{
+		SettingsCDO->ImportAll(Errors, bFullImport, &Stats);
+	}
+
+	UE_LOG(LogPMXlsxImporter, Log, TEXT("Import run completed with %i errors"), Errors.Num());
+	Errors.Flush();
+
+	FString ReportPath;
+	if (FParse::Value(*Params, REPORT_PARAM, ReportPath))
+	{
+		FPMXlsxImporterErrorReport::Write(Errors, FPaths::ConvertRelativePathToFull(ReportPath));
+	}
+
+	FString StatsPath;
+	if (FParse::Value(*Params, STATS_PARAM, StatsPath))
+	{
+		Stats.WriteCsv(FPaths::ConvertRelativePathToFull(StatsPath));
+	}
+
+	return Errors.Num();
+}
@@ -1,48 +1,201 @@
-// Copyright 2022 Proletariat, Inc.
-
-#include "PMXlsxImporterContextLogger.h"
-#include "PMXlsxImporterLog.h"
-
-FPMXlsxImporterContextLogger::FPMXlsxImporterContextLogger()
-{
-}
-
-void FPMXlsxImporterContextLogger::Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const FName& Category)
-{
-	FString Context = FString::Join(ContextStack, TEXT(""));
-	Errors.Add(FString::Printf(TEXT("%s: %s"), *Context, V));
-}
-
-void FPMXlsxImporterContextLogger::Flush()
-{
-	for (const FString& Err : Errors)
-	{
-		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s"), *Err);
-	}
-}
-
-FPMXlsxImporterContextLoggerScopedContext FPMXlsxImporterContextLogger::PushContext(const FString& Context)
-{
-	ContextStack.Add(Context);
-	return FPMXlsxImporterContextLoggerScopedContext(*this);
-}
-
-void FPMXlsxImporterContextLogger::PopContext()
-{
-	ContextStack.Pop();
-}
-
-int32 FPMXlsxImporterContextLogger::Num() const
-{
-	return Errors.Num();
-}
-
-FPMXlsxImporterContextLoggerScopedContext::FPMXlsxImporterContextLoggerScopedContext(FPMXlsxImporterContextLogger& Owner)
-	: Owner(Owner)
-{
-}
-
-FPMXlsxImporterContextLoggerScopedContext::~FPMXlsxImporterContextLoggerScopedContext()
-{
-	Owner.PopContext();
-}
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterContextLogger.h"
+#include "PMXlsxImporterLog.h"
+
+FPMXlsxImporterContextLogger::FPMXlsxImporterContextLogger()
+{
+}
+
+void FPMXlsxImporterContextLogger::Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const FName& Category)
+{
+	FPMXlsxImporterErrorRecord& Error = Errors.AddDefaulted_GetRef();
+	Error.Message = V;
+	Error.Severity = Verbosity == ELogVerbosity::Warning ? EPMXlsxImporterErrorSeverity::Warning : EPMXlsxImporterErrorSeverity::Error;
+	ApplyContext(Error);
+}
+
+void FPMXlsxImporterContextLogger::Flush()
+{
+	for (const FPMXlsxImporterErrorRecord& Err : Errors)
+	{
+		if (Err.Severity == EPMXlsxImporterErrorSeverity::Warning)
+		{
+			UE_LOG(LogPMXlsxImporter, Warning, TEXT("%s: %s"), *Err.Context, *Err.Message);
+		}
+		else
+		{
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: %s"), *Err.Context, *Err.Message);
+		}
+	}
+}
+
+FPMXlsxImporterContextLoggerScopedContext FPMXlsxImporterContextLogger::PushContext(const FString& Context)
+{
+	FContextFrame& Frame = ContextStack.AddDefaulted_GetRef();
+	Frame.Type = FContextFrame::EType::String;
+	Frame.Index = OwnedStrings.Add(Context);
+	return FPMXlsxImporterContextLoggerScopedContext(*this);
+}
+
+FPMXlsxImporterContextLoggerScopedContext FPMXlsxImporterContextLogger::PushLiteralContext(const TCHAR* Literal)
+{
+	FContextFrame& Frame = ContextStack.AddDefaulted_GetRef();
+	Frame.Type = FContextFrame::EType::Literal;
+	Frame.Literal = Literal;
+	return FPMXlsxImporterContextLoggerScopedContext(*this);
+}
+
+FPMXlsxImporterContextLoggerScopedContext FPMXlsxImporterContextLogger::PushNameContext(FName Name)
+{
+	FContextFrame& Frame = ContextStack.AddDefaulted_GetRef();
+	Frame.Type = FContextFrame::EType::Name;
+	Frame.Name = Name;
+	return FPMXlsxImporterContextLoggerScopedContext(*this);
+}
+
+FPMXlsxImporterContextLoggerScopedContext FPMXlsxImporterContextLogger::PushIndexContext(int32 Index)
+{
+	FContextFrame& Frame = ContextStack.AddDefaulted_GetRef();
+	Frame.Type = FContextFrame::EType::Index;
+	Frame.Index = Index;
+	return FPMXlsxImporterContextLoggerScopedContext(*this);
+}
+
+FPMXlsxImporterContextLoggerScopedContext FPMXlsxImporterContextLogger::PushPropertyContext(const FProperty& Property)
+{
+	FContextFrame& Frame = ContextStack.AddDefaulted_GetRef();
+	Frame.Type = FContextFrame::EType::Property;
+	Frame.Property = &Property;
+	return FPMXlsxImporterContextLoggerScopedContext(*this);
+}
+
+FPMXlsxImporterContextLoggerScopedContext FPMXlsxImporterContextLogger::PushObjectContext(const UObject& Object)
+{
+	FContextFrame& Frame = ContextStack.AddDefaulted_GetRef();
+	Frame.Type = FContextFrame::EType::Object;
+	Frame.Object = &Object;
+	return FPMXlsxImporterContextLoggerScopedContext(*this);
+}
+
+FPMXlsxImporterContextLoggerScopedContext FPMXlsxImporterContextLogger::PushWorksheetContext(const FString& Workbook, const FString& Worksheet)
+{
+	FContextFrame& Frame = ContextStack.AddDefaulted_GetRef();
+	Frame.Type = FContextFrame::EType::Worksheet;
+	Frame.Sheet.Workbook = &Workbook;
+	Frame.Sheet.Worksheet = &Worksheet;
+	return FPMXlsxImporterContextLoggerScopedContext(*this);
+}
+
+FPMXlsxImporterContextLoggerScopedContext FPMXlsxImporterContextLogger::PushRowContext(int32 Row)
+{
+	FContextFrame& Frame = ContextStack.AddDefaulted_GetRef();
+	Frame.Type = FContextFrame::EType::Row;
+	Frame.Index = Row;
+	return FPMXlsxImporterContextLoggerScopedContext(*this);
+}
+
+void FPMXlsxImporterContextLogger::PopContext()
+{
+	if (ContextStack.Last().Type == FContextFrame::EType::String)
+	{
+		OwnedStrings.Pop();
+	}
+	ContextStack.Pop();
+}
+
+int32 FPMXlsxImporterContextLogger::Num() const
+{
+	return Errors.Num();
+}
+
+void FPMXlsxImporterContextLogger::AppendErrors(const FPMXlsxImporterContextLogger& Other, int32 StartIndex, int32 EndIndex)
+{
+	check(&Other != this);
+	if (StartIndex >= EndIndex)
+	{
+		return;
+	}
+
+	for (int32 Index = StartIndex; Index < EndIndex; ++Index)
+	{
+		FPMXlsxImporterErrorRecord& Error = Errors.Add_GetRef(Other.Errors[Index]);
+		ApplyContext(Error);
+	}
+}
+
+FString FPMXlsxImporterContextLogger::FormatPropertyContext(const FProperty& Property)
+{
+	return FString::Printf(TEXT(".%s %s"), *Property.GetNameCPP(), *Property.GetCPPType());
+}
+
+void FPMXlsxImporterContextLogger::ApplyContext(FPMXlsxImporterErrorRecord& Error) const
+{
+	// Error's own fields came from context deeper than this whole stack, so they win. Within the stack, newer frames win.
+	FPMXlsxImporterErrorRecord Outer;
+	FString Context;
+	for (const FContextFrame& Frame : ContextStack)
+	{
+		switch (Frame.Type)
+		{
+		case FContextFrame::EType::String:
+			Context += OwnedStrings[Frame.Index];
+			break;
+		case FContextFrame::EType::Literal:
+			Context += Frame.Literal;
+			break;
+		case FContextFrame::EType::Name:
+			Context += Frame.Name.ToString();
+			break;
+		case FContextFrame::EType::Index:
+			Context += FString::Printf(TEXT("[%i]"), Frame.Index);
+			if (!Outer.Property.IsEmpty())
+			{
+				Outer.Property += FString::Printf(TEXT("[%i]"), Frame.Index);
+			}
+			break;
+		case FContextFrame::EType::Property:
+			Context += FormatPropertyContext(*Frame.Property);
+			// Columns are named after the property they're imported into
+			Outer.Property = Frame.Property->GetNameCPP();
+			Outer.Column = Outer.Property;
+			break;
+		case FContextFrame::EType::Object:
+			Context += FString::Printf(TEXT(": %s %s"), *Frame.Object->GetClass()->GetName(), *Frame.Object->GetName());
+			Outer.Asset = Frame.Object->GetPathName();
+			break;
+		case FContextFrame::EType::Worksheet:
+			Context += FString::Printf(TEXT("%s:%s"), **Frame.Sheet.Workbook, **Frame.Sheet.Worksheet);
+			Outer.Workbook = *Frame.Sheet.Workbook;
+			Outer.Worksheet = *Frame.Sheet.Worksheet;
+			break;
+		case FContextFrame::EType::Row:
+			Outer.Row = Frame.Index;
+			break;
+		}
+	}
+
+	Error.Context = Context + Error.Context;
+	for (FString FPMXlsxImporterErrorRecord::* Field : { &FPMXlsxImporterErrorRecord::Workbook, &FPMXlsxImporterErrorRecord::Worksheet,
+		&FPMXlsxImporterErrorRecord::Column, &FPMXlsxImporterErrorRecord::Asset, &FPMXlsxImporterErrorRecord::Property })
+	{
+		if ((Error.*Field).IsEmpty())
+		{
+			Error.*Field = MoveTemp(Outer.*Field);
+		}
+	}
+	if (Error.Row == 0)
+	{
+		Error.Row = Outer.Row;
+	}
+}
+
+FPMXlsxImporterContextLoggerScopedContext::FPMXlsxImporterContextLoggerScopedContext(FPMXlsxImporterContextLogger& Owner)
+	: Owner(Owner)
+{
+}
+
+FPMXlsxImporterContextLoggerScopedContext::~FPMXlsxImporterContextLoggerScopedContext()
+{
+	Owner.PopContext();
+}
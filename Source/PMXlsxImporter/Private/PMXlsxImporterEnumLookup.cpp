@@ -0,0 +1,145 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterEnumLookup.h"
+#include "PMXlsxImporterLog.h"
+#include "Misc/ScopeRWLock.h"
+
+static TMap<const UEnum*, TUniquePtr<FPMXlsxImporterEnumLookup>> GEnumLookups;
+// Tables replaced because their enum changed. Other threads may still be using them, so they're kept until ResetCache.
+static TArray<TUniquePtr<FPMXlsxImporterEnumLookup>> GSupersededEnumLookups;
+// Enums are parsed on worker threads, so tables can be built from any thread. Tables are only destroyed by
+// ResetCache, so references to them stay valid after the lock is released.
+static FRWLock GEnumLookupsLock;
+
+// FNV-1a of the lower case characters, so that names that compare equal ignoring case hash the same
+static uint32 HashEnumName(FStringView Name)
+{
+	uint32 Hash = 2166136261u;
+	for (int32 Index = 0; Index < Name.Len(); ++Index)
+	{
+		Hash = (Hash ^ (uint32)FChar::ToLower(Name[Index])) * 16777619u;
+	}
+	return Hash;
+}
+
+const FPMXlsxImporterEnumLookup& FPMXlsxImporterEnumLookup::Get(const UEnum& Enum)
+{
+	{
+		FReadScopeLock ReadLock(GEnumLookupsLock);
+		const TUniquePtr<FPMXlsxImporterEnumLookup>* ExistingLookup = GEnumLookups.Find(&Enum);
+		if (ExistingLookup != nullptr && (*ExistingLookup)->IsUpToDate(Enum))
+		{
+			return **ExistingLookup;
+		}
+	}
+
+	// Another thread may have built it in the meantime
+	FWriteScopeLock WriteLock(GEnumLookupsLock);
+	TUniquePtr<FPMXlsxImporterEnumLookup>& Lookup = GEnumLookups.FindOrAdd(&Enum);
+	if (!Lookup.IsValid() || !Lookup->IsUpToDate(Enum))
+	{
+		if (Lookup.IsValid())
+		{
+			GSupersededEnumLookups.Add(MoveTemp(Lookup));
+		}
+		Lookup.Reset(new FPMXlsxImporterEnumLookup(Enum));
+	}
+	return *Lookup;
+}
+
+void FPMXlsxImporterEnumLookup::ResetCache()
+{
+	check(IsInGameThread());
+	FWriteScopeLock WriteLock(GEnumLookupsLock);
+	GEnumLookups.Reset();
+	GSupersededEnumLookups.Reset();
+}
+
+FPMXlsxImporterEnumLookup::FPMXlsxImporterEnumLookup(const UEnum& InEnum)
+	: Enum(&InEnum)
+	, NumEnums(InEnum.NumEnums())
+	, bStripsNamespace(InEnum.GetCppForm() == UEnum::ECppForm::Regular)
+{
+	UE_LOG(LogPMXlsxImporter, Verbose, TEXT("Building name lookup for enum %s"), *InEnum.GetName());
+
+	// Up to three names per entry, with buckets at most half full
+	Buckets.Init(INDEX_NONE, FMath::RoundUpToPowerOfTwo(FMath::Max(NumEnums * 6, 8)));
+	Entries.Reserve(NumEnums * 3);
+	Values.Reserve(NumEnums);
+
+	// Same order as GetValueByNameString, which returns the first entry with any matching name
+	for (int32 Index = 0; Index < NumEnums; ++Index)
+	{
+		const int64 Value = InEnum.GetValueByIndex(Index);
+		AddName(InEnum.GetNameByIndex(Index).ToString(), Value);
+		AddName(InEnum.GetNameStringByIndex(Index), Value);
+		AddName(InEnum.GetAuthoredNameStringByIndex(Index), Value);
+		Values.Add(Value);
+	}
+}
+
+bool FPMXlsxImporterEnumLookup::IsUpToDate(const UEnum& InEnum) const
+{
+	return Enum.Get() == &InEnum && NumEnums == InEnum.NumEnums();
+}
+
+void FPMXlsxImporterEnumLookup::AddName(const FString& Name, int64 Value)
+{
+	const FStringView NameView(*Name, Name.Len());
+	if (Name.IsEmpty() || FindEntry(NameView) != nullptr)
+	{
+		return;
+	}
+
+	const int32 EntryIndex = Entries.Num();
+	FEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Name = Name;
+	Entry.Hash = HashEnumName(NameView);
+	Entry.Value = Value;
+
+	const uint32 Mask = Buckets.Num() - 1;
+	uint32 Bucket = Entry.Hash & Mask;
+	while (Buckets[Bucket] != INDEX_NONE)
+	{
+		Bucket = (Bucket + 1) & Mask;
+	}
+	Buckets[Bucket] = EntryIndex;
+}
+
+const FPMXlsxImporterEnumLookup::FEntry* FPMXlsxImporterEnumLookup::FindEntry(FStringView Name) const
+{
+	const uint32 Hash = HashEnumName(Name);
+	const uint32 Mask = Buckets.Num() - 1;
+	for (uint32 Bucket = Hash & Mask; Buckets[Bucket] != INDEX_NONE; Bucket = (Bucket + 1) & Mask)
+	{
+		const FEntry& Entry = Entries[Buckets[Bucket]];
+		if (Entry.Hash == Hash && Entry.Name.Len() == Name.Len() && FCString::Strnicmp(*Entry.Name, Name.GetData(), Name.Len()) == 0)
+		{
+			return &Entry;
+		}
+	}
+	return nullptr;
+}
+
+bool FPMXlsxImporterEnumLookup::FindValueByName(FStringView Name, int64& OutValue) const
+{
+	const FEntry* Entry = Name.IsEmpty() ? nullptr : FindEntry(Name);
+	if (Entry == nullptr && bStripsNamespace)
+	{
+		for (int32 Index = 0; Index + 1 < Name.Len(); ++Index)
+		{
+			if (Name[Index] == TEXT(':') && Name[Index + 1] == TEXT(':'))
+			{
+				Entry = FindEntry(Name.Mid(Index + 2));
+				break;
+			}
+		}
+	}
+
+	if (Entry == nullptr)
+	{
+		return false;
+	}
+	OutValue = Entry->Value;
+	return true;
+}
@@ -0,0 +1,56 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+// Hash table of one UEnum's names and values, so that UPMXlsxDataAsset::ParseEnum doesn't have to build and compare
+// the names of every entry for each cell like UEnum::GetValueByNameString does. Tables are built the first time an
+// enum is parsed in each import run, and rebuilt if the enum has been reloaded or its entries have changed.
+class FPMXlsxImporterEnumLookup
+{
+public:
+	// Returns the table for Enum, building it if necessary. Safe to call from any thread. The table stays valid until
+	// ResetCache, even if a later call replaces it because the enum changed.
+	static const FPMXlsxImporterEnumLookup& Get(const UEnum& Enum);
+
+	// Throws away every table. Game thread only, and not while an import is running. Called at the start of each
+	// import run, along with FPMXlsxImporterImportPlan::ResetCache.
+	static void ResetCache();
+
+	// Same as UEnum::GetValueByNameString(Name, EGetByNameFlags::CheckAuthoredName): case insensitive, matching each
+	// entry's full name (e.g. "EMyEnum::Value"), short name ("Value") and authored name.
+	bool FindValueByName(FStringView Name, int64& OutValue) const;
+
+	// Same as UEnum::IsValidEnumValue
+	bool IsValidValue(int64 Value) const
+	{
+		return Values.Contains(Value);
+	}
+
+private:
+	struct FEntry
+	{
+		FString Name;
+		uint32 Hash = 0;
+		int64 Value = 0;
+	};
+
+	explicit FPMXlsxImporterEnumLookup(const UEnum& InEnum);
+
+	bool IsUpToDate(const UEnum& InEnum) const;
+	// Names already in the table are skipped, so that the first entry with a name wins, like in GetValueByNameString
+	void AddName(const FString& Name, int64 Value);
+	const FEntry* FindEntry(FStringView Name) const;
+
+	TWeakObjectPtr<const UEnum> Enum;
+	int32 NumEnums = 0;
+	// Regular C++ enums also match names with any namespace, e.g. "Anything::Value"
+	bool bStripsNamespace = false;
+
+	TArray<FEntry> Entries;
+	// Open addressing over Entries with linear probing. INDEX_NONE marks an empty bucket.
+	TArray<int32> Buckets;
+	TSet<int64> Values;
+};
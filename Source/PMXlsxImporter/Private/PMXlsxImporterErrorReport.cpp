@@ -0,0 +1,147 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterErrorReport.h"
+#include "PMXlsxImporterLog.h"
+#include "Algo/Count.h"
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonSerializer.h"
+
+static const TCHAR* GetSeverityName(EPMXlsxImporterErrorSeverity Severity)
+{
+	return Severity == EPMXlsxImporterErrorSeverity::Warning ? TEXT("warning") : TEXT("error");
+}
+
+static FString EscapeXml(const FString& Value)
+{
+	FString Escaped;
+	Escaped.Reserve(Value.Len());
+	for (const TCHAR Char : Value)
+	{
+		switch (Char)
+		{
+		case TEXT('&'): Escaped += TEXT("&amp;"); break;
+		case TEXT('<'): Escaped += TEXT("&lt;"); break;
+		case TEXT('>'): Escaped += TEXT("&gt;"); break;
+		case TEXT('"'): Escaped += TEXT("&quot;"); break;
+		case TEXT('\''): Escaped += TEXT("&apos;"); break;
+		case TEXT('\t'):
+		case TEXT('\n'):
+		case TEXT('\r'):
+			Escaped += Char;
+			break;
+		default:
+			// XML 1.0 can't represent any other control character, even escaped, so they'd make the whole report
+			// unreadable
+			Escaped += Char < 0x20 ? TCHAR(0xFFFD) : Char;
+			break;
+		}
+	}
+	return Escaped;
+}
+
+bool FPMXlsxImporterErrorReport::Write(const FPMXlsxImporterContextLogger& Errors, const FString& FilePath)
+{
+	const bool bJUnit = FPaths::GetExtension(FilePath).Equals(TEXT("xml"), ESearchCase::IgnoreCase);
+	const FString Report = bJUnit ? ToJUnit(Errors.GetErrors()) : ToJson(Errors.GetErrors());
+	if (!FFileHelper::SaveStringToFile(Report, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("Unable to write error report to %s"), *FilePath);
+		return false;
+	}
+
+	UE_LOG(LogPMXlsxImporter, Log, TEXT("Wrote %s error report to %s"), bJUnit ? TEXT("JUnit") : TEXT("JSON"), *FilePath);
+	return true;
+}
+
+FString FPMXlsxImporterErrorReport::ToJson(const TArray<FPMXlsxImporterErrorRecord>& Errors)
+{
+	TArray<TSharedPtr<FJsonValue>> ErrorValues;
+	ErrorValues.Reserve(Errors.Num());
+	for (const FPMXlsxImporterErrorRecord& Error : Errors)
+	{
+		TSharedRef<FJsonObject> ErrorObject = MakeShared<FJsonObject>();
+		ErrorObject->SetStringField(TEXT("workbook"), Error.Workbook);
+		ErrorObject->SetStringField(TEXT("worksheet"), Error.Worksheet);
+		ErrorObject->SetNumberField(TEXT("row"), Error.Row);
+		ErrorObject->SetStringField(TEXT("column"), Error.Column);
+		ErrorObject->SetStringField(TEXT("asset"), Error.Asset);
+		ErrorObject->SetStringField(TEXT("property"), Error.Property);
+		ErrorObject->SetStringField(TEXT("context"), Error.Context);
+		ErrorObject->SetStringField(TEXT("message"), Error.Message);
+		ErrorObject->SetStringField(TEXT("severity"), GetSeverityName(Error.Severity));
+		ErrorValues.Add(MakeShared<FJsonValueObject>(ErrorObject));
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetArrayField(TEXT("errors"), ErrorValues);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Root, Writer);
+	return Json;
+}
+
+FString FPMXlsxImporterErrorReport::ToJUnit(const TArray<FPMXlsxImporterErrorRecord>& Errors)
+{
+	// Group by worksheet, keeping the order worksheets were first seen in
+	TArray<FString> SuiteNames;
+	TMap<FString, TArray<const FPMXlsxImporterErrorRecord*>> Suites;
+	int32 NumFailures = 0;
+	for (const FPMXlsxImporterErrorRecord& Error : Errors)
+	{
+		const FString SuiteName = Error.Workbook.IsEmpty() ? FString(TEXT("PMXlsxImporter")) : FString::Printf(TEXT("%s:%s"), *Error.Workbook, *Error.Worksheet);
+		TArray<const FPMXlsxImporterErrorRecord*>* Suite = Suites.Find(SuiteName);
+		if (Suite == nullptr)
+		{
+			SuiteNames.Add(SuiteName);
+			Suite = &Suites.Add(SuiteName);
+		}
+		Suite->Add(&Error);
+		NumFailures += Error.Severity == EPMXlsxImporterErrorSeverity::Error ? 1 : 0;
+	}
+
+	FString Xml = TEXT("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	Xml += FString::Printf(TEXT("<testsuites name=\"PMXlsxImporter\" tests=\"%i\" failures=\"%i\">\n"), FMath::Max(Errors.Num(), 1), NumFailures);
+
+	if (Errors.Num() == 0)
+	{
+		Xml += TEXT("\t<testsuite name=\"PMXlsxImporter\" tests=\"1\" failures=\"0\">\n");
+		Xml += TEXT("\t\t<testcase classname=\"PMXlsxImporter\" name=\"Import\"/>\n");
+		Xml += TEXT("\t</testsuite>\n");
+	}
+
+	for (const FString& SuiteName : SuiteNames)
+	{
+		const TArray<const FPMXlsxImporterErrorRecord*>& Suite = Suites[SuiteName];
+		const int32 NumSuiteFailures = Algo::CountIf(Suite, [](const FPMXlsxImporterErrorRecord* Error) { return Error->Severity == EPMXlsxImporterErrorSeverity::Error; });
+		const FString EscapedSuiteName = EscapeXml(SuiteName);
+		Xml += FString::Printf(TEXT("\t<testsuite name=\"%s\" tests=\"%i\" failures=\"%i\">\n"), *EscapedSuiteName, Suite.Num(), NumSuiteFailures);
+
+		for (const FPMXlsxImporterErrorRecord* Error : Suite)
+		{
+			FString CaseName = Error->Asset.IsEmpty() ? FString::Printf(TEXT("Row %i"), Error->Row) : Error->Asset;
+			if (!Error->Property.IsEmpty())
+			{
+				CaseName += TEXT(".") + Error->Property;
+			}
+
+			Xml += FString::Printf(TEXT("\t\t<testcase classname=\"%s\" name=\"%s\">\n"), *EscapedSuiteName, *EscapeXml(CaseName));
+			const FString Details = EscapeXml(FString::Printf(TEXT("%s: %s"), *Error->Context, *Error->Message));
+			if (Error->Severity == EPMXlsxImporterErrorSeverity::Error)
+			{
+				Xml += FString::Printf(TEXT("\t\t\t<failure type=\"error\" message=\"%s\">%s</failure>\n"), *EscapeXml(Error->Message), *Details);
+			}
+			else
+			{
+				Xml += FString::Printf(TEXT("\t\t\t<system-out>%s</system-out>\n"), *Details);
+			}
+			Xml += TEXT("\t\t</testcase>\n");
+		}
+
+		Xml += TEXT("\t</testsuite>\n");
+	}
+
+	Xml += TEXT("</testsuites>\n");
+	return Xml;
+}
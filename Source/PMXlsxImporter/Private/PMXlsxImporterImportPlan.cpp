@@ -0,0 +1,185 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterImportPlan.h"
+#include "PMXlsxImporterLog.h"
+#include "PMXlsxImporterParserRegistry.h"
+#include "Hash/CityHash.h"
+
+static const TCHAR* const IMPORT_FROM_XLSX_METADATA_TAG = TEXT("ImportFromXLSX");
+static const TCHAR* const XLSX_DELIMITER_METADATA_TAG = TEXT("XLSXDelimiter");
+static const TCHAR* const DEFAULT_ARRAY_DELIMITER = TEXT(",");
+
+static TMap<const UClass*, TUniquePtr<FPMXlsxImporterImportPlan>> GImportPlans;
+
+static uint64 HashString(const FString& String, uint64 Seed)
+{
+	return CityHash64WithSeed((const char*)*String, String.Len() * sizeof(TCHAR), Seed);
+}
+
+const FPMXlsxImporterImportPlan& FPMXlsxImporterImportPlan::Get(const UClass& Class)
+{
+	// Worker threads can read plans that are already built, but only the game thread can add to GImportPlans
+	const TUniquePtr<FPMXlsxImporterImportPlan>* ExistingPlan = GImportPlans.Find(&Class);
+	if (ExistingPlan != nullptr && (*ExistingPlan)->IsUpToDate(Class))
+	{
+		return **ExistingPlan;
+	}
+
+	check(IsInGameThread());
+
+	TUniquePtr<FPMXlsxImporterImportPlan>& Plan = GImportPlans.FindOrAdd(&Class);
+	if (!Plan.IsValid() || !Plan->IsUpToDate(Class))
+	{
+		Plan.Reset(new FPMXlsxImporterImportPlan(Class));
+	}
+	return *Plan;
+}
+
+void FPMXlsxImporterImportPlan::ResetCache()
+{
+	check(IsInGameThread());
+	GImportPlans.Reset();
+}
+
+FString FPMXlsxImporterImportPlan::GetArrayDelimiter(const FArrayProperty& Property)
+{
+	const FString* Delimiter = Property.FindMetaData(XLSX_DELIMITER_METADATA_TAG);
+	return Delimiter != nullptr && !Delimiter->IsEmpty() ? *Delimiter : FString(DEFAULT_ARRAY_DELIMITER);
+}
+
+FPMXlsxImporterImportPlan::FPMXlsxImporterImportPlan(const UClass& InClass)
+	: Class(&InClass)
+	, PropertyLink(InClass.PropertyLink)
+	, PropertiesSize(InClass.GetPropertiesSize())
+{
+	// https://ikrima.dev/ue4guide/engine-programming/uobject-reflection/uobject-reflection/
+	UE_LOG(LogPMXlsxImporter, Verbose, TEXT("Building import plan for %s"), *InClass.GetName());
+	LayoutHash = HashString(InClass.GetPathName(), 0);
+	for (TFieldIterator<FProperty> PropertyIterator(&InClass, EFieldIteratorFlags::IncludeSuper); PropertyIterator; ++PropertyIterator)
+	{
+		FProperty* Property = *PropertyIterator;
+		const FString CPPName = Property->GetNameCPP();
+		const FString CPPType = Property->GetCPPType();
+
+		if (!Property->HasMetaData(IMPORT_FROM_XLSX_METADATA_TAG))
+		{
+			UE_LOG(LogPMXlsxImporter, VeryVerbose,
+				TEXT("\tSkipping %s %s because it does not have metadata tag %s"),
+				*CPPType, *CPPName, IMPORT_FROM_XLSX_METADATA_TAG
+			);
+			continue;
+		}
+
+		const int32 PropertyAlignment = Property->GetMinAlignment();
+		SnapshotAlignment = FMath::Max(SnapshotAlignment, PropertyAlignment);
+
+		FPMXlsxImporterImportPlanProperty& PlanProperty = Properties.AddDefaulted_GetRef();
+		PlanProperty.Property = Property;
+		PlanProperty.SnapshotOffset = Align(SnapshotSize, PropertyAlignment);
+		SnapshotSize = PlanProperty.SnapshotOffset + Property->GetSize();
+		PlanProperty.Name = CPPName;
+		PlanProperty.NameHash = GetTypeHash(CPPName);
+
+		// GetCPPType leaves out template arguments, e.g. the element type of a TArray, unless asked for them
+		FString ExtendedCPPType;
+		Property->GetCPPType(&ExtendedCPPType);
+		LayoutHash = HashString(FPMXlsxImporterContextLogger::FormatPropertyContext(*Property), LayoutHash);
+		LayoutHash = HashString(ExtendedCPPType, LayoutHash);
+		PlanProperty.ParseFunction = FPMXlsxImporterParserRegistry::Get().Find(*Property);
+		PlanProperty.ParseCellFunction = FPMXlsxImporterParserRegistry::Get().FindCellParser(*Property);
+		PlanProperty.bCanParseOnWorkerThreads = FPMXlsxImporterParserRegistry::Get().IsThreadSafe(*Property);
+
+		if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			PlanProperty.ArrayDelimiter = GetArrayDelimiter(*ArrayProperty);
+			// Rows imported with a different delimiter were split differently. The default is left out of the hash so
+			// that rows imported before delimiters could be changed are still up to date.
+			if (PlanProperty.ArrayDelimiter != DEFAULT_ARRAY_DELIMITER)
+			{
+				LayoutHash = HashString(PlanProperty.ArrayDelimiter, LayoutHash);
+			}
+		}
+
+		if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+		{
+			if (StructProperty->Struct == TBaseStructure<FPrimaryAssetType>::Get())
+			{
+				PlanProperty.Validation = FPMXlsxImporterImportPlanProperty::EValidation::PrimaryAssetType;
+			}
+			else if (StructProperty->Struct == TBaseStructure<FPrimaryAssetId>::Get())
+			{
+				PlanProperty.Validation = FPMXlsxImporterImportPlanProperty::EValidation::PrimaryAssetId;
+			}
+		}
+	}
+}
+
+bool FPMXlsxImporterImportPlan::IsUpToDate(const UClass& InClass) const
+{
+	return Class.Get() == &InClass && PropertyLink == InClass.PropertyLink && PropertiesSize == InClass.GetPropertiesSize();
+}
+
+FPMXlsxImporterImportPlanColumns::FPMXlsxImporterImportPlanColumns(const FPMXlsxImporterImportPlan& InPlan, const FPMXlsxImporterWorksheet& InWorksheet)
+	: Plan(InPlan)
+	, Worksheet(InWorksheet)
+{
+	const TArray<FPMXlsxImporterImportPlanProperty>& PlanProperties = Plan.GetProperties();
+	Columns.Reserve(PlanProperties.Num());
+	for (const FPMXlsxImporterImportPlanProperty& PlanProperty : PlanProperties)
+	{
+		Columns.Add(Worksheet.FindColumnByHash(PlanProperty.NameHash, PlanProperty.Name));
+	}
+}
+
+FPMXlsxImporterImportPlanSnapshot::FPMXlsxImporterImportPlanSnapshot(const FPMXlsxImporterImportPlan& InPlan, const UObject& Object)
+	: Plan(InPlan)
+	, Memory(nullptr)
+{
+	if (Plan.SnapshotSize == 0)
+	{
+		return;
+	}
+
+	Memory = (uint8*)FMemory::Malloc(Plan.SnapshotSize, Plan.SnapshotAlignment);
+	for (const FPMXlsxImporterImportPlanProperty& PlanProperty : Plan.Properties)
+	{
+		void* SnapshotValue = Memory + PlanProperty.SnapshotOffset;
+		PlanProperty.Property->InitializeValue(SnapshotValue);
+		PlanProperty.Property->CopyCompleteValue(SnapshotValue, PlanProperty.Property->ContainerPtrToValuePtr<void>(&Object));
+	}
+}
+
+FPMXlsxImporterImportPlanSnapshot::~FPMXlsxImporterImportPlanSnapshot()
+{
+	if (Memory == nullptr)
+	{
+		return;
+	}
+
+	for (const FPMXlsxImporterImportPlanProperty& PlanProperty : Plan.Properties)
+	{
+		PlanProperty.Property->DestroyValue(Memory + PlanProperty.SnapshotOffset);
+	}
+	FMemory::Free(Memory);
+}
+
+const FPMXlsxImporterImportPlanProperty* FPMXlsxImporterImportPlanSnapshot::FindModifiedProperty(const UObject& Object) const
+{
+	for (const FPMXlsxImporterImportPlanProperty& PlanProperty : Plan.Properties)
+	{
+		const FProperty* Property = PlanProperty.Property;
+		const uint8* SnapshotValue = Memory + PlanProperty.SnapshotOffset;
+		const uint8* CurrentValue = Property->ContainerPtrToValuePtr<uint8>(&Object);
+
+		// Identical only compares one element of static arrays
+		for (int32 Index = 0; Index < Property->ArrayDim; ++Index)
+		{
+			const int32 ElementOffset = Index * Property->ElementSize;
+			if (!Property->Identical(SnapshotValue + ElementOffset, CurrentValue + ElementOffset, PPF_None))
+			{
+				return &PlanProperty;
+			}
+		}
+	}
+	return nullptr;
+}
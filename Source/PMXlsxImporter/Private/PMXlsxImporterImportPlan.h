@@ -0,0 +1,154 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXlsxDataAsset.h"
+#include "PMXlsxImporterWorksheet.h"
+
+// One UPROPERTY(meta = (ImportFromXLSX)) of a UPMXlsxDataAsset subclass
+struct FPMXlsxImporterImportPlanProperty
+{
+	enum class EValidation : uint8
+	{
+		None,
+		PrimaryAssetType,
+		PrimaryAssetId,
+	};
+
+	FProperty* Property = nullptr;
+
+	// C++ name of the property, which is also the header of the column it's imported from
+	FString Name;
+	// GetTypeHash(Name), so each row's values can be searched without rehashing Name
+	uint32 NameHash = 0;
+
+	// Resolved once when the plan is built. Null if ParseValue falls back on FProperty::ImportText.
+	FPMXlsxImporterParseFunction ParseFunction = nullptr;
+	// Resolved along with ParseFunction. Null if ParseFunction's type can't be parsed from a typed cell.
+	FPMXlsxImporterParseCellFunction ParseCellFunction = nullptr;
+	// Whether ParseFunction can run on worker threads. See FPMXlsxImporterParserRegistry::IsThreadSafe.
+	bool bCanParseOnWorkerThreads = false;
+
+	// What array properties' cells are split by. See FPMXlsxImporterImportPlan::GetArrayDelimiter.
+	FString ArrayDelimiter;
+
+	EValidation Validation = EValidation::None;
+
+	// Where this property's value is stored in an FPMXlsxImporterImportPlanSnapshot
+	int32 SnapshotOffset = 0;
+};
+
+// Everything UPMXlsxDataAsset needs to know about a class's imported properties, built once per class by walking its
+// reflection data so that importing and validating each row is a loop over a flat array.
+class FPMXlsxImporterImportPlan
+{
+public:
+	// Returns the plan for Class, building it if necessary. Plans are rebuilt if Class has been reloaded or its
+	// layout has changed since the plan was built. Only the game thread can build plans, so worker threads can only
+	// get plans that the game thread has already built.
+	static const FPMXlsxImporterImportPlan& Get(const UClass& Class);
+
+	// Throws away every plan. Called at the start of each import run.
+	static void ResetCache();
+
+	// The XLSXDelimiter metadata of Property, e.g. UPROPERTY(meta = (ImportFromXLSX, XLSXDelimiter = ";")), or a
+	// comma if it doesn't have any
+	static FString GetArrayDelimiter(const FArrayProperty& Property);
+
+	const TArray<FPMXlsxImporterImportPlanProperty>& GetProperties() const
+	{
+		return Properties;
+	}
+
+	// Hash of the class's name and the name and type of each imported property. Rows imported into a class with a
+	// different layout hash have to be imported again.
+	uint64 GetLayoutHash() const
+	{
+		return LayoutHash;
+	}
+
+private:
+	friend class FPMXlsxImporterImportPlanSnapshot;
+
+	explicit FPMXlsxImporterImportPlan(const UClass& InClass);
+
+	bool IsUpToDate(const UClass& InClass) const;
+
+	TWeakObjectPtr<const UClass> Class;
+	// Layout signature. Hot reload and live coding relink properties, which changes at least one of these.
+	const FProperty* PropertyLink;
+	int32 PropertiesSize;
+
+	TArray<FPMXlsxImporterImportPlanProperty> Properties;
+	uint64 LayoutHash = 0;
+
+	// Memory needed to snapshot every property in Properties
+	int32 SnapshotSize = 0;
+	int32 SnapshotAlignment = 1;
+};
+
+// Copy of the imported properties of one object, used to check whether importing a row changed anything without
+// duplicating the whole object. Must not outlive the plan it was taken with.
+class FPMXlsxImporterImportPlanSnapshot
+{
+public:
+	FPMXlsxImporterImportPlanSnapshot(const FPMXlsxImporterImportPlan& InPlan, const UObject& Object);
+	~FPMXlsxImporterImportPlanSnapshot();
+
+	FPMXlsxImporterImportPlanSnapshot(const FPMXlsxImporterImportPlanSnapshot&) = delete;
+	FPMXlsxImporterImportPlanSnapshot& operator=(const FPMXlsxImporterImportPlanSnapshot&) = delete;
+
+	// Returns the first imported property whose value in Object differs from the snapshot, or null if none do
+	const FPMXlsxImporterImportPlanProperty* FindModifiedProperty(const UObject& Object) const;
+
+	// Where PlanProperty's value is stored in this snapshot
+	void* GetValuePtr(const FPMXlsxImporterImportPlanProperty& PlanProperty) const
+	{
+		return Memory + PlanProperty.SnapshotOffset;
+	}
+
+private:
+	const FPMXlsxImporterImportPlan& Plan;
+	uint8* Memory;
+};
+
+// Which column of one worksheet each of a plan's properties is imported from, looked up once per worksheet so that
+// each row's cells can be read by index. Must not outlive the plan or the worksheet.
+struct FPMXlsxImporterImportPlanColumns
+{
+	FPMXlsxImporterImportPlanColumns(const FPMXlsxImporterImportPlan& InPlan, const FPMXlsxImporterWorksheet& InWorksheet);
+
+	const FPMXlsxImporterImportPlan& Plan;
+	const FPMXlsxImporterWorksheet& Worksheet;
+	// Parallel to Plan.GetProperties(). INDEX_NONE for properties Worksheet has no column for.
+	TArray<int32> Columns;
+};
+
+// One row of a worksheet parsed on a worker thread by UPMXlsxDataAsset::StageFromXLSX, waiting to be applied to its
+// asset on the game thread by UPMXlsxDataAsset::ImportStagedFromXLSX
+struct FPMXlsxImporterImportPlanStagedRow
+{
+	FPMXlsxImporterImportPlanStagedRow(const FPMXlsxImporterImportPlanColumns& InColumns, int32 InRow)
+		: Plan(InColumns.Plan)
+		, Columns(InColumns)
+		, Row(InRow)
+	{
+	}
+
+	const FPMXlsxImporterImportPlan& Plan;
+	const FPMXlsxImporterImportPlanColumns& Columns;
+	int32 Row;
+
+	// Copy of the asset's imported properties with each property that could be parsed on a worker thread parsed
+	// into it. The rest are parsed on the game thread when the row is applied.
+	TUniquePtr<FPMXlsxImporterImportPlanSnapshot> ParsedValues;
+	// Parallel to Plan.GetProperties()
+	TBitArray<> ParsedProperties;
+
+	// Errors from parsing, with context relative to the asset
+	FPMXlsxImporterContextLogger Errors;
+	// Errors.Num() after each property was parsed, so that errors can be merged in the same order as if every
+	// property had been parsed on the game thread. Parallel to Plan.GetProperties().
+	TArray<int32> ErrorCounts;
+};
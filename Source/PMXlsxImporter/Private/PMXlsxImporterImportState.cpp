@@ -0,0 +1,120 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterImportState.h"
+#include "PMXlsxImporterLog.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static const uint32 IMPORT_STATE_MAGIC = 0x49584D50; // "PMXI"
+
+// Bump this whenever the file format changes, or whenever parsing changes in a way that would import the same row
+// differently, so that every row gets imported again.
+static const int32 IMPORT_STATE_FORMAT_VERSION = 5;
+
+FArchive& operator<<(FArchive& Ar, FPMXlsxImporterWorksheetFingerprint& Fingerprint)
+{
+	Ar << Fingerprint.WorksheetCrc32;
+	Ar << Fingerprint.WorksheetSize;
+	Ar << Fingerprint.SharedStringsCrc32;
+	Ar << Fingerprint.SharedStringsSize;
+	Ar << Fingerprint.StylesCrc32;
+	Ar << Fingerprint.StylesSize;
+	Ar << Fingerprint.bDate1904;
+	Ar << Fingerprint.bReadNatively;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FPMXlsxImporterImportState::FEntry& Entry)
+{
+	Ar << Entry.LayoutHash;
+	Ar << Entry.RowHashes;
+	Ar << Entry.Fingerprint;
+	return Ar;
+}
+
+FString FPMXlsxImporterImportState::GetDefaultFilePath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("PMXlsxImporter") / TEXT("ImportState.bin");
+}
+
+bool FPMXlsxImporterImportState::Load(const FString& FilePath)
+{
+	Entries.Reset();
+
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath, FILEREAD_Silent))
+	{
+		UE_LOG(LogPMXlsxImporter, Log, TEXT("No import state found at %s. Every row will be imported."), *FilePath);
+		return false;
+	}
+
+	FMemoryReader Reader(FileData);
+	uint32 Magic = 0;
+	int32 FormatVersion = 0;
+	int32 PluginVersion = 0;
+	Reader << Magic;
+	Reader << FormatVersion;
+	Reader << PluginVersion;
+	if (Reader.IsError() || Magic != IMPORT_STATE_MAGIC || FormatVersion != IMPORT_STATE_FORMAT_VERSION || PluginVersion != GetPluginVersion())
+	{
+		UE_LOG(LogPMXlsxImporter, Log, TEXT("Import state at %s is out of date. Every row will be imported."), *FilePath);
+		return false;
+	}
+
+	Reader << Entries;
+	if (Reader.IsError())
+	{
+		UE_LOG(LogPMXlsxImporter, Warning, TEXT("Import state at %s is corrupt. Every row will be imported."), *FilePath);
+		Entries.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FPMXlsxImporterImportState::Save(const FString& FilePath) const
+{
+	TArray<uint8> FileData;
+	FMemoryWriter Writer(FileData);
+	uint32 Magic = IMPORT_STATE_MAGIC;
+	int32 FormatVersion = IMPORT_STATE_FORMAT_VERSION;
+	int32 PluginVersion = GetPluginVersion();
+	Writer << Magic;
+	Writer << FormatVersion;
+	Writer << PluginVersion;
+	// operator<< needs a mutable map even when saving
+	Writer << const_cast<TMap<FString, FEntry>&>(Entries);
+
+	if (!FFileHelper::SaveArrayToFile(FileData, *FilePath))
+	{
+		UE_LOG(LogPMXlsxImporter, Warning, TEXT("Unable to save import state to %s"), *FilePath);
+		return false;
+	}
+	return true;
+}
+
+const FPMXlsxImporterImportState::FEntry* FPMXlsxImporterImportState::FindEntry(const FString& EntryKey) const
+{
+	return Entries.Find(EntryKey);
+}
+
+FPMXlsxImporterImportState::FEntry& FPMXlsxImporterImportState::FindOrAddEntry(const FString& EntryKey)
+{
+	return Entries.FindOrAdd(EntryKey);
+}
+
+void FPMXlsxImporterImportState::Append(const FPMXlsxImporterImportState& Other)
+{
+	for (const TPair<FString, FEntry>& Entry : Other.Entries)
+	{
+		Entries.Add(Entry.Key, Entry.Value);
+	}
+}
+
+int32 FPMXlsxImporterImportState::GetPluginVersion()
+{
+	const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("PMXlsxImporter"));
+	return Plugin.IsValid() ? Plugin->GetDescriptor().Version : 0;
+}
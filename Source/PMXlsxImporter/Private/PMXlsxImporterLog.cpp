@@ -1,5 +1,5 @@
-// Copyright 2022 Proletariat, Inc.
-
-#include "PMXlsxImporterLog.h"
-
-DEFINE_LOG_CATEGORY(LogPMXlsxImporter);
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterLog.h"
+
+DEFINE_LOG_CATEGORY(LogPMXlsxImporter);
@@ -1,7 +1,7 @@
-// Copyright 2022 Proletariat, Inc.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
-DECLARE_LOG_CATEGORY_EXTERN(LogPMXlsxImporter, Log, All);
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPMXlsxImporter, Log, All);
@@ -0,0 +1,106 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterParserRegistry.h"
+
+FPMXlsxImporterParserRegistry& FPMXlsxImporterParserRegistry::Get()
+{
+	static FPMXlsxImporterParserRegistry Registry;
+	return Registry;
+}
+
+FPMXlsxImporterParserRegistry::FPMXlsxImporterParserRegistry()
+{
+	UPMXlsxDataAsset::RegisterDefaultParsers(*this);
+}
+
+void FPMXlsxImporterParserRegistry::RegisterPropertyParser(FFieldClass* PropertyClass, FPMXlsxImporterParseFunction ParseFunction, bool bThreadSafe, FPMXlsxImporterParseCellFunction ParseCellFunction)
+{
+	check(IsInGameThread());
+	FParser& Parser = PropertyParsers.Add(PropertyClass);
+	Parser.Function = ParseFunction;
+	Parser.CellFunction = ParseCellFunction;
+	Parser.bThreadSafe = bThreadSafe;
+}
+
+void FPMXlsxImporterParserRegistry::RegisterStructParser(const UScriptStruct* Struct, FPMXlsxImporterParseFunction ParseFunction, bool bThreadSafe, FPMXlsxImporterParseCellFunction ParseCellFunction)
+{
+	check(IsInGameThread());
+	FParser& Parser = StructParsers.Add(Struct);
+	Parser.Function = ParseFunction;
+	Parser.CellFunction = ParseCellFunction;
+	Parser.bThreadSafe = bThreadSafe;
+}
+
+void FPMXlsxImporterParserRegistry::RegisterEnumParser(FFieldClass* UnderlyingPropertyClass, FPMXlsxImporterParseFunction ParseFunction, bool bThreadSafe, FPMXlsxImporterParseCellFunction ParseCellFunction)
+{
+	check(IsInGameThread());
+	FParser& Parser = EnumParsers.Add(UnderlyingPropertyClass);
+	Parser.Function = ParseFunction;
+	Parser.CellFunction = ParseCellFunction;
+	Parser.bThreadSafe = bThreadSafe;
+}
+
+void FPMXlsxImporterParserRegistry::UnregisterPropertyParser(FFieldClass* PropertyClass)
+{
+	check(IsInGameThread());
+	PropertyParsers.Remove(PropertyClass);
+}
+
+void FPMXlsxImporterParserRegistry::UnregisterStructParser(const UScriptStruct* Struct)
+{
+	check(IsInGameThread());
+	StructParsers.Remove(Struct);
+}
+
+FPMXlsxImporterParseFunction FPMXlsxImporterParserRegistry::Find(const FProperty& Property) const
+{
+	const FParser* Parser = FindParser(Property);
+	return Parser ? Parser->Function : nullptr;
+}
+
+FPMXlsxImporterParseCellFunction FPMXlsxImporterParserRegistry::FindCellParser(const FProperty& Property) const
+{
+	const FParser* Parser = FindParser(Property);
+	return Parser ? Parser->CellFunction : nullptr;
+}
+
+bool FPMXlsxImporterParserRegistry::IsThreadSafe(const FProperty& Property) const
+{
+	const FParser* Parser = FindParser(Property);
+	if (Parser == nullptr || !Parser->bThreadSafe)
+	{
+		return false;
+	}
+
+	const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(&Property);
+	return ArrayProperty == nullptr || IsThreadSafe(*ArrayProperty->Inner);
+}
+
+const FPMXlsxImporterParserRegistry::FParser* FPMXlsxImporterParserRegistry::FindParser(const FProperty& Property) const
+{
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(&Property))
+	{
+		return StructParsers.Find(StructProperty->Struct);
+	}
+
+	if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(&Property))
+	{
+		return FindInClassHierarchy(EnumParsers, EnumProperty->GetUnderlyingProperty()->GetClass());
+	}
+
+	return FindInClassHierarchy(PropertyParsers, Property.GetClass());
+}
+
+const FPMXlsxImporterParserRegistry::FParser* FPMXlsxImporterParserRegistry::FindInClassHierarchy(const TMap<FFieldClass*, FParser>& Parsers, FFieldClass* PropertyClass)
+{
+	// The exact class almost always matches on the first lookup. Walking up the hierarchy keeps the IsA semantics
+	// ParseValue used to have for property classes derived from a supported one.
+	for (FFieldClass* Class = PropertyClass; Class != nullptr; Class = Class->GetSuperClass())
+	{
+		if (const FParser* Parser = Parsers.Find(Class))
+		{
+			return Parser;
+		}
+	}
+	return nullptr;
+}
@@ -0,0 +1,28 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterPrimaryAssetSnapshot.h"
+#include "PMXlsxImporterLog.h"
+#include "Engine/AssetManager.h"
+
+FPMXlsxImporterPrimaryAssetSnapshot::FPMXlsxImporterPrimaryAssetSnapshot()
+{
+	check(IsInGameThread());
+
+	UAssetManager& AssetManager = UAssetManager::Get();
+
+	TArray<FPrimaryAssetTypeInfo> TypeInfos;
+	AssetManager.GetPrimaryAssetTypeInfoList(TypeInfos);
+
+	TArray<FPrimaryAssetId> AssetIds;
+	for (const FPrimaryAssetTypeInfo& TypeInfo : TypeInfos)
+	{
+		const FPrimaryAssetType AssetType = TypeInfo.PrimaryAssetType;
+		PrimaryAssetTypes.Add(AssetType);
+
+		AssetIds.Reset();
+		AssetManager.GetPrimaryAssetIdList(AssetType, AssetIds);
+		PrimaryAssetIds.Append(AssetIds);
+	}
+
+	UE_LOG(LogPMXlsxImporter, Verbose, TEXT("Snapshotted %i primary asset types and %i primary asset ids"), PrimaryAssetTypes.Num(), PrimaryAssetIds.Num());
+}
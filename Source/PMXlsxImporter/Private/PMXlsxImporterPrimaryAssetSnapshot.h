@@ -0,0 +1,29 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/PrimaryAssetId.h"
+
+// Copy of the primary asset types and ids known to UAssetManager, so that UPMXlsxDataAsset::ValidatePrimaryAssetType
+// and ValidatePrimaryAssetId can run on worker threads. UAssetManager itself is not thread safe.
+class FPMXlsxImporterPrimaryAssetSnapshot
+{
+public:
+	// Game thread only
+	FPMXlsxImporterPrimaryAssetSnapshot();
+
+	bool HasPrimaryAssetType(const FPrimaryAssetType& AssetType) const
+	{
+		return PrimaryAssetTypes.Contains(AssetType);
+	}
+
+	bool HasPrimaryAssetId(const FPrimaryAssetId& AssetId) const
+	{
+		return PrimaryAssetIds.Contains(AssetId);
+	}
+
+private:
+	TSet<FPrimaryAssetType> PrimaryAssetTypes;
+	TSet<FPrimaryAssetId> PrimaryAssetIds;
+};
@@ -1,18 +1,190 @@
-// Copyright 2022 Proletariat, Inc.
-
-#include "PMXlsxImporterPythonBridge.h"
-#include "PMXlsxImporterLog.h"
-
-UPMXlsxImporterPythonBridge* UPMXlsxImporterPythonBridge::Get()
-{
-    TArray<UClass*> PythonBridgeClasses;
-    GetDerivedClasses(UPMXlsxImporterPythonBridge::StaticClass(), PythonBridgeClasses);
-    int32 NumClasses = PythonBridgeClasses.Num();
-    if (NumClasses > 0)
-    {
-        return Cast<UPMXlsxImporterPythonBridge>(PythonBridgeClasses[NumClasses - 1]->GetDefaultObject());
-    }
-
-	UE_LOG(LogPMXlsxImporter, Error, TEXT("No python bridge implementation found. Have you installed openpyxl? See PMXlsxImporter/README.md"));
-    return nullptr;
-}
\ No newline at end of file
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterPythonBridge.h"
+#include "PMXlsxImporterLog.h"
+#include "PMXlsxImporterSettings.h"
+#include "PMXlsxImporterWorkbook.h"
+#include "PMXlsxImporterWorksheet.h"
+
+UPMXlsxImporterPythonBridge* UPMXlsxImporterPythonBridge::Get()
+{
+    if (GetDefault<UPMXlsxImporterSettings>()->bUseNativeReader)
+    {
+        return GetMutableDefault<UPMXlsxImporterPythonBridge>();
+    }
+
+    UPMXlsxImporterPythonBridge* PythonBridge = GetPythonImplementation();
+    if (PythonBridge == nullptr)
+    {
+        UE_LOG(LogPMXlsxImporter, Error, TEXT("No python bridge implementation found. Have you installed openpyxl? See PMXlsxImporter/README.md"));
+    }
+    return PythonBridge;
+}
+
+UPMXlsxImporterPythonBridge* UPMXlsxImporterPythonBridge::GetPythonImplementation()
+{
+    TArray<UClass*> PythonBridgeClasses;
+    GetDerivedClasses(UPMXlsxImporterPythonBridge::StaticClass(), PythonBridgeClasses);
+    int32 NumClasses = PythonBridgeClasses.Num();
+    if (NumClasses > 0)
+    {
+        return Cast<UPMXlsxImporterPythonBridge>(PythonBridgeClasses[NumClasses - 1]->GetDefaultObject());
+    }
+
+    return nullptr;
+}
+
+TArray<FString> UPMXlsxImporterPythonBridge::ReadWorksheetNames_Implementation(const FString& AbsoluteFilePath)
+{
+    FPMXlsxImporterWorkbook Workbook;
+    if (Workbook.Open(AbsoluteFilePath))
+    {
+        return Workbook.GetWorksheetNames();
+    }
+
+    UPMXlsxImporterPythonBridge* PythonBridge = GetPythonImplementation();
+    if (PythonBridge != nullptr && PythonBridge != this)
+    {
+        UE_LOG(LogPMXlsxImporter, Warning, TEXT("Native reader could not read %s. Falling back on the python implementation."), *AbsoluteFilePath);
+        return PythonBridge->ReadWorksheetNames(AbsoluteFilePath);
+    }
+
+    return TArray<FString>();
+}
+
+bool UPMXlsxImporterPythonBridge::IsNative() const
+{
+    return GetClass() == UPMXlsxImporterPythonBridge::StaticClass();
+}
+
+TSharedPtr<FPMXlsxImporterWorksheet> UPMXlsxImporterPythonBridge::ReadWorksheetNatively(const FString& AbsoluteFilePath, const FString& WorksheetName)
+{
+    FPMXlsxImporterWorkbook Workbook;
+    TSharedRef<FPMXlsxImporterWorksheet> Worksheet = MakeShared<FPMXlsxImporterWorksheet>(WorksheetName);
+    if (Workbook.Open(AbsoluteFilePath) && Workbook.ReadWorksheet(*Worksheet))
+    {
+        return Worksheet;
+    }
+    return nullptr;
+}
+
+TOptional<TArray<TSharedRef<FPMXlsxImporterWorksheet>>> UPMXlsxImporterPythonBridge::ReadWorksheetsNatively(const FString& AbsoluteFilePath, const TArray<FString>& WorksheetNames)
+{
+    FPMXlsxImporterWorkbook Workbook;
+    if (!Workbook.Open(AbsoluteFilePath))
+    {
+        return TOptional<TArray<TSharedRef<FPMXlsxImporterWorksheet>>>();
+    }
+
+    // Shared strings are decoded by the first ReadWorksheet call and reused by the rest
+    TArray<TSharedRef<FPMXlsxImporterWorksheet>> Worksheets;
+    for (const FString& WorksheetName : WorksheetNames)
+    {
+        TSharedRef<FPMXlsxImporterWorksheet> Worksheet = MakeShared<FPMXlsxImporterWorksheet>(WorksheetName);
+        if (Workbook.ReadWorksheet(*Worksheet))
+        {
+            Worksheets.Add(Worksheet);
+        }
+        else
+        {
+            UE_LOG(LogPMXlsxImporter, Warning, TEXT("Native reader could not read %s:%s"), *AbsoluteFilePath, *WorksheetName);
+        }
+    }
+    return Worksheets;
+}
+
+TSharedPtr<FPMXlsxImporterWorksheet> UPMXlsxImporterPythonBridge::ReadColumnarWorksheet(const FString& AbsoluteFilePath, const FString& WorksheetName)
+{
+    if (!IsNative())
+    {
+        return FPMXlsxImporterWorksheet::FromRows(WorksheetName, ReadWorksheet(AbsoluteFilePath, WorksheetName));
+    }
+
+    if (TSharedPtr<FPMXlsxImporterWorksheet> Worksheet = ReadWorksheetNatively(AbsoluteFilePath, WorksheetName))
+    {
+        return Worksheet;
+    }
+
+    UPMXlsxImporterPythonBridge* PythonBridge = GetPythonImplementation();
+    if (PythonBridge != nullptr && PythonBridge != this)
+    {
+        UE_LOG(LogPMXlsxImporter, Warning, TEXT("Native reader could not read %s:%s. Falling back on the python implementation."), *AbsoluteFilePath, *WorksheetName);
+        return PythonBridge->ReadColumnarWorksheet(AbsoluteFilePath, WorksheetName);
+    }
+
+    UE_LOG(LogPMXlsxImporter, Error, TEXT("Native reader could not read %s:%s and there is no python implementation to fall back on"), *AbsoluteFilePath, *WorksheetName);
+    return nullptr;
+}
+
+TArray<TSharedRef<FPMXlsxImporterWorksheet>> UPMXlsxImporterPythonBridge::ReadColumnarWorksheets(const FString& AbsoluteFilePath, const TArray<FString>& WorksheetNames)
+{
+    if (!IsNative())
+    {
+        TArray<TSharedRef<FPMXlsxImporterWorksheet>> Worksheets;
+        for (const FPMXlsxImporterPythonBridgeWorksheet& Worksheet : ReadWorksheets(AbsoluteFilePath, WorksheetNames))
+        {
+            Worksheets.Add(FPMXlsxImporterWorksheet::FromRows(Worksheet.WorksheetName, Worksheet.Rows));
+        }
+        return Worksheets;
+    }
+
+    TOptional<TArray<TSharedRef<FPMXlsxImporterWorksheet>>> Worksheets = ReadWorksheetsNatively(AbsoluteFilePath, WorksheetNames);
+    if (Worksheets.IsSet())
+    {
+        return MoveTemp(Worksheets.GetValue());
+    }
+
+    UPMXlsxImporterPythonBridge* PythonBridge = GetPythonImplementation();
+    if (PythonBridge != nullptr && PythonBridge != this)
+    {
+        UE_LOG(LogPMXlsxImporter, Warning, TEXT("Native reader could not read %s. Falling back on the python implementation."), *AbsoluteFilePath);
+        return PythonBridge->ReadColumnarWorksheets(AbsoluteFilePath, WorksheetNames);
+    }
+
+    return TArray<TSharedRef<FPMXlsxImporterWorksheet>>();
+}
+
+TArray<FPMXlsxImporterPythonBridgeDataAssetInfo> UPMXlsxImporterPythonBridge::ReadWorksheet_Implementation(const FString& AbsoluteFilePath, const FString& WorksheetName)
+{
+    TArray<FPMXlsxImporterPythonBridgeDataAssetInfo> Rows;
+    if (TSharedPtr<FPMXlsxImporterWorksheet> Worksheet = ReadWorksheetNatively(AbsoluteFilePath, WorksheetName))
+    {
+        Worksheet->ToRows(Rows);
+        return Rows;
+    }
+
+    UPMXlsxImporterPythonBridge* PythonBridge = GetPythonImplementation();
+    if (PythonBridge != nullptr && PythonBridge != this)
+    {
+        UE_LOG(LogPMXlsxImporter, Warning, TEXT("Native reader could not read %s:%s. Falling back on the python implementation."), *AbsoluteFilePath, *WorksheetName);
+        return PythonBridge->ReadWorksheet(AbsoluteFilePath, WorksheetName);
+    }
+
+    return Rows;
+}
+
+TArray<FPMXlsxImporterPythonBridgeWorksheet> UPMXlsxImporterPythonBridge::ReadWorksheets_Implementation(const FString& AbsoluteFilePath, const TArray<FString>& WorksheetNames)
+{
+    TArray<FPMXlsxImporterPythonBridgeWorksheet> Worksheets;
+
+    TOptional<TArray<TSharedRef<FPMXlsxImporterWorksheet>>> ColumnarWorksheets = ReadWorksheetsNatively(AbsoluteFilePath, WorksheetNames);
+    if (ColumnarWorksheets.IsSet())
+    {
+        for (const TSharedRef<FPMXlsxImporterWorksheet>& ColumnarWorksheet : ColumnarWorksheets.GetValue())
+        {
+            FPMXlsxImporterPythonBridgeWorksheet& Worksheet = Worksheets.AddDefaulted_GetRef();
+            Worksheet.WorksheetName = ColumnarWorksheet->GetName();
+            ColumnarWorksheet->ToRows(Worksheet.Rows);
+        }
+        return Worksheets;
+    }
+
+    UPMXlsxImporterPythonBridge* PythonBridge = GetPythonImplementation();
+    if (PythonBridge != nullptr && PythonBridge != this)
+    {
+        UE_LOG(LogPMXlsxImporter, Warning, TEXT("Native reader could not read %s. Falling back on the python implementation."), *AbsoluteFilePath);
+        return PythonBridge->ReadWorksheets(AbsoluteFilePath, WorksheetNames);
+    }
+
+    return Worksheets;
+}
@@ -0,0 +1,95 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterRowBatches.h"
+#include "PMXlsxImporterLog.h"
+#include "PMXlsxImporterSession.h"
+#include "PMXlsxImporterSettings.h"
+#include "PMXlsxImporterWorkbook.h"
+#include "HAL/FileManager.h"
+
+FPMXlsxImporterRowBatches::FPMXlsxImporterRowBatches(FPMXlsxImporterSession& InSession, const FString& InXlsxAbsolutePath, const FString& InWorksheetName)
+	: Session(InSession)
+	, XlsxAbsolutePath(InXlsxAbsolutePath)
+	, WorksheetName(InWorksheetName)
+	, BatchSize(InSession.GetStreamingBatchSize())
+{
+}
+
+FPMXlsxImporterRowBatches::~FPMXlsxImporterRowBatches()
+{
+}
+
+bool FPMXlsxImporterRowBatches::Start()
+{
+	if (BatchSize > 0 && GetDefault<UPMXlsxImporterSettings>()->bUseNativeReader)
+	{
+		Workbook = MakeUnique<FPMXlsxImporterWorkbook>();
+		Reader = MakeUnique<FPMXlsxImporterWorksheetReader>(*Workbook);
+		if (Workbook->Open(XlsxAbsolutePath) && Reader->Open(WorksheetName))
+		{
+			Session.GetStats().FindOrAddRow(XlsxAbsolutePath).NumBytesRead += FMath::Max<int64>(IFileManager::Get().FileSize(*XlsxAbsolutePath), 0);
+			StreamedWorksheet = MakeUnique<FPMXlsxImporterWorksheet>(WorksheetName);
+			Worksheet = StreamedWorksheet.Get();
+			return true;
+		}
+
+		UE_LOG(LogPMXlsxImporter, Warning, TEXT("Could not stream %s:%s with the native reader. Reading the whole worksheet instead."), *XlsxAbsolutePath, *WorksheetName);
+		Reader.Reset();
+		Workbook.Reset();
+	}
+
+	// Also taken when streaming falls back on reading the whole worksheet, so a failed read fails here either way
+	CachedWorksheet = Session.ReadWorksheet(XlsxAbsolutePath, WorksheetName);
+	if (!CachedWorksheet.IsValid())
+	{
+		Error = TEXT("could not read worksheet");
+		return false;
+	}
+	Worksheet = CachedWorksheet.Get();
+	return true;
+}
+
+bool FPMXlsxImporterRowBatches::Next()
+{
+	if (!bStarted)
+	{
+		bStarted = true;
+		bFailed = !Start();
+	}
+
+	if (bFailed)
+	{
+		return false;
+	}
+
+	if (Reader.IsValid())
+	{
+		// Each batch replaces the rows of the last one
+		RowIndexOffset += EndRow;
+		FirstRow = 0;
+		EndRow = 0;
+		if (Reader->IsAtEnd())
+		{
+			return false;
+		}
+
+		if (!Reader->ReadRows(BatchSize, *StreamedWorksheet))
+		{
+			Error = FString::Printf(TEXT("could not read worksheet past row %i"), RowIndexOffset);
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("Could not read %s:%s past row %i"), *XlsxAbsolutePath, *WorksheetName, RowIndexOffset);
+			bFailed = true;
+			return false;
+		}
+		EndRow = StreamedWorksheet->GetNumRows();
+		return EndRow > 0;
+	}
+
+	const int32 NumRows = CachedWorksheet->GetNumRows();
+	FirstRow = EndRow;
+	if (FirstRow >= NumRows)
+	{
+		return false;
+	}
+	EndRow = BatchSize > 0 ? FMath::Min(FirstRow + BatchSize, NumRows) : NumRows;
+	return true;
+}
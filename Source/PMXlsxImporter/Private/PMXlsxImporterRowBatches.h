@@ -0,0 +1,93 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXlsxImporterWorksheet.h"
+
+class FPMXlsxImporterSession;
+class FPMXlsxImporterWorkbook;
+class FPMXlsxImporterWorksheetReader;
+
+// Hands out the rows of one worksheet a batch at a time, for the SyncAssets, ParseData and Validate phases.
+// Unless the session is streaming, the whole worksheet is one batch, read through the session's cache. Streaming
+// sessions read each batch with the native reader as it's needed, so only one batch of rows is in memory at a time.
+// If the native reader is off or can't read the file, the cached worksheet is handed out in slices instead.
+class FPMXlsxImporterRowBatches
+{
+public:
+	FPMXlsxImporterRowBatches(FPMXlsxImporterSession& InSession, const FString& InXlsxAbsolutePath, const FString& InWorksheetName);
+	~FPMXlsxImporterRowBatches();
+
+	FPMXlsxImporterRowBatches(const FPMXlsxImporterRowBatches&) = delete;
+	FPMXlsxImporterRowBatches& operator=(const FPMXlsxImporterRowBatches&) = delete;
+
+	// Moves on to the next batch. Returns false once every row has been handed out, or if reading failed.
+	bool Next();
+
+	// Whether the worksheet couldn't be read, or was malformed part way through. Rows handed out so far are fine, but
+	// there may have been more.
+	bool HasFailed() const
+	{
+		return bFailed;
+	}
+
+	// Why reading failed, for the error the caller logs. Empty unless HasFailed. Callers push the worksheet context.
+	const FString& GetError() const
+	{
+		return Error;
+	}
+
+	// Only valid after Next returns true. The worksheet's rows in this batch are [GetFirstRow(), GetEndRow()).
+	const FPMXlsxImporterWorksheet& GetWorksheet() const
+	{
+		return *Worksheet;
+	}
+
+	int32 GetFirstRow() const
+	{
+		return FirstRow;
+	}
+
+	int32 GetEndRow() const
+	{
+		return EndRow;
+	}
+
+	// Index of GetWorksheet()'s row Row in the whole worksheet, for error messages and import state
+	int32 GetRowIndex(int32 Row) const
+	{
+		return RowIndexOffset + Row;
+	}
+
+	// Total number of rows handed out so far
+	int32 GetNumRowsRead() const
+	{
+		return RowIndexOffset + EndRow;
+	}
+
+private:
+	bool Start();
+
+	FPMXlsxImporterSession& Session;
+	FString XlsxAbsolutePath;
+	FString WorksheetName;
+	// 0 hands out the whole worksheet at once
+	int32 BatchSize;
+
+	// Set when streaming with the native reader
+	TUniquePtr<FPMXlsxImporterWorkbook> Workbook;
+	TUniquePtr<FPMXlsxImporterWorksheetReader> Reader;
+	TUniquePtr<FPMXlsxImporterWorksheet> StreamedWorksheet;
+
+	// Set otherwise
+	TSharedPtr<const FPMXlsxImporterWorksheet> CachedWorksheet;
+
+	const FPMXlsxImporterWorksheet* Worksheet = nullptr;
+	int32 FirstRow = 0;
+	int32 EndRow = 0;
+	int32 RowIndexOffset = 0;
+	bool bStarted = false;
+	bool bFailed = false;
+	FString Error;
+};
@@ -0,0 +1,245 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterSession.h"
+#include "PMXlsxImporterLog.h"
+#include "PMXlsxImporterSettingsEntry.h"
+#include "PMXlsxImporterImportPlan.h"
+#include "PMXlsxImporterEnumLookup.h"
+#include "PMXlsxImporterSettings.h"
+#include "PMXlsxImporterWorkbook.h"
+#include "PMXlsxImporterPrimaryAssetSnapshot.h"
+#include "Engine/AssetManager.h"
+#include "HAL/FileManager.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+FPMXlsxImporterSession::FPMXlsxImporterSession(bool bInFullImport, int32 InStreamingBatchSize)
+	: bFullImport(bInFullImport)
+	, StreamingBatchSize(FMath::Max(InStreamingBatchSize, 0))
+{
+	// Import plans and enum lookups are built once per run. Rebuilding them at the start of each run picks up any class
+	// and enum changes made since the last run, even ones IsUpToDate can't detect.
+	FPMXlsxImporterImportPlan::ResetCache();
+	FPMXlsxImporterEnumLookup::ResetCache();
+
+	if (bFullImport)
+	{
+		UE_LOG(LogPMXlsxImporter, Log, TEXT("Full import requested. Every row will be imported."));
+	}
+	else
+	{
+		PreviousImportState.Load(FPMXlsxImporterImportState::GetDefaultFilePath());
+	}
+}
+
+FPMXlsxImporterSession::~FPMXlsxImporterSession()
+{
+}
+
+const FPMXlsxImporterPrimaryAssetSnapshot& FPMXlsxImporterSession::GetPrimaryAssetSnapshot()
+{
+	if (!PrimaryAssetSnapshot.IsValid())
+	{
+		PrimaryAssetSnapshot = MakeUnique<FPMXlsxImporterPrimaryAssetSnapshot>();
+	}
+	return *PrimaryAssetSnapshot;
+}
+
+TSharedPtr<const FPMXlsxImporterWorksheet> FPMXlsxImporterSession::ReadWorksheet(const FString& XlsxAbsolutePath, const FString& WorksheetName)
+{
+	const FWorksheetKey Key = MakeWorksheetKey(XlsxAbsolutePath, WorksheetName, IFileManager::Get().GetStatData(*XlsxAbsolutePath));
+
+	if (const TSharedPtr<const FPMXlsxImporterWorksheet>* CachedWorksheet = ParsedWorksheets.Find(Key))
+	{
+		UE_LOG(LogPMXlsxImporter, Log, TEXT("Using cached copy of %s:%s"), *XlsxAbsolutePath, *WorksheetName);
+		return *CachedWorksheet;
+	}
+
+	UPMXlsxImporterPythonBridge* PythonBridge = UPMXlsxImporterPythonBridge::Get();
+	if (PythonBridge == nullptr)
+	{
+		return nullptr; // UPMXlsxImporterPythonBridge::Get() logs an error when it returns null
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_ReadWorkbook);
+	FPMXlsxImporterStats::FScopedTimer Timer(&Stats, EPMXlsxImporterPhase::ReadWorkbook, XlsxAbsolutePath);
+	Stats.FindOrAddRow(XlsxAbsolutePath).NumBytesRead += FMath::Max<int64>(Key.FileSize, 0);
+
+	TSharedPtr<const FPMXlsxImporterWorksheet> ParsedWorksheet = PythonBridge->ReadColumnarWorksheet(XlsxAbsolutePath, WorksheetName);
+	// Failures aren't cached, so that the next phase tries again instead of seeing an empty worksheet
+	if (ParsedWorksheet.IsValid())
+	{
+		ParsedWorksheets.Add(Key, ParsedWorksheet);
+	}
+	return ParsedWorksheet;
+}
+
+void FPMXlsxImporterSession::ReadWorkbooks(const TArray<const FPMXlsxImporterSettingsEntry*>& Entries)
+{
+	// Group worksheets by workbook, keeping the order they appear in settings
+	TMap<FString, TArray<FString>> WorksheetNamesByWorkbook;
+	for (const FPMXlsxImporterSettingsEntry* Entry : Entries)
+	{
+		const FString XlsxAbsolutePath = Entry->GetXlsxAbsolutePath();
+		if (!XlsxAbsolutePath.IsEmpty() && !Entry->WorksheetName.IsEmpty())
+		{
+			WorksheetNamesByWorkbook.FindOrAdd(XlsxAbsolutePath).AddUnique(Entry->WorksheetName);
+		}
+	}
+
+	if (WorksheetNamesByWorkbook.Num() == 0)
+	{
+		return;
+	}
+
+	UPMXlsxImporterPythonBridge* PythonBridge = UPMXlsxImporterPythonBridge::Get();
+	if (PythonBridge == nullptr)
+	{
+		return; // UPMXlsxImporterPythonBridge::Get() logs an error when it returns null
+	}
+
+	for (const TPair<FString, TArray<FString>>& Workbook : WorksheetNamesByWorkbook)
+	{
+		const FString& XlsxAbsolutePath = Workbook.Key;
+		const FFileStatData StatData = IFileManager::Get().GetStatData(*XlsxAbsolutePath);
+
+		TArray<FString> WorksheetNamesToRead;
+		for (const FString& WorksheetName : Workbook.Value)
+		{
+			if (!ParsedWorksheets.Contains(MakeWorksheetKey(XlsxAbsolutePath, WorksheetName, StatData)))
+			{
+				WorksheetNamesToRead.Add(WorksheetName);
+			}
+		}
+
+		if (WorksheetNamesToRead.Num() == 0)
+		{
+			continue;
+		}
+
+		UE_LOG(LogPMXlsxImporter, Log, TEXT("Reading %i worksheets from %s"), WorksheetNamesToRead.Num(), *XlsxAbsolutePath);
+
+		TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_ReadWorkbook);
+		FPMXlsxImporterStats::FScopedTimer Timer(&Stats, EPMXlsxImporterPhase::ReadWorkbook, XlsxAbsolutePath);
+		Stats.FindOrAddRow(XlsxAbsolutePath).NumBytesRead += FMath::Max<int64>(StatData.FileSize, 0);
+
+		// Worksheets that fail to read are left out, and ReadWorksheet will try them again individually
+		for (const TSharedRef<FPMXlsxImporterWorksheet>& Worksheet : PythonBridge->ReadColumnarWorksheets(XlsxAbsolutePath, WorksheetNamesToRead))
+		{
+			ParsedWorksheets.Add(MakeWorksheetKey(XlsxAbsolutePath, Worksheet->GetName(), StatData), Worksheet);
+		}
+	}
+}
+
+TArray<const FPMXlsxImporterSettingsEntry*> FPMXlsxImporterSession::FindChangedEntries(const TArray<const FPMXlsxImporterSettingsEntry*>& Entries)
+{
+	const bool bReadNatively = GetDefault<UPMXlsxImporterSettings>()->bUseNativeReader;
+
+	// Each workbook's central directory and workbook part are only read once, however many entries use it
+	TMap<FString, TUniquePtr<FPMXlsxImporterWorkbook>> Workbooks;
+
+	TArray<const FPMXlsxImporterSettingsEntry*> ChangedEntries;
+	for (const FPMXlsxImporterSettingsEntry* Entry : Entries)
+	{
+		const FString XlsxAbsolutePath = Entry->GetXlsxAbsolutePath();
+		FPrimaryAssetTypeInfo TypeInfo;
+		if (XlsxAbsolutePath.IsEmpty() ||
+			Entry->WorksheetName.IsEmpty() ||
+			!UAssetManager::Get().GetPrimaryAssetTypeInfo(Entry->DataAssetType, TypeInfo) ||
+			TypeInfo.AssetBaseClassLoaded == nullptr)
+		{
+			// Let the import phases report what's wrong with this entry
+			ChangedEntries.Add(Entry);
+			continue;
+		}
+
+		TUniquePtr<FPMXlsxImporterWorkbook>& Workbook = Workbooks.FindOrAdd(XlsxAbsolutePath);
+		if (!Workbook.IsValid())
+		{
+			Workbook = MakeUnique<FPMXlsxImporterWorkbook>();
+			if (!Workbook->Open(XlsxAbsolutePath))
+			{
+				UE_LOG(LogPMXlsxImporter, Verbose, TEXT("Unable to fingerprint worksheets in %s"), *XlsxAbsolutePath);
+			}
+		}
+
+		FPMXlsxImporterWorksheetFingerprint Fingerprint;
+		if (Workbook->GetWorksheetFingerprint(Entry->WorksheetName, Fingerprint))
+		{
+			Fingerprint.bReadNatively = bReadNatively;
+		}
+
+		const FString ImportStateKey = Entry->GetImportStateKey();
+		const uint64 LayoutHash = FPMXlsxImporterImportPlan::Get(*TypeInfo.AssetBaseClassLoaded).GetLayoutHash();
+		const FPMXlsxImporterImportState::FEntry* PreviousEntry = PreviousImportState.FindEntry(ImportStateKey);
+		if (!bFullImport &&
+			Fingerprint.IsValid() &&
+			PreviousEntry != nullptr &&
+			PreviousEntry->LayoutHash == LayoutHash &&
+			PreviousEntry->Fingerprint == Fingerprint)
+		{
+			UE_LOG(LogPMXlsxImporter, Log, TEXT("Skipping %s:%s because it is unchanged since the last import"), *Entry->XlsxFile.FilePath, *Entry->WorksheetName);
+			continue;
+		}
+
+		// Recorded now, but only saved if the whole run succeeds
+		FPMXlsxImporterImportState::FEntry& CurrentEntry = CurrentImportState.FindOrAddEntry(ImportStateKey);
+		CurrentEntry.LayoutHash = LayoutHash;
+		CurrentEntry.Fingerprint = Fingerprint;
+		ChangedEntries.Add(Entry);
+	}
+	return ChangedEntries;
+}
+
+bool FPMXlsxImporterSession::IsRowUnchanged(const FString& EntryKey, uint64 LayoutHash, const FString& AssetName, uint64 RowHash) const
+{
+	if (bFullImport)
+	{
+		return false;
+	}
+
+	const FPMXlsxImporterImportState::FEntry* Entry = PreviousImportState.FindEntry(EntryKey);
+	if (Entry == nullptr || Entry->LayoutHash != LayoutHash)
+	{
+		return false;
+	}
+
+	const uint64* PreviousRowHash = Entry->RowHashes.Find(AssetName);
+	return PreviousRowHash != nullptr && *PreviousRowHash == RowHash;
+}
+
+void FPMXlsxImporterSession::RecordRow(const FString& EntryKey, uint64 LayoutHash, const FString& AssetName, uint64 RowHash)
+{
+	FPMXlsxImporterImportState::FEntry& Entry = CurrentImportState.FindOrAddEntry(EntryKey);
+	if (Entry.LayoutHash != LayoutHash)
+	{
+		Entry.LayoutHash = LayoutHash;
+		Entry.RowHashes.Reset();
+	}
+	Entry.RowHashes.Add(AssetName, RowHash);
+}
+
+void FPMXlsxImporterSession::ForgetRow(const FString& EntryKey, const FString& AssetName)
+{
+	if (!bFullImport)
+	{
+		PreviousImportState.FindOrAddEntry(EntryKey).RowHashes.Remove(AssetName);
+	}
+}
+
+void FPMXlsxImporterSession::SaveImportState()
+{
+	// Entries that weren't part of this run (e.g. when importing a single entry) keep their previous state
+	PreviousImportState.Append(CurrentImportState);
+	PreviousImportState.Save(FPMXlsxImporterImportState::GetDefaultFilePath());
+	CurrentImportState = FPMXlsxImporterImportState();
+}
+
+FPMXlsxImporterSession::FWorksheetKey FPMXlsxImporterSession::MakeWorksheetKey(const FString& XlsxAbsolutePath, const FString& WorksheetName, const FFileStatData& StatData)
+{
+	FWorksheetKey Key;
+	Key.XlsxAbsolutePath = XlsxAbsolutePath;
+	Key.WorksheetName = WorksheetName;
+	Key.ModificationTime = StatData.ModificationTime;
+	Key.FileSize = StatData.FileSize;
+	return Key;
+}
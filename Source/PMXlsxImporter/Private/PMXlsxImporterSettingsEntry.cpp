@@ -1,334 +1,671 @@
-// Copyright 2022 Proletariat, Inc.
-
-#include "PMXlsxImporterSettingsEntry.h"
-#include "PMXlsxDataAsset.h"
-#include "PMXlsxImporterLog.h"
-#include "EditorAssetLibrary.h"
-#include "Engine/AssetManager.h"
-#include "UObject/SavePackage.h"
-#include "FileHelpers.h"
-
-void FPMXlsxImporterSettingsEntry::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
-{
-	if (PropertyChangedEvent.MemberProperty->GetNameCPP() == TEXT("WorksheetName"))
-	{
-		// Double check that the user picked a valid worksheet name. It's possible they didn't. See
-		// the comment in UPMXlsxImporterSettings::GetWorksheetNames() 
-		const TArray<FString> WorksheetNames = GetWorksheetNames();
-		if (!WorksheetNames.Contains(WorksheetName))
-		{
-			WorksheetName = FString();
-		}
-	}
-
-	if (PropertyChangedEvent.MemberProperty->GetNameCPP() == TEXT("XlsxFile") &&
-		!GetXlsxAbsolutePath().IsEmpty())
-	{
-		const TArray<FString> WorksheetNames = GetWorksheetNames();
-		WorksheetName = WorksheetNames.Num() == 0 ? TEXT("") : WorksheetNames[0];
-	}
-
-	if (PropertyChangedEvent.MemberProperty->GetNameCPP() != TEXT("OutputDir") &&
-		DataAssetType.IsValid() && 
-		!GetXlsxAbsolutePath().IsEmpty() &&
-		!WorksheetName.IsEmpty())
-	{
-		const FString XlsxFilename = FPaths::GetBaseFilename(XlsxFile.FilePath);
-		OutputDir.Path = FString::Printf(TEXT("Generated/%s/%s/%s"), *DataAssetType.ToString(), *XlsxFilename, *WorksheetName);
-	}
-}
-
-TArray<FString> FPMXlsxImporterSettingsEntry::GetWorksheetNames() const
-{
-	const FString& XlsxAbsolutePath = GetXlsxAbsolutePath();
-	if (XlsxAbsolutePath.IsEmpty())
-	{
-		UE_LOG(LogPMXlsxImporter, Warning, TEXT("Could not get worksheet names: xlsx file not set"));
-		return TArray<FString>();
-	}
-
-	UPMXlsxImporterPythonBridge* PythonBridge = UPMXlsxImporterPythonBridge::Get();
-	return PythonBridge ? PythonBridge->ReadWorksheetNames(XlsxAbsolutePath) : TArray<FString>();
-}
-
-void FPMXlsxImporterSettingsEntry::SyncAssets(FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const
-{
-	auto ScopedErrorContext = InOutErrors.PushContext(FString::Printf(TEXT("%s:%s"), *XlsxFile.FilePath, *WorksheetName));
-
-	if (!DataAssetType.IsValid())
-	{
-		InOutErrors.Log(TEXT("Could not sync assets: invalid data asset type"));
-		return;
-	}
-
-	const FString& XlsxAbsolutePath = GetXlsxAbsolutePath();
-	if (XlsxAbsolutePath.IsEmpty())
-	{
-		InOutErrors.Log(TEXT("Could not sync assets: xlsx file not set"));
-		return;
-	}
-
-	if (WorksheetName.IsEmpty())
-	{
-		InOutErrors.Log(TEXT("Could not sync assets: no worksheet name set"));
-		return;
-	}
-
-	if (OutputDir.Path.IsEmpty())
-	{
-		InOutErrors.Log(TEXT("Could not sync assets: no output dir set"));
-		return;
-	}
-
-	UAssetManager& AssetManager = UAssetManager::Get();
-	FPrimaryAssetTypeInfo TypeInfo;
-	if (!AssetManager.GetPrimaryAssetTypeInfo(DataAssetType, TypeInfo))
-	{
-		InOutErrors.Logf(TEXT("Could not sync assets: could not get type info for %s"), *DataAssetType.ToString());
-		return;
-	}
-	UClass* Class = TypeInfo.AssetBaseClassLoaded;
-
-	IFileManager& FileManager = IFileManager::Get();
-
-	UPMXlsxImporterPythonBridge* PythonBridge = UPMXlsxImporterPythonBridge::Get();
-	if (PythonBridge == nullptr)
-	{
-		return; // UPMXlsxImporterPythonBridge::Get() logs an error when it returns null
-	}
-
-	TArray<FPMXlsxImporterPythonBridgeDataAssetInfo> ParsedWorksheet = PythonBridge->ReadWorksheet(XlsxAbsolutePath, WorksheetName);
-
-	for (const FPMXlsxImporterPythonBridgeDataAssetInfo& Info : ParsedWorksheet)
-	{
-		const FString AssetPath = GetProjectRootOutputPath(Info.AssetName);
-		// Note that DoesAssetExist is case-insensitive.
-		// This is good - perforce will have issues if you change the case of a file.
-		if (!UEditorAssetLibrary::DoesAssetExist(AssetPath))
-		{
-			// https://isaratech.com/save-a-procedurally-generated-texture-as-a-new-asset/
-			UPackage* Package = CreatePackage(*AssetPath);
-			Package->FullyLoad();
-			UPMXlsxDataAsset* Asset = NewObject<UPMXlsxDataAsset>(Package, Class, FName(Info.AssetName), RF_Public | RF_Standalone | RF_MarkAsRootSet);
-			Package->MarkPackageDirty();
-			FAssetRegistryModule::AssetCreated(Asset);
-			const FString PackageFileName = FPackageName::LongPackageNameToFilename(AssetPath, FPackageName::GetAssetPackageExtension());
-
-#if ENGINE_MAJOR_VERSION == 4
-			if (!UPackage::SavePackage(Package, Asset, EObjectFlags::RF_NoFlags, *PackageFileName))
-#elif ENGINE_MAJOR_VERSION == 5
-			FSavePackageArgs SaveArgs;
-			if (!UPackage::SavePackage(Package, Asset, *PackageFileName, SaveArgs))
-#else
-#	error Unknown engine version
-#endif
-			{
-				InOutErrors.Logf(TEXT("Unable to save file %s"), *PackageFileName);
-				if (InOutErrors.Num() < MaxErrors)
-				{
-					continue;
-				}
-				else
-				{
-					return;
-				}
-			}
-			UE_LOG(LogPMXlsxImporter, Log, TEXT("Created new asset %s"), *AssetPath);
-
-			const FString AssetAbsolutePath = FileManager.ConvertToAbsolutePathForExternalAppForWrite(*PackageFileName);
-			USourceControlHelpers::MarkFileForAdd(AssetAbsolutePath);
-		}
-	}
-
-	TArray<FString> ExistingAssets = UEditorAssetLibrary::ListAssets(GetProjectRootOutputDir(), /*bRecursive:*/ false, /*bIncludeFolder:*/ false);
-	for (const FString& ExistingAssetPath : ExistingAssets)
-	{
-		// ExistingAssetPath = (e.g.) "/Game/Generated/TestData/test/Sheet1/TestDataFromXLS1.TestDataFromXLS1"
-
-		if (!ShouldAssetExist(ExistingAssetPath, ParsedWorksheet))
-		{
-			// Convert ExistingAssetPath an absolute file path for USourceControlHelpers. There must be a better way to do this.
-			// USourceControlHelpers does try to do this conversion, but it doesn't always work.
-			// PackageName = "/Game/Generated/TestData/test/Sheet1/TestDataFromXLS1"
-			const FString PackageName = FEditorFileUtils::ExtractPackageName(ExistingAssetPath);
-			// RelativePath = "../../../PluginDev/Content/Generated/TestData/test/Sheet1/TestDataFromXLS1.uasset"
-			const FString RelativePath = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
-			// AbsolutePath = "C:/dev/plugindev-main/PluginDev/Content/Generated/TestData/test/Sheet1/TestDataFromXLS1.uasset"
-			const FString AbsolutePath = FileManager.ConvertToAbsolutePathForExternalAppForWrite(*RelativePath);
-
-			FSourceControlState State = USourceControlHelpers::QueryFileState(AbsolutePath);
-			if (!State.bIsValid)
-			{
-				InOutErrors.Logf(TEXT("Source control state is invalid for %s. Refusing to delete this file."), *AbsolutePath);
-				if (InOutErrors.Num() < MaxErrors)
-				{
-					continue;
-				}
-				else
-				{
-					return;
-				}
-			}
-
-			// Internally marks the file for delete in source control and logs what it's doing
-			if (!UEditorAssetLibrary::DeleteAsset(ExistingAssetPath))
-			{
-				InOutErrors.Logf(TEXT("Unable to delete asset %s"), *ExistingAssetPath);
-				if (InOutErrors.Num() >= MaxErrors)
-				{
-					return;
-				}
-			}
-		}
-	}
-
-	// Force the AssetManager to rescan now so that it's up to date when we try to validate FPrimaryAssetIds in ParseData().
-	TArray<FString> PathToScan;
-	PathToScan.Add(GetProjectRootOutputDir());
-	AssetManager.ScanPathsSynchronous(PathToScan);
-}
-
-void FPMXlsxImporterSettingsEntry::ParseData(FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const
-{
-	auto ScopedErrorContext = InOutErrors.PushContext(FString::Printf(TEXT("%s:%s"), *XlsxFile.FilePath, *WorksheetName));
-
-	if (!DataAssetType.IsValid())
-	{
-		InOutErrors.Log(TEXT("Could not parse data: invalid data asset type"));
-		return;
-	}
-
-	const FString& XlsxAbsolutePath = GetXlsxAbsolutePath();
-	if (XlsxAbsolutePath.IsEmpty())
-	{
-		InOutErrors.Log(TEXT("Could not parse asset data: xlsx file not set"));
-		return;
-	}
-
-	if (WorksheetName.IsEmpty())
-	{
-		InOutErrors.Log(TEXT("Could not parse asset data: no worksheet name set"));
-		return;
-	}
-
-	if (OutputDir.Path.IsEmpty())
-	{
-		InOutErrors.Log(TEXT("Could not parse asset data: no output dir set"));
-		return;
-	}
-
-	UPMXlsxImporterPythonBridge* PythonBridge = UPMXlsxImporterPythonBridge::Get();
-	if (PythonBridge == nullptr)
-	{
-		return; // UPMXlsxImporterPythonBridge::Get() logs an error when it returns null
-	}
-
-	TArray<FPMXlsxImporterPythonBridgeDataAssetInfo> ParsedWorksheet = PythonBridge->ReadWorksheet(XlsxAbsolutePath, WorksheetName);
-
-	for (const FPMXlsxImporterPythonBridgeDataAssetInfo& Info : ParsedWorksheet)
-	{
-		FString AssetPath = GetProjectRootOutputPath(Info.AssetName);
-		UPMXlsxDataAsset* Asset = Cast<UPMXlsxDataAsset>(UEditorAssetLibrary::LoadAsset(AssetPath));
-		if (Asset == nullptr)
-		{
-			InOutErrors.Logf(TEXT("Asset %s is not a UPMXlsxDataAsset"), *AssetPath);
-			continue;
-		}
-
-		Asset->ImportFromXLSX(Info.Data, InOutErrors);
-		if (InOutErrors.Num() >= MaxErrors)
-		{
-			return;
-		}
-	}
-}
-
-void FPMXlsxImporterSettingsEntry::Validate(FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const
-{
-	auto ScopedErrorContext = InOutErrors.PushContext(FString::Printf(TEXT("%s:%s"), *XlsxFile.FilePath, *WorksheetName));
-
-	if (!DataAssetType.IsValid())
-	{
-		InOutErrors.Log(TEXT("Could not validate data: invalid data asset type"));
-		return;
-	}
-
-	const FString& XlsxAbsolutePath = GetXlsxAbsolutePath();
-	if (XlsxAbsolutePath.IsEmpty())
-	{
-		InOutErrors.Log(TEXT("Could not validate asset data: xlsx file not set"));
-		return;
-	}
-
-	if (WorksheetName.IsEmpty())
-	{
-		InOutErrors.Log(TEXT("Could not validate asset data: no worksheet name set"));
-		return;
-	}
-
-	if (OutputDir.Path.IsEmpty())
-	{
-		InOutErrors.Log(TEXT("Could not validate asset data: no output dir set"));
-		return;
-	}
-
-	UPMXlsxImporterPythonBridge* PythonBridge = UPMXlsxImporterPythonBridge::Get();
-	if (PythonBridge == nullptr)
-	{
-		return; // UPMXlsxImporterPythonBridge::Get() logs an error when it returns null
-	}
-
-	TArray<FPMXlsxImporterPythonBridgeDataAssetInfo> ParsedWorksheet = PythonBridge->ReadWorksheet(XlsxAbsolutePath, WorksheetName);
-
-	UPMXlsxDataAsset* PreviousAsset = nullptr;
-	for (const FPMXlsxImporterPythonBridgeDataAssetInfo& Info : ParsedWorksheet)
-	{
-		FString AssetPath = GetProjectRootOutputPath(Info.AssetName);
-		UPMXlsxDataAsset* Asset = Cast<UPMXlsxDataAsset>(UEditorAssetLibrary::LoadAsset(AssetPath));
-		if (Asset == nullptr)
-		{
-			InOutErrors.Logf(TEXT("Asset %s is not a UPMXlsxDataAsset"), *AssetPath);
-			continue;
-		}
-
-		Asset->Validate(PreviousAsset, InOutErrors);
-		if (InOutErrors.Num() >= MaxErrors)
-		{
-			return;
-		}
-
-		PreviousAsset = Asset;
-	}
-}
-
-FSourceControlState FPMXlsxImporterSettingsEntry::GetXlsxFileSourceControlState(bool bSilent /* = false*/) const
-{
-	return USourceControlHelpers::QueryFileState(GetXlsxAbsolutePath(), bSilent);
-}
-
-FString FPMXlsxImporterSettingsEntry::GetXlsxAbsolutePath() const
-{
-	return XlsxFile.FilePath.IsEmpty() ? FString() : FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), XlsxFile.FilePath);
-}
-
-FString FPMXlsxImporterSettingsEntry::GetProjectRootOutputDir() const
-{
-	return FString::Printf(TEXT("/Game/%s"), *OutputDir.Path);
-}
-
-FString FPMXlsxImporterSettingsEntry::GetProjectRootOutputPath(const FString& AssetName) const
-{
-	return FString::Printf(TEXT("%s/%s"), *GetProjectRootOutputDir(), *AssetName);
-}
-
-bool FPMXlsxImporterSettingsEntry::ShouldAssetExist(const FString& AssetPath, const TArray<FPMXlsxImporterPythonBridgeDataAssetInfo>& ParsedWorksheet) const
-{
-	for (const FPMXlsxImporterPythonBridgeDataAssetInfo& Info : ParsedWorksheet)
-	{
-		if (AssetPath.EndsWith(FString::Printf(TEXT(".%s"), *Info.AssetName)))
-		{
-			return true;
-		}
-	}
-	return false;
-}
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterSettingsEntry.h"
+#include "PMXlsxDataAsset.h"
+#include "PMXlsxImporterLog.h"
+#include "PMXlsxImporterImportPlan.h"
+#include "PMXlsxImporterRowBatches.h"
+#include "PMXlsxImporterWorkbook.h"
+#include "EditorAssetLibrary.h"
+#include "Engine/AssetManager.h"
+#include "UObject/SavePackage.h"
+#include "FileHelpers.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "UObject/UObjectHash.h"
+
+void FPMXlsxImporterSettingsEntry::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (PropertyChangedEvent.MemberProperty->GetNameCPP() == TEXT("WorksheetName"))
+	{
+		// Double check that the user picked a valid worksheet name. It's possible they didn't. See
+		// the comment in UPMXlsxImporterSettings::GetWorksheetNames() 
+		const TArray<FString> WorksheetNames = GetWorksheetNames();
+		if (!WorksheetNames.Contains(WorksheetName))
+		{
+			WorksheetName = FString();
+		}
+	}
+
+	if (PropertyChangedEvent.MemberProperty->GetNameCPP() == TEXT("XlsxFile") &&
+		!GetXlsxAbsolutePath().IsEmpty())
+	{
+		const TArray<FString> WorksheetNames = GetWorksheetNames();
+		WorksheetName = WorksheetNames.Num() == 0 ? TEXT("") : WorksheetNames[0];
+	}
+
+	if (PropertyChangedEvent.MemberProperty->GetNameCPP() != TEXT("OutputDir") &&
+		DataAssetType.IsValid() && 
+		!GetXlsxAbsolutePath().IsEmpty() &&
+		!WorksheetName.IsEmpty())
+	{
+		const FString XlsxFilename = FPaths::GetBaseFilename(XlsxFile.FilePath);
+		OutputDir.Path = FString::Printf(TEXT("Generated/%s/%s/%s"), *DataAssetType.ToString(), *XlsxFilename, *WorksheetName);
+	}
+}
+
+// Worksheet names of each workbook GetWorksheetNames has read, by absolute path
+struct FPMXlsxImporterCachedWorksheetNames
+{
+	FDateTime ModificationTime;
+	int64 FileSize = 0;
+	TArray<FString> WorksheetNames;
+};
+static TMap<FString, FPMXlsxImporterCachedWorksheetNames> GCachedWorksheetNames;
+
+TArray<FString> FPMXlsxImporterSettingsEntry::GetWorksheetNames() const
+{
+	const FString& XlsxAbsolutePath = GetXlsxAbsolutePath();
+	if (XlsxAbsolutePath.IsEmpty())
+	{
+		UE_LOG(LogPMXlsxImporter, Warning, TEXT("Could not get worksheet names: xlsx file not set"));
+		return TArray<FString>();
+	}
+
+	// The WorksheetName dropdown calls this every time it opens, so names are cached until the file changes
+	const FFileStatData StatData = IFileManager::Get().GetStatData(*XlsxAbsolutePath);
+	FPMXlsxImporterCachedWorksheetNames* CachedNames = GCachedWorksheetNames.Find(XlsxAbsolutePath);
+	if (CachedNames != nullptr && StatData.bIsValid && CachedNames->ModificationTime == StatData.ModificationTime && CachedNames->FileSize == StatData.FileSize)
+	{
+		return CachedNames->WorksheetNames;
+	}
+
+	// Listing worksheets only needs the zip central directory and xl/workbook.xml, so this uses the native reader
+	// whichever reader imports the data. The python bridge is only used for files the native reader can't read.
+	TArray<FString> WorksheetNames;
+	FPMXlsxImporterWorkbook Workbook;
+	if (Workbook.Open(XlsxAbsolutePath))
+	{
+		WorksheetNames = Workbook.GetWorksheetNames();
+	}
+	else if (UPMXlsxImporterPythonBridge* PythonBridge = UPMXlsxImporterPythonBridge::Get())
+	{
+		WorksheetNames = PythonBridge->ReadWorksheetNames(XlsxAbsolutePath);
+	}
+	else
+	{
+		return TArray<FString>();
+	}
+
+	if (StatData.bIsValid)
+	{
+		FPMXlsxImporterCachedWorksheetNames& NewCachedNames = GCachedWorksheetNames.Add(XlsxAbsolutePath);
+		NewCachedNames.ModificationTime = StatData.ModificationTime;
+		NewCachedNames.FileSize = StatData.FileSize;
+		NewCachedNames.WorksheetNames = WorksheetNames;
+	}
+	return WorksheetNames;
+}
+
+// Keeps track of the packages that one batch of a streaming import loads, so that they can be released once the batch
+// is done with them. Does nothing unless the session is streaming, so other imports keep every asset loaded as before.
+class FPMXlsxImporterBatchPackages
+{
+public:
+	explicit FPMXlsxImporterBatchPackages(const FPMXlsxImporterSession& Session)
+		: bEnabled(Session.IsStreaming())
+	{
+	}
+
+	// Call before loading or creating the package. Packages that were already loaded aren't released.
+	void Track(const FString& PackageName)
+	{
+		if (bEnabled && FindPackage(nullptr, *PackageName) == nullptr)
+		{
+			PackageNames.Add(PackageName);
+		}
+	}
+
+	// Lets every tracked package be garbage collected, then collects garbage. KeepLoaded's package stays loaded and
+	// tracked until the next call. So do packages with unsaved changes, e.g. because they couldn't be checked out.
+	void Release(const UObject* KeepLoaded = nullptr)
+	{
+		if (!bEnabled || PackageNames.Num() == 0)
+		{
+			return;
+		}
+
+		TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_ReleasePackages);
+		const UPackage* KeepPackage = KeepLoaded != nullptr ? KeepLoaded->GetOutermost() : nullptr;
+		TArray<FString> KeptPackageNames;
+		for (const FString& PackageName : PackageNames)
+		{
+			UPackage* Package = FindPackage(nullptr, *PackageName);
+			if (Package == nullptr)
+			{
+				continue;
+			}
+
+			if (Package == KeepPackage)
+			{
+				KeptPackageNames.Add(PackageName);
+			}
+			else if (!Package->IsDirty())
+			{
+				ForEachObjectWithPackage(Package, [](UObject* Object)
+				{
+					Object->ClearFlags(RF_Standalone);
+					return true;
+				});
+				Package->ClearFlags(RF_Standalone);
+			}
+		}
+		PackageNames = MoveTemp(KeptPackageNames);
+
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+private:
+	bool bEnabled;
+	TArray<FString> PackageNames;
+};
+
+void FPMXlsxImporterSettingsEntry::SyncAssets(FPMXlsxImporterSession& Session, FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_SyncAssets);
+	FPMXlsxImporterStats::FScopedTimer Timer(&Session.GetStats(), EPMXlsxImporterPhase::SyncAssets, GetStatsName());
+	auto ScopedErrorContext = InOutErrors.PushWorksheetContext(XlsxFile.FilePath, WorksheetName);
+
+	if (!DataAssetType.IsValid())
+	{
+		InOutErrors.Log(TEXT("Could not sync assets: invalid data asset type"));
+		return;
+	}
+
+	const FString& XlsxAbsolutePath = GetXlsxAbsolutePath();
+	if (XlsxAbsolutePath.IsEmpty())
+	{
+		InOutErrors.Log(TEXT("Could not sync assets: xlsx file not set"));
+		return;
+	}
+
+	if (WorksheetName.IsEmpty())
+	{
+		InOutErrors.Log(TEXT("Could not sync assets: no worksheet name set"));
+		return;
+	}
+
+	if (OutputDir.Path.IsEmpty())
+	{
+		InOutErrors.Log(TEXT("Could not sync assets: no output dir set"));
+		return;
+	}
+
+	UAssetManager& AssetManager = UAssetManager::Get();
+	FPrimaryAssetTypeInfo TypeInfo;
+	if (!AssetManager.GetPrimaryAssetTypeInfo(DataAssetType, TypeInfo))
+	{
+		InOutErrors.Logf(TEXT("Could not sync assets: could not get type info for %s"), *DataAssetType.ToString());
+		return;
+	}
+	UClass* Class = TypeInfo.AssetBaseClassLoaded;
+
+	IFileManager& FileManager = IFileManager::Get();
+
+	FPMXlsxImporterRowBatches Batches(Session, XlsxAbsolutePath, WorksheetName);
+	FPMXlsxImporterBatchPackages BatchPackages(Session);
+	TSet<FString> AssetNames;
+	while (Batches.Next())
+	{
+		const FPMXlsxImporterWorksheet& ParsedWorksheet = Batches.GetWorksheet();
+		AssetNames.Reserve(AssetNames.Num() + Batches.GetEndRow() - Batches.GetFirstRow());
+		for (int32 RowIndex = Batches.GetFirstRow(); RowIndex < Batches.GetEndRow(); ++RowIndex)
+		{
+			const FString AssetName = ParsedWorksheet.GetAssetName(RowIndex);
+			AssetNames.Add(AssetName);
+			const FString AssetPath = GetProjectRootOutputPath(AssetName);
+			// Note that DoesAssetExist is case-insensitive.
+			// This is good - perforce will have issues if you change the case of a file.
+			if (!UEditorAssetLibrary::DoesAssetExist(AssetPath))
+			{
+				BatchPackages.Track(AssetPath);
+
+				// https://isaratech.com/save-a-procedurally-generated-texture-as-a-new-asset/
+				UPackage* Package = CreatePackage(*AssetPath);
+				Package->FullyLoad();
+				UPMXlsxDataAsset* Asset = NewObject<UPMXlsxDataAsset>(Package, Class, FName(AssetName), RF_Public | RF_Standalone);
+				Package->MarkPackageDirty();
+				FAssetRegistryModule::AssetCreated(Asset);
+				const FString PackageFileName = FPackageName::LongPackageNameToFilename(AssetPath, FPackageName::GetAssetPackageExtension());
+
+#if ENGINE_MAJOR_VERSION == 4
+				if (!UPackage::SavePackage(Package, Asset, EObjectFlags::RF_NoFlags, *PackageFileName))
+#elif ENGINE_MAJOR_VERSION == 5
+				FSavePackageArgs SaveArgs;
+				if (!UPackage::SavePackage(Package, Asset, *PackageFileName, SaveArgs))
+#else
+#	error Unknown engine version
+#endif
+				{
+					InOutErrors.Logf(TEXT("Unable to save file %s"), *PackageFileName);
+					if (InOutErrors.Num() < MaxErrors)
+					{
+						continue;
+					}
+					else
+					{
+						return;
+					}
+				}
+				UE_LOG(LogPMXlsxImporter, Log, TEXT("Created new asset %s"), *AssetPath);
+
+				// The asset may have existed before and been deleted by hand. Make sure its data gets imported.
+				Session.ForgetRow(GetImportStateKey(), AssetName);
+
+				const FString AssetAbsolutePath = FileManager.ConvertToAbsolutePathForExternalAppForWrite(*PackageFileName);
+				USourceControlHelpers::MarkFileForAdd(AssetAbsolutePath);
+			}
+		}
+		BatchPackages.Release();
+	}
+
+	// Every asset not in the worksheet gets deleted, so stop if we couldn't read all of it
+	if (Batches.HasFailed())
+	{
+		InOutErrors.Logf(TEXT("Could not sync assets: %s"), *Batches.GetError());
+		return;
+	}
+
+	TArray<FString> ExistingAssets = UEditorAssetLibrary::ListAssets(GetProjectRootOutputDir(), /*bRecursive:*/ false, /*bIncludeFolder:*/ false);
+	for (const FString& ExistingAssetPath : ExistingAssets)
+	{
+		// ExistingAssetPath = (e.g.) "/Game/Generated/TestData/test/Sheet1/TestDataFromXLS1.TestDataFromXLS1"
+
+		if (!ShouldAssetExist(ExistingAssetPath, AssetNames))
+		{
+			// Convert ExistingAssetPath an absolute file path for USourceControlHelpers. There must be a better way to do this.
+			// USourceControlHelpers does try to do this conversion, but it doesn't always work.
+			// PackageName = "/Game/Generated/TestData/test/Sheet1/TestDataFromXLS1"
+			const FString PackageName = FEditorFileUtils::ExtractPackageName(ExistingAssetPath);
+			// RelativePath = "../../../PluginDev/Content/Generated/TestData/test/Sheet1/TestDataFromXLS1.uasset"
+			const FString RelativePath = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+			// AbsolutePath = "C:/dev/plugindev-main/PluginDev/Content/Generated/TestData/test/Sheet1/TestDataFromXLS1.uasset"
+			const FString AbsolutePath = FileManager.ConvertToAbsolutePathForExternalAppForWrite(*RelativePath);
+
+			FSourceControlState State = USourceControlHelpers::QueryFileState(AbsolutePath);
+			if (!State.bIsValid)
+			{
+				InOutErrors.Logf(TEXT("Source control state is invalid for %s. Refusing to delete this file."), *AbsolutePath);
+				if (InOutErrors.Num() < MaxErrors)
+				{
+					continue;
+				}
+				else
+				{
+					return;
+				}
+			}
+
+			// Internally marks the file for delete in source control and logs what it's doing
+			if (!UEditorAssetLibrary::DeleteAsset(ExistingAssetPath))
+			{
+				InOutErrors.Logf(TEXT("Unable to delete asset %s"), *ExistingAssetPath);
+				if (InOutErrors.Num() >= MaxErrors)
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	// Force the AssetManager to rescan now so that it's up to date when we try to validate FPrimaryAssetIds in ParseData().
+	TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_ScanAssetRegistry);
+	FPMXlsxImporterStats::FScopedTimer ScanTimer(&Session.GetStats(), EPMXlsxImporterPhase::ScanAssetRegistry, GetStatsName());
+	TArray<FString> PathToScan;
+	PathToScan.Add(GetProjectRootOutputDir());
+	AssetManager.ScanPathsSynchronous(PathToScan);
+}
+
+// Rows are loaded, parsed and applied this many at a time, which bounds the memory used by staged rows
+static const int32 PARSE_DATA_BATCH_SIZE = 1024;
+
+struct FPMXlsxImporterParseDataRow
+{
+	// Columns of the worksheet for Asset's class. Only set if Asset is.
+	const FPMXlsxImporterImportPlanColumns* Columns = nullptr;
+	// Index into Worksheet's rows
+	int32 WorksheetRow = 0;
+	// See FPMXlsxImporterErrorRecord::Row
+	int32 Row = 0;
+	FString AssetPath;
+	UPMXlsxDataAsset* Asset = nullptr;
+	// Only set if Asset can be parsed on worker threads
+	TUniquePtr<FPMXlsxImporterImportPlanStagedRow> StagedRow;
+};
+
+bool FPMXlsxImporterSettingsEntry::ParseDataBatch(FPMXlsxImporterSession& Session, TArray<FPMXlsxImporterParseDataRow>& Batch, FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors)
+{
+	const bool bAnyStagedRows = Batch.ContainsByPredicate([](const FPMXlsxImporterParseDataRow& Row) { return Row.StagedRow.IsValid(); });
+	if (bAnyStagedRows)
+	{
+		ParallelFor(Batch.Num(), [&Batch](int32 Index)
+		{
+			FPMXlsxImporterParseDataRow& Row = Batch[Index];
+			if (Row.StagedRow.IsValid())
+			{
+				Row.Asset->StageFromXLSX(*Row.StagedRow);
+			}
+		});
+	}
+
+	for (FPMXlsxImporterParseDataRow& Row : Batch)
+	{
+		auto ScopedRowContext = InOutErrors.PushRowContext(Row.Row);
+		if (Row.Asset == nullptr)
+		{
+			InOutErrors.Logf(TEXT("Asset %s is not a UPMXlsxDataAsset"), *Row.AssetPath);
+		}
+		else if (Row.StagedRow.IsValid() ? Row.Asset->ImportStagedFromXLSX(*Row.StagedRow, InOutErrors) : Row.Asset->ImportRowFromXLSX(*Row.Columns, Row.WorksheetRow, InOutErrors))
+		{
+			Session.GetAssetSaver().Add(*Row.Asset, XlsxFile.FilePath, WorksheetName);
+		}
+
+		// Free staged values as soon as they're applied
+		Row.StagedRow.Reset();
+
+		if (InOutErrors.Num() >= MaxErrors)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FPMXlsxImporterSettingsEntry::ParseData(FPMXlsxImporterSession& Session, FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_ParseData);
+	// Stopped while streaming imports save each batch, which is timed as the CheckOut and Save phases
+	TOptional<FPMXlsxImporterStats::FScopedTimer> Timer;
+	Timer.Emplace(&Session.GetStats(), EPMXlsxImporterPhase::ParseData, GetStatsName());
+	auto ScopedErrorContext = InOutErrors.PushWorksheetContext(XlsxFile.FilePath, WorksheetName);
+
+	if (!DataAssetType.IsValid())
+	{
+		InOutErrors.Log(TEXT("Could not parse data: invalid data asset type"));
+		return;
+	}
+
+	const FString& XlsxAbsolutePath = GetXlsxAbsolutePath();
+	if (XlsxAbsolutePath.IsEmpty())
+	{
+		InOutErrors.Log(TEXT("Could not parse asset data: xlsx file not set"));
+		return;
+	}
+
+	if (WorksheetName.IsEmpty())
+	{
+		InOutErrors.Log(TEXT("Could not parse asset data: no worksheet name set"));
+		return;
+	}
+
+	if (OutputDir.Path.IsEmpty())
+	{
+		InOutErrors.Log(TEXT("Could not parse asset data: no output dir set"));
+		return;
+	}
+
+	// Rows can only be skipped if we know what class they'd be imported into. SyncAssets reports an error otherwise.
+	FPrimaryAssetTypeInfo TypeInfo;
+	const bool bCanSkipRows = UAssetManager::Get().GetPrimaryAssetTypeInfo(DataAssetType, TypeInfo) && TypeInfo.AssetBaseClassLoaded != nullptr;
+	const uint64 LayoutHash = bCanSkipRows ? FPMXlsxImporterImportPlan::Get(*TypeInfo.AssetBaseClassLoaded).GetLayoutHash() : 0;
+	const FString ImportStateKey = GetImportStateKey();
+
+	FPMXlsxImporterRowBatches Batches(Session, XlsxAbsolutePath, WorksheetName);
+	FPMXlsxImporterBatchPackages BatchPackages(Session);
+	TArray<FPMXlsxImporterParseDataRow> Batch;
+	Batch.Reserve(PARSE_DATA_BATCH_SIZE);
+	// Columns of the current worksheet for each plan that rows have been imported with, so that each plan's columns
+	// are only looked up once per worksheet instead of once per row
+	TMap<const FPMXlsxImporterImportPlan*, TUniquePtr<FPMXlsxImporterImportPlanColumns>> PlanColumns;
+
+	int32 NumSkippedRows = 0;
+	while (Batches.Next())
+	{
+		const FPMXlsxImporterWorksheet& ParsedWorksheet = Batches.GetWorksheet();
+		const int32 NumBatchRows = Batches.GetEndRow() - Batches.GetFirstRow();
+		FPMXlsxImporterStats::FRow& StatsRow = Session.GetStats().FindOrAddRow(GetStatsName());
+		StatsRow.NumRows += NumBatchRows;
+		StatsRow.NumCells += (int64)NumBatchRows * ParsedWorksheet.GetNumColumns();
+
+		for (int32 RowIndex = Batches.GetFirstRow(); RowIndex < Batches.GetEndRow(); ++RowIndex)
+		{
+			const FString AssetName = ParsedWorksheet.GetAssetName(RowIndex);
+			const uint64 RowHash = ParsedWorksheet.HashRow(RowIndex);
+			Session.RecordRow(ImportStateKey, LayoutHash, AssetName, RowHash);
+			if (bCanSkipRows && Session.IsRowUnchanged(ImportStateKey, LayoutHash, AssetName, RowHash))
+			{
+				++NumSkippedRows;
+				continue;
+			}
+
+			FPMXlsxImporterParseDataRow& Row = Batch.AddDefaulted_GetRef();
+			Row.WorksheetRow = RowIndex;
+			Row.Row = Batches.GetRowIndex(RowIndex) + 1;
+			Row.AssetPath = GetProjectRootOutputPath(AssetName);
+			BatchPackages.Track(Row.AssetPath);
+			Row.Asset = Cast<UPMXlsxDataAsset>(UEditorAssetLibrary::LoadAsset(Row.AssetPath));
+			if (Row.Asset != nullptr)
+			{
+				const FPMXlsxImporterImportPlan& Plan = FPMXlsxImporterImportPlan::Get(*Row.Asset->GetClass());
+				TUniquePtr<FPMXlsxImporterImportPlanColumns>& Columns = PlanColumns.FindOrAdd(&Plan);
+				if (!Columns.IsValid())
+				{
+					Columns = MakeUnique<FPMXlsxImporterImportPlanColumns>(Plan, ParsedWorksheet);
+				}
+				Row.Columns = Columns.Get();
+
+				if (Row.Asset->CanParseOnWorkerThreads())
+				{
+					Row.StagedRow = MakeUnique<FPMXlsxImporterImportPlanStagedRow>(*Row.Columns, RowIndex);
+				}
+			}
+
+			if (Batch.Num() == PARSE_DATA_BATCH_SIZE)
+			{
+				if (!ParseDataBatch(Session, Batch, InOutErrors, MaxErrors))
+				{
+					return;
+				}
+				Batch.Reset();
+			}
+		}
+
+		// Rows in Batch point into ParsedWorksheet, which the next batch may replace
+		if (!ParseDataBatch(Session, Batch, InOutErrors, MaxErrors))
+		{
+			return;
+		}
+		Batch.Reset();
+		PlanColumns.Reset();
+
+		if (Session.IsStreaming())
+		{
+			Timer.Reset();
+			Session.GetAssetSaver().CheckOutAndSave(InOutErrors, &Session.GetStats());
+			BatchPackages.Release();
+			if (InOutErrors.Num() >= MaxErrors)
+			{
+				return;
+			}
+			Timer.Emplace(&Session.GetStats(), EPMXlsxImporterPhase::ParseData, GetStatsName());
+		}
+	}
+
+	if (Batches.HasFailed())
+	{
+		InOutErrors.Logf(TEXT("Could not parse asset data: %s"), *Batches.GetError());
+		return;
+	}
+
+	UE_LOG(LogPMXlsxImporter, Log, TEXT("%s:%s: skipped %i of %i rows that are unchanged since the last import"),
+		*XlsxFile.FilePath, *WorksheetName, NumSkippedRows, Batches.GetNumRowsRead()
+	);
+}
+
+struct FPMXlsxImporterValidateRow
+{
+	// See FPMXlsxImporterErrorRecord::Row
+	int32 Row = 0;
+	FString AssetPath;
+	UPMXlsxDataAsset* Asset = nullptr;
+	// The last asset before this one in the worksheet that is a UPMXlsxDataAsset
+	UPMXlsxDataAsset* PreviousAsset = nullptr;
+	// Set if Asset can be validated on worker threads, in which case its errors are collected in Errors first
+	bool bParallel = false;
+	FPMXlsxImporterContextLogger Errors;
+};
+
+void FPMXlsxImporterSettingsEntry::Validate(FPMXlsxImporterSession& Session, FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(PMXlsxImporter_Validate);
+	FPMXlsxImporterStats::FScopedTimer Timer(&Session.GetStats(), EPMXlsxImporterPhase::Validate, GetStatsName());
+	auto ScopedErrorContext = InOutErrors.PushWorksheetContext(XlsxFile.FilePath, WorksheetName);
+
+	if (!DataAssetType.IsValid())
+	{
+		InOutErrors.Log(TEXT("Could not validate data: invalid data asset type"));
+		return;
+	}
+
+	const FString& XlsxAbsolutePath = GetXlsxAbsolutePath();
+	if (XlsxAbsolutePath.IsEmpty())
+	{
+		InOutErrors.Log(TEXT("Could not validate asset data: xlsx file not set"));
+		return;
+	}
+
+	if (WorksheetName.IsEmpty())
+	{
+		InOutErrors.Log(TEXT("Could not validate asset data: no worksheet name set"));
+		return;
+	}
+
+	if (OutputDir.Path.IsEmpty())
+	{
+		InOutErrors.Log(TEXT("Could not validate asset data: no output dir set"));
+		return;
+	}
+
+	FPMXlsxImporterRowBatches Batches(Session, XlsxAbsolutePath, WorksheetName);
+	FPMXlsxImporterBatchPackages BatchPackages(Session);
+	TArray<FPMXlsxImporterValidateRow> Rows;
+
+	// Carried over from the last batch
+	UPMXlsxDataAsset* PreviousAsset = nullptr;
+	while (Batches.Next())
+	{
+		const FPMXlsxImporterWorksheet& ParsedWorksheet = Batches.GetWorksheet();
+
+		// Loading isn't thread safe, so every asset in the batch is loaded up front. Assets whose class allows it are
+		// then validated in parallel into their own loggers, and the errors are merged in row order so the output
+		// doesn't depend on scheduling.
+		Rows.Reset(Batches.GetEndRow() - Batches.GetFirstRow());
+
+		bool bAnyParallelRows = false;
+		for (int32 RowIndex = Batches.GetFirstRow(); RowIndex < Batches.GetEndRow(); ++RowIndex)
+		{
+			FPMXlsxImporterValidateRow& Row = Rows.AddDefaulted_GetRef();
+			Row.Row = Batches.GetRowIndex(RowIndex) + 1;
+			Row.AssetPath = GetProjectRootOutputPath(ParsedWorksheet.GetAssetName(RowIndex));
+			BatchPackages.Track(Row.AssetPath);
+			Row.Asset = Cast<UPMXlsxDataAsset>(UEditorAssetLibrary::LoadAsset(Row.AssetPath));
+			if (Row.Asset == nullptr)
+			{
+				continue;
+			}
+
+			Row.PreviousAsset = PreviousAsset;
+			Row.bParallel = Row.Asset->CanValidateOnWorkerThreads();
+			if (Row.bParallel)
+			{
+				// Import plans can only be built on the game thread
+				FPMXlsxImporterImportPlan::Get(*Row.Asset->GetClass());
+				bAnyParallelRows = true;
+			}
+			PreviousAsset = Row.Asset;
+		}
+
+		if (bAnyParallelRows)
+		{
+			UPMXlsxDataAsset::SetPrimaryAssetSnapshot(&Session.GetPrimaryAssetSnapshot());
+			ParallelFor(Rows.Num(), [&Rows](int32 Index)
+			{
+				FPMXlsxImporterValidateRow& Row = Rows[Index];
+				if (Row.bParallel)
+				{
+					Row.Asset->Validate(Row.PreviousAsset, Row.Errors);
+				}
+			});
+			UPMXlsxDataAsset::SetPrimaryAssetSnapshot(nullptr);
+		}
+
+		for (FPMXlsxImporterValidateRow& Row : Rows)
+		{
+			auto ScopedRowContext = InOutErrors.PushRowContext(Row.Row);
+			if (Row.Asset == nullptr)
+			{
+				InOutErrors.Logf(TEXT("Asset %s is not a UPMXlsxDataAsset"), *Row.AssetPath);
+			}
+			else if (Row.bParallel)
+			{
+				InOutErrors.AppendErrors(Row.Errors, 0, Row.Errors.Num());
+			}
+			else
+			{
+				Row.Asset->Validate(Row.PreviousAsset, InOutErrors);
+			}
+
+			if (InOutErrors.Num() >= MaxErrors)
+			{
+				return;
+			}
+		}
+
+		// PreviousAsset is validated against the first row of the next batch, so it stays loaded
+		Rows.Reset();
+		BatchPackages.Release(PreviousAsset);
+	}
+
+	if (Batches.HasFailed())
+	{
+		InOutErrors.Logf(TEXT("Could not validate asset data: %s"), *Batches.GetError());
+	}
+}
+
+FSourceControlState FPMXlsxImporterSettingsEntry::GetXlsxFileSourceControlState(bool bSilent /* = false*/) const
+{
+	return USourceControlHelpers::QueryFileState(GetXlsxAbsolutePath(), bSilent);
+}
+
+FString FPMXlsxImporterSettingsEntry::GetXlsxAbsolutePath() const
+{
+	return XlsxFile.FilePath.IsEmpty() ? FString() : FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), XlsxFile.FilePath);
+}
+
+FString FPMXlsxImporterSettingsEntry::GetImportStateKey() const
+{
+	return FString::Printf(TEXT("%s:%s>%s"), *XlsxFile.FilePath, *WorksheetName, *OutputDir.Path);
+}
+
+FString FPMXlsxImporterSettingsEntry::GetStatsName() const
+{
+	return FString::Printf(TEXT("%s:%s"), *XlsxFile.FilePath, *WorksheetName);
+}
+
+FString FPMXlsxImporterSettingsEntry::GetProjectRootOutputDir() const
+{
+	return FString::Printf(TEXT("/Game/%s"), *OutputDir.Path);
+}
+
+FString FPMXlsxImporterSettingsEntry::GetProjectRootOutputPath(const FString& AssetName) const
+{
+	return FString::Printf(TEXT("%s/%s"), *GetProjectRootOutputDir(), *AssetName);
+}
+
+bool FPMXlsxImporterSettingsEntry::ShouldAssetExist(const FString& AssetPath, const TSet<FString>& AssetNames) const
+{
+	// FString hashing and comparison are case-insensitive, like the suffix check this replaces
+	int32 DotIndex = INDEX_NONE;
+	return AssetPath.FindLastChar(TEXT('.'), DotIndex) && AssetNames.Contains(AssetPath.RightChop(DotIndex + 1));
+}
@@ -0,0 +1,163 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterStats.h"
+#include "PMXlsxImporterLog.h"
+#include "Misc/FileHelper.h"
+
+static const int32 NUM_PHASES = (int32)EPMXlsxImporterPhase::Num;
+
+// Rows with an empty name hold the phases that run once per run
+static const TCHAR* RUN_ROW_NAME = TEXT("(run)");
+
+double FPMXlsxImporterStats::FRow::GetTotalSeconds() const
+{
+	double Total = 0.0;
+	for (int32 Phase = 0; Phase < NUM_PHASES; ++Phase)
+	{
+		if (Phase != (int32)EPMXlsxImporterPhase::ScanAssetRegistry)
+		{
+			Total += Seconds[Phase];
+		}
+	}
+	return Total;
+}
+
+FPMXlsxImporterStats::FScopedTimer::FScopedTimer(FPMXlsxImporterStats* InStats, EPMXlsxImporterPhase InPhase, const FString& InName)
+	: Stats(InStats)
+	, Phase(InPhase)
+	, Name(InName)
+	, StartTime(FPlatformTime::Seconds())
+{
+}
+
+FPMXlsxImporterStats::FScopedTimer::~FScopedTimer()
+{
+	if (Stats != nullptr)
+	{
+		Stats->FindOrAddRow(Name).Seconds[(int32)Phase] += FPlatformTime::Seconds() - StartTime;
+	}
+}
+
+FPMXlsxImporterStats::FRow& FPMXlsxImporterStats::FindOrAddRow(const FString& Name)
+{
+	check(IsInGameThread());
+	if (FRow* Row = Rows.FindByPredicate([&Name](const FRow& Row) { return Row.Name == Name; }))
+	{
+		return *Row;
+	}
+
+	FRow& Row = Rows.AddDefaulted_GetRef();
+	Row.Name = Name;
+	return Row;
+}
+
+FPMXlsxImporterStats::FRow FPMXlsxImporterStats::GetTotals() const
+{
+	FRow Totals;
+	Totals.Name = TEXT("Total");
+	for (const FRow& Row : Rows)
+	{
+		for (int32 Phase = 0; Phase < NUM_PHASES; ++Phase)
+		{
+			Totals.Seconds[Phase] += Row.Seconds[Phase];
+		}
+		Totals.NumRows += Row.NumRows;
+		Totals.NumCells += Row.NumCells;
+		Totals.NumBytesRead += Row.NumBytesRead;
+		Totals.NumAssetsSaved += Row.NumAssetsSaved;
+	}
+	return Totals;
+}
+
+void FPMXlsxImporterStats::LogSummary() const
+{
+	const FRow Totals = GetTotals();
+
+	int32 NameWidth = FCString::Strlen(RUN_ROW_NAME);
+	for (const FRow& Row : Rows)
+	{
+		NameWidth = FMath::Max(NameWidth, Row.Name.Len());
+	}
+
+	FString Header = FString::Printf(TEXT("%-*s"), NameWidth, TEXT("Entry"));
+	for (int32 Phase = 0; Phase < NUM_PHASES; ++Phase)
+	{
+		Header += FString::Printf(TEXT(" %17s"), GetPhaseName((EPMXlsxImporterPhase)Phase));
+	}
+	Header += TEXT("             Total         Rows        Cells      BytesRead  AssetsSaved");
+
+	auto FormatRow = [NameWidth](const FRow& Row)
+	{
+		FString Line = FString::Printf(TEXT("%-*s"), NameWidth, Row.Name.IsEmpty() ? RUN_ROW_NAME : *Row.Name);
+		for (int32 Phase = 0; Phase < NUM_PHASES; ++Phase)
+		{
+			Line += FString::Printf(TEXT(" %16.3fs"), Row.Seconds[Phase]);
+		}
+		Line += FString::Printf(TEXT(" %16.3fs %12lld %12lld %14lld %12lld"), Row.GetTotalSeconds(), Row.NumRows, Row.NumCells, Row.NumBytesRead, Row.NumAssetsSaved);
+		return Line;
+	};
+
+	UE_LOG(LogPMXlsxImporter, Log, TEXT("Import run summary (%s is part of %s):"), GetPhaseName(EPMXlsxImporterPhase::ScanAssetRegistry), GetPhaseName(EPMXlsxImporterPhase::SyncAssets));
+	UE_LOG(LogPMXlsxImporter, Log, TEXT("%s"), *Header);
+	for (const FRow& Row : Rows)
+	{
+		UE_LOG(LogPMXlsxImporter, Log, TEXT("%s"), *FormatRow(Row));
+	}
+	UE_LOG(LogPMXlsxImporter, Log, TEXT("%s"), *FormatRow(Totals));
+}
+
+FString FPMXlsxImporterStats::ToCsv() const
+{
+	FString Csv = TEXT("Entry");
+	for (int32 Phase = 0; Phase < NUM_PHASES; ++Phase)
+	{
+		Csv += TEXT(",");
+		Csv += GetPhaseName((EPMXlsxImporterPhase)Phase);
+	}
+	Csv += TEXT(",Total,Rows,Cells,BytesRead,AssetsSaved\n");
+
+	auto AppendRow = [&Csv](const FRow& Row)
+	{
+		// Entry names are paths and worksheet names, which may contain commas or quotes
+		Csv += TEXT("\"") + (Row.Name.IsEmpty() ? FString(RUN_ROW_NAME) : Row.Name).Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\"");
+		for (int32 Phase = 0; Phase < NUM_PHASES; ++Phase)
+		{
+			Csv += FString::Printf(TEXT(",%.6f"), Row.Seconds[Phase]);
+		}
+		Csv += FString::Printf(TEXT(",%.6f,%lld,%lld,%lld,%lld\n"), Row.GetTotalSeconds(), Row.NumRows, Row.NumCells, Row.NumBytesRead, Row.NumAssetsSaved);
+	};
+
+	for (const FRow& Row : Rows)
+	{
+		AppendRow(Row);
+	}
+	AppendRow(GetTotals());
+	return Csv;
+}
+
+bool FPMXlsxImporterStats::WriteCsv(const FString& FilePath) const
+{
+	if (!FFileHelper::SaveStringToFile(ToCsv(), *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("Unable to write import stats to %s"), *FilePath);
+		return false;
+	}
+
+	UE_LOG(LogPMXlsxImporter, Log, TEXT("Wrote import stats to %s"), *FilePath);
+	return true;
+}
+
+const TCHAR* FPMXlsxImporterStats::GetPhaseName(EPMXlsxImporterPhase Phase)
+{
+	switch (Phase)
+	{
+	case EPMXlsxImporterPhase::ReadWorkbook: return TEXT("ReadWorkbook");
+	case EPMXlsxImporterPhase::SyncAssets: return TEXT("SyncAssets");
+	case EPMXlsxImporterPhase::ScanAssetRegistry: return TEXT("ScanAssetRegistry");
+	case EPMXlsxImporterPhase::ParseData: return TEXT("ParseData");
+	case EPMXlsxImporterPhase::CheckOut: return TEXT("CheckOut");
+	case EPMXlsxImporterPhase::Save: return TEXT("Save");
+	case EPMXlsxImporterPhase::Validate: return TEXT("Validate");
+	default: return TEXT("Unknown");
+	}
+}
@@ -0,0 +1,325 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterStructParsers.h"
+#include "PMXlsxDataAsset.h"
+#include "PMXlsxImporterParserRegistry.h"
+#include "PMXlsxImporterValueParser.h"
+#include "Containers/StringView.h"
+#include "GameplayTagContainer.h"
+#include "UObject/PrimaryAssetId.h"
+#include "UObject/SoftObjectPath.h"
+
+// The type of FVector's, FVector2D's and FRotator's components
+#if ENGINE_MAJOR_VERSION == 4
+typedef float FPMXlsxImporterReal;
+#elif ENGINE_MAJOR_VERSION == 5
+typedef FVector::FReal FPMXlsxImporterReal;
+#endif
+
+// A component of one of the math structs, e.g. FVector::X, which can be named in full or by its short name
+struct FPMXlsxImporterStructComponent
+{
+	const TCHAR* Name;
+	const TCHAR* ShortName;
+};
+
+static const FPMXlsxImporterStructComponent VECTOR_COMPONENTS[] = { { TEXT("X"), TEXT("X") }, { TEXT("Y"), TEXT("Y") }, { TEXT("Z"), TEXT("Z") } };
+static const FPMXlsxImporterStructComponent ROTATOR_COMPONENTS[] = { { TEXT("Pitch"), TEXT("P") }, { TEXT("Yaw"), TEXT("Y") }, { TEXT("Roll"), TEXT("R") } };
+static const FPMXlsxImporterStructComponent COLOR_COMPONENTS[] = { { TEXT("R"), TEXT("R") }, { TEXT("G"), TEXT("G") }, { TEXT("B"), TEXT("B") }, { TEXT("A"), TEXT("A") } };
+
+// Removes one pair of double quotes, which ImportText accepts around names and paths
+static FStringView UnquoteStructValue(FStringView Value)
+{
+	if (Value.Len() >= 2 && Value[0] == TEXT('"') && Value[Value.Len() - 1] == TEXT('"'))
+	{
+		return Value.Mid(1, Value.Len() - 2);
+	}
+	return Value;
+}
+
+static bool EqualsIgnoreCase(FStringView Value, const TCHAR* Literal)
+{
+	return FCString::Strlen(Literal) == Value.Len() && FCString::Strnicmp(Value.GetData(), Literal, Value.Len()) == 0;
+}
+
+static bool IsEmptyOrNone(FStringView Value)
+{
+	return Value.IsEmpty() || EqualsIgnoreCase(Value, TEXT("None"));
+}
+
+static void SkipWhitespace(FStringView Value, int32& InOutIndex)
+{
+	while (InOutIndex < Value.Len() && FChar::IsWhitespace(Value[InOutIndex]))
+	{
+		++InOutIndex;
+	}
+}
+
+// Parses "1,2,3", "1 2 3", "X=1 Y=2 Z=3" or any of those in parentheses, e.g. "(X=1,Y=2,Z=3)". Positional values must
+// give at least NumRequired components. Named ones may be in any order, and components they leave out keep their
+// value in InOutValues. Returns false for anything else, including numbers ParseDouble leaves to FCString::Atod.
+static bool ParseStructComponents(FStringView Value, const FPMXlsxImporterStructComponent* Components, int32 NumComponents, int32 NumRequired, double* InOutValues)
+{
+	FStringView Fields = Value.TrimStartAndEnd();
+	if (Fields.Len() >= 2 && Fields[0] == TEXT('(') && Fields[Fields.Len() - 1] == TEXT(')'))
+	{
+		Fields = Fields.Mid(1, Fields.Len() - 2).TrimStartAndEnd();
+	}
+
+	const int32 Len = Fields.Len();
+	int32 Index = 0;
+	int32 NumFields = 0;
+	bool bNamed = false;
+	while (Index < Len)
+	{
+		// Fields are separated by a comma, whitespace or both
+		if (NumFields > 0)
+		{
+			const int32 SeparatorStart = Index;
+			SkipWhitespace(Fields, Index);
+			if (Index < Len && Fields[Index] == TEXT(','))
+			{
+				++Index;
+				SkipWhitespace(Fields, Index);
+			}
+			if (Index == SeparatorStart || Index == Len)
+			{
+				return false;
+			}
+		}
+
+		int32 ComponentIndex = NumFields;
+		if (FChar::IsAlpha(Fields[Index]))
+		{
+			const int32 NameStart = Index;
+			while (Index < Len && FChar::IsAlpha(Fields[Index]))
+			{
+				++Index;
+			}
+			const FStringView Name = Fields.Mid(NameStart, Index - NameStart);
+			ComponentIndex = INDEX_NONE;
+			for (int32 Component = 0; Component < NumComponents; ++Component)
+			{
+				if (EqualsIgnoreCase(Name, Components[Component].Name) || EqualsIgnoreCase(Name, Components[Component].ShortName))
+				{
+					ComponentIndex = Component;
+					break;
+				}
+			}
+
+			SkipWhitespace(Fields, Index);
+			if (ComponentIndex == INDEX_NONE || (NumFields > 0 && !bNamed) || Index == Len || Fields[Index] != TEXT('='))
+			{
+				return false;
+			}
+			++Index;
+			SkipWhitespace(Fields, Index);
+			bNamed = true;
+		}
+		else if (bNamed || NumFields == NumComponents)
+		{
+			return false;
+		}
+
+		const int32 NumberStart = Index;
+		while (Index < Len && Fields[Index] != TEXT(',') && !FChar::IsWhitespace(Fields[Index]))
+		{
+			++Index;
+		}
+		if (!FPMXlsxImporterValueParser::ParseDouble(Fields.Mid(NumberStart, Index - NumberStart), InOutValues[ComponentIndex]))
+		{
+			return false;
+		}
+		++NumFields;
+	}
+
+	return bNamed ? NumFields > 0 : NumFields >= NumRequired;
+}
+
+// Falls back on ImportText for the forms the parsers below don't handle, e.g. numbers with more digits than
+// FPMXlsxImporterValueParser::ParseDouble takes. If that fails too, the error lists the forms the struct accepts.
+static bool ImportStructText(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors, const TCHAR* ExpectedForms)
+{
+	if (Property.ImportText(*Value, Result, PPF_None, &Asset, &InOutErrors))
+	{
+		return true;
+	}
+
+	InOutErrors.Logf(TEXT("Unable to parse %s as a %s. Expected %s"), *Value, *CastFieldChecked<FStructProperty>(&Property)->Struct->GetName(), ExpectedForms);
+	return false;
+}
+
+static bool ParseVectorProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	double Components[3] = { 0.0, 0.0, 0.0 };
+	if (ParseStructComponents(FStringView(*Value, Value.Len()), VECTOR_COMPONENTS, 3, 3, Components))
+	{
+		*(FVector*)Result = FVector((FPMXlsxImporterReal)Components[0], (FPMXlsxImporterReal)Components[1], (FPMXlsxImporterReal)Components[2]);
+		return true;
+	}
+	return ImportStructText(Asset, Property, Value, Result, InOutErrors, TEXT("X,Y,Z, X=0 Y=0 Z=0 or (X=0,Y=0,Z=0)"));
+}
+
+static bool ParseVector2DProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	double Components[2] = { 0.0, 0.0 };
+	if (ParseStructComponents(FStringView(*Value, Value.Len()), VECTOR_COMPONENTS, 2, 2, Components))
+	{
+		*(FVector2D*)Result = FVector2D((FPMXlsxImporterReal)Components[0], (FPMXlsxImporterReal)Components[1]);
+		return true;
+	}
+	return ImportStructText(Asset, Property, Value, Result, InOutErrors, TEXT("X,Y, X=0 Y=0 or (X=0,Y=0)"));
+}
+
+static bool ParseRotatorProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	double Components[3] = { 0.0, 0.0, 0.0 };
+	if (ParseStructComponents(FStringView(*Value, Value.Len()), ROTATOR_COMPONENTS, 3, 3, Components))
+	{
+		*(FRotator*)Result = FRotator((FPMXlsxImporterReal)Components[0], (FPMXlsxImporterReal)Components[1], (FPMXlsxImporterReal)Components[2]);
+		return true;
+	}
+	return ImportStructText(Asset, Property, Value, Result, InOutErrors, TEXT("Pitch,Yaw,Roll, P=0 Y=0 R=0 or (Pitch=0,Yaw=0,Roll=0)"));
+}
+
+static bool ParseLinearColorProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	double Components[4] = { 0.0, 0.0, 0.0, 1.0 };
+	if (ParseStructComponents(FStringView(*Value, Value.Len()), COLOR_COMPONENTS, 4, 3, Components))
+	{
+		*(FLinearColor*)Result = FLinearColor((float)Components[0], (float)Components[1], (float)Components[2], (float)Components[3]);
+		return true;
+	}
+	return ImportStructText(Asset, Property, Value, Result, InOutErrors, TEXT("R,G,B, R,G,B,A, R=1 G=1 B=1 A=1 or (R=1,G=1,B=1,A=1)"));
+}
+
+static bool ParseIntPointProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	// Every int32 is exact as a double
+	double Components[2] = { 0.0, 0.0 };
+	if (ParseStructComponents(FStringView(*Value, Value.Len()), VECTOR_COMPONENTS, 2, 2, Components))
+	{
+		bool bIntegral = true;
+		for (const double Component : Components)
+		{
+			bIntegral &= FMath::RoundToZero(Component) == Component && Component >= (double)MIN_int32 && Component <= (double)MAX_int32;
+		}
+		if (bIntegral)
+		{
+			*(FIntPoint*)Result = FIntPoint((int32)Components[0], (int32)Components[1]);
+			return true;
+		}
+	}
+	return ImportStructText(Asset, Property, Value, Result, InOutErrors, TEXT("X,Y, X=0 Y=0 or (X=0,Y=0) with integers"));
+}
+
+static bool ParsePrimaryAssetTypeProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	const FStringView Type = UnquoteStructValue(FStringView(*Value, Value.Len()).TrimStartAndEnd());
+	*(FPrimaryAssetType*)Result = FPrimaryAssetType(FName(Type.Len(), Type.GetData()));
+	return true;
+}
+
+static bool ParsePrimaryAssetIdProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	const FStringView Id = UnquoteStructValue(FStringView(*Value, Value.Len()).TrimStartAndEnd());
+	if (IsEmptyOrNone(Id))
+	{
+		*(FPrimaryAssetId*)Result = FPrimaryAssetId();
+		return true;
+	}
+
+	// ImportText silently leaves ids without a type empty, which usually means a typo
+	int32 Colon = 0;
+	while (Colon < Id.Len() && Id[Colon] != TEXT(':'))
+	{
+		++Colon;
+	}
+	const FStringView Type = Id.Left(Colon).TrimStartAndEnd();
+	const FStringView Name = Id.Mid(Colon + 1).TrimStartAndEnd();
+	if (Colon == Id.Len() || Type.IsEmpty() || Name.IsEmpty())
+	{
+		InOutErrors.Logf(TEXT("Unable to parse %s as a PrimaryAssetId. Expected Type:Name"), *Value);
+		return false;
+	}
+
+	*(FPrimaryAssetId*)Result = FPrimaryAssetId(FPrimaryAssetType(FName(Type.Len(), Type.GetData())), FName(Name.Len(), Name.GetData()));
+	return true;
+}
+
+static bool ParseGameplayTagProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	FStringView TagName = UnquoteStructValue(FStringView(*Value, Value.Len()).TrimStartAndEnd());
+	if (TagName.StartsWith(TEXT("(TagName=")) && TagName.EndsWith(TEXT(")")))
+	{
+		TagName = UnquoteStructValue(TagName.Mid(9, TagName.Len() - 10));
+	}
+	if (IsEmptyOrNone(TagName))
+	{
+		*(FGameplayTag*)Result = FGameplayTag();
+		return true;
+	}
+
+	// Registered tags already have a name, so there's no need to add one
+	const FName Name(TagName.Len(), TagName.GetData(), FNAME_Find);
+	if (!Name.IsNone())
+	{
+		const FGameplayTag Tag = FGameplayTag::RequestGameplayTag(Name, /*ErrorIfNotFound:*/ false);
+		if (Tag.IsValid())
+		{
+			*(FGameplayTag*)Result = Tag;
+			return true;
+		}
+	}
+
+	// ImportText follows tag redirects. It also succeeds for tags that don't exist, leaving them empty.
+	if (Property.ImportText(*Value, Result, PPF_None, &Asset, &InOutErrors) && ((FGameplayTag*)Result)->IsValid())
+	{
+		return true;
+	}
+
+	InOutErrors.Logf(TEXT("%s is not a registered gameplay tag"), *Value);
+	return false;
+}
+
+static bool ParseSoftObjectPathProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	const FStringView Path = UnquoteStructValue(FStringView(*Value, Value.Len()).TrimStartAndEnd());
+	if (IsEmptyOrNone(Path))
+	{
+		((FSoftObjectPath*)Result)->Reset();
+		return true;
+	}
+
+	// Plain paths, e.g. "/Game/Folder/Asset.Asset". ImportText also takes "Class'/Game/Folder/Asset.Asset'".
+	bool bPlainPath = Path[0] == TEXT('/');
+	for (int32 Index = 0; bPlainPath && Index < Path.Len(); ++Index)
+	{
+		bPlainPath = Path[Index] != TEXT('\'') && Path[Index] != TEXT('"');
+	}
+	if (bPlainPath)
+	{
+		FSoftObjectPath& SoftObjectPath = *(FSoftObjectPath*)Result;
+		SoftObjectPath.SetPath(FString(Path.Len(), Path.GetData()));
+		// Like ImportText, which treats the path as loaded
+		SoftObjectPath.FixupCoreRedirects();
+		return true;
+	}
+	return ImportStructText(Asset, Property, Value, Result, InOutErrors, TEXT("a path such as /Game/Folder/Asset.Asset"));
+}
+
+void FPMXlsxImporterStructParsers::Register(FPMXlsxImporterParserRegistry& Registry)
+{
+	// None of these load objects. ImportText, which they fall back on, doesn't either for these structs.
+	Registry.RegisterStructParser(TBaseStructure<FVector>::Get(), &ParseVectorProperty, /*bThreadSafe:*/ true);
+	Registry.RegisterStructParser(TBaseStructure<FVector2D>::Get(), &ParseVector2DProperty, /*bThreadSafe:*/ true);
+	Registry.RegisterStructParser(TBaseStructure<FRotator>::Get(), &ParseRotatorProperty, /*bThreadSafe:*/ true);
+	Registry.RegisterStructParser(TBaseStructure<FLinearColor>::Get(), &ParseLinearColorProperty, /*bThreadSafe:*/ true);
+	Registry.RegisterStructParser(TBaseStructure<FIntPoint>::Get(), &ParseIntPointProperty, /*bThreadSafe:*/ true);
+	Registry.RegisterStructParser(TBaseStructure<FPrimaryAssetType>::Get(), &ParsePrimaryAssetTypeProperty, /*bThreadSafe:*/ true);
+	Registry.RegisterStructParser(TBaseStructure<FPrimaryAssetId>::Get(), &ParsePrimaryAssetIdProperty, /*bThreadSafe:*/ true);
+	// The tag manager locks its tag map, since tags are also requested while loading on other threads
+	Registry.RegisterStructParser(FGameplayTag::StaticStruct(), &ParseGameplayTagProperty, /*bThreadSafe:*/ true);
+	// Core redirects aren't safe to look up while they may be added to on the game thread
+	Registry.RegisterStructParser(TBaseStructure<FSoftObjectPath>::Get(), &ParseSoftObjectPathProperty, /*bThreadSafe:*/ false);
+}
@@ -0,0 +1,23 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FPMXlsxImporterParserRegistry;
+
+// FPMXlsxImporterParseFunctions for the engine structs used most in spreadsheets, which would otherwise fall back on
+// FProperty::ImportText. Besides ImportText's "(X=1,Y=2,Z=3)", they accept forms that are easier to type in a cell:
+//   FVector, FVector2D, FIntPoint: "1,2,3", "1 2 3" or "X=1 Y=2 Z=3"
+//   FRotator: "Pitch,Yaw,Roll" or "P=0 Y=90 R=0"
+//   FLinearColor: "1,0,0", "1,0,0,0.5" or "R=1 G=0 B=0"
+//   FPrimaryAssetId: "Type:Name"
+//   FPrimaryAssetType, FGameplayTag, FSoftObjectPath: the name, tag or path on its own
+// Components left out of the named forms are 0, except for alpha, which is 1. Anything else is passed on to
+// ImportText, and a failure lists the forms the struct accepts.
+class FPMXlsxImporterStructParsers
+{
+public:
+	// Called by UPMXlsxDataAsset::RegisterDefaultParsers
+	static void Register(FPMXlsxImporterParserRegistry& Registry);
+};
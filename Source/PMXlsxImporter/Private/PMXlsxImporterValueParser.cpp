@@ -0,0 +1,269 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterValueParser.h"
+
+// Every power of ten up to 10^22 is exact as a double
+static const double EXACT_POWERS_OF_TEN[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+static const int32 MAX_EXACT_POWER_OF_TEN = UE_ARRAY_COUNT(EXACT_POWERS_OF_TEN) - 1;
+// So is every integer up to 2^53
+static const uint64 MAX_EXACT_MANTISSA = 1ull << 53;
+// Any more and the mantissa could overflow a uint64
+static const int32 MAX_MANTISSA_DIGITS = 19;
+
+static bool IsDigit(TCHAR Char)
+{
+	return Char >= TEXT('0') && Char <= TEXT('9');
+}
+
+// A decimal number, which is Mantissa * 10^Exponent
+struct FPMXlsxImporterDecimal
+{
+	bool bNegative = false;
+	uint64 Mantissa = 0;
+	int32 Exponent = 0;
+	// Whether there was a '.' or an exponent, i.e. whether this isn't written as an integer
+	bool bHasFractionOrExponent = false;
+	// Whether the integer part has more than one digit and starts with 0, e.g. "012"
+	bool bHasLeadingZero = false;
+};
+
+// Returns false if Value isn't a decimal number, or if it has too many significant digits to fit in Mantissa
+static bool ParseDecimal(FStringView Value, FPMXlsxImporterDecimal& OutDecimal)
+{
+	const int32 Len = Value.Len();
+	int32 Index = 0;
+	if (Index < Len && (Value[Index] == TEXT('-') || Value[Index] == TEXT('+')))
+	{
+		OutDecimal.bNegative = Value[Index] == TEXT('-');
+		++Index;
+	}
+
+	// Leading zeros aren't significant, so they don't count towards MAX_MANTISSA_DIGITS
+	int32 NumDigits = 0;
+	int32 NumMantissaDigits = 0;
+	const int32 IntegerStart = Index;
+	for (; Index < Len && IsDigit(Value[Index]); ++Index, ++NumDigits)
+	{
+		if (NumMantissaDigits == 0 && Value[Index] == TEXT('0'))
+		{
+			continue;
+		}
+		if (++NumMantissaDigits > MAX_MANTISSA_DIGITS)
+		{
+			return false;
+		}
+		OutDecimal.Mantissa = OutDecimal.Mantissa * 10 + (Value[Index] - TEXT('0'));
+	}
+	OutDecimal.bHasLeadingZero = NumDigits > 1 && Value[IntegerStart] == TEXT('0');
+
+	if (Index < Len && Value[Index] == TEXT('.'))
+	{
+		OutDecimal.bHasFractionOrExponent = true;
+		for (++Index; Index < Len && IsDigit(Value[Index]); ++Index, ++NumDigits)
+		{
+			--OutDecimal.Exponent;
+			if (NumMantissaDigits == 0 && Value[Index] == TEXT('0'))
+			{
+				continue;
+			}
+			if (++NumMantissaDigits > MAX_MANTISSA_DIGITS)
+			{
+				return false;
+			}
+			OutDecimal.Mantissa = OutDecimal.Mantissa * 10 + (Value[Index] - TEXT('0'));
+		}
+	}
+
+	if (NumDigits == 0)
+	{
+		return false;
+	}
+
+	if (Index < Len && (Value[Index] == TEXT('e') || Value[Index] == TEXT('E')))
+	{
+		OutDecimal.bHasFractionOrExponent = true;
+		++Index;
+		bool bNegativeExponent = false;
+		if (Index < Len && (Value[Index] == TEXT('-') || Value[Index] == TEXT('+')))
+		{
+			bNegativeExponent = Value[Index] == TEXT('-');
+			++Index;
+		}
+
+		// Anything this large is out of range anyway, so stop counting before it can overflow
+		const int32 ExponentStart = Index;
+		int32 Exponent = 0;
+		for (; Index < Len && IsDigit(Value[Index]); ++Index)
+		{
+			Exponent = FMath::Min(Exponent * 10 + (Value[Index] - TEXT('0')), 100000);
+		}
+		if (Index == ExponentStart)
+		{
+			return false;
+		}
+		OutDecimal.Exponent += bNegativeExponent ? -Exponent : Exponent;
+	}
+
+	return Index == Len;
+}
+
+// Clinger's fast path: when the mantissa and the power of ten are both exact doubles, one multiplication or division
+// rounds correctly, which is what strtod does too
+static bool DecimalToDouble(const FPMXlsxImporterDecimal& Decimal, double& OutResult)
+{
+	if (Decimal.Mantissa > MAX_EXACT_MANTISSA)
+	{
+		return false;
+	}
+
+	double Result = (double)Decimal.Mantissa;
+	if (Decimal.Mantissa != 0)
+	{
+		if (Decimal.Exponent > MAX_EXACT_POWER_OF_TEN || Decimal.Exponent < -MAX_EXACT_POWER_OF_TEN)
+		{
+			return false;
+		}
+		Result = Decimal.Exponent >= 0 ? Result * EXACT_POWERS_OF_TEN[Decimal.Exponent] : Result / EXACT_POWERS_OF_TEN[-Decimal.Exponent];
+	}
+
+	OutResult = Decimal.bNegative ? -Result : Result;
+	return true;
+}
+
+bool FPMXlsxImporterValueParser::ParseInt64(FStringView Value, int64& OutResult)
+{
+	FPMXlsxImporterDecimal Decimal;
+	if (!ParseDecimal(Value.TrimStartAndEnd(), Decimal))
+	{
+		return false;
+	}
+
+	if (!Decimal.bHasFractionOrExponent)
+	{
+		const uint64 MaxMagnitude = Decimal.bNegative ? (uint64)MAX_int64 + 1 : (uint64)MAX_int64;
+		if (Decimal.bHasLeadingZero || Decimal.Mantissa > MaxMagnitude)
+		{
+			return false;
+		}
+		OutResult = Decimal.bNegative ? (int64)(0 - Decimal.Mantissa) : (int64)Decimal.Mantissa;
+		return true;
+	}
+
+	// Same as converting the result of FDefaultValueHelper::ParseDouble. -2^63 and 2^63 are exact as doubles, unlike
+	// the int64 limits.
+	double Double = 0.0;
+	if (!DecimalToDouble(Decimal, Double) || FMath::RoundToZero(Double) != Double ||
+		Double < -9223372036854775808.0 || Double >= 9223372036854775808.0)
+	{
+		return false;
+	}
+	OutResult = (int64)Double;
+	return true;
+}
+
+bool FPMXlsxImporterValueParser::ParseDouble(FStringView Value, double& OutResult)
+{
+	FPMXlsxImporterDecimal Decimal;
+	return ParseDecimal(Value.TrimStartAndEnd(), Decimal) && DecimalToDouble(Decimal, OutResult);
+}
+
+// Exactly NumDigits digits starting at Start
+static bool ParseFixedDigits(FStringView Value, int32 Start, int32 NumDigits, int32& OutResult)
+{
+	OutResult = 0;
+	for (int32 Index = Start; Index < Start + NumDigits; ++Index)
+	{
+		if (!IsDigit(Value[Index]))
+		{
+			return false;
+		}
+		OutResult = OutResult * 10 + (Value[Index] - TEXT('0'));
+	}
+	return true;
+}
+
+bool FPMXlsxImporterValueParser::ParseIso8601(FStringView Value, FDateTime& OutResult)
+{
+	const FStringView Trimmed = Value.TrimStartAndEnd();
+	const int32 Len = Trimmed.Len();
+
+	int32 Year = 0, Month = 0, Day = 0;
+	if (Len < 10 || !ParseFixedDigits(Trimmed, 0, 4, Year) || Trimmed[4] != TEXT('-') ||
+		!ParseFixedDigits(Trimmed, 5, 2, Month) || Trimmed[7] != TEXT('-') || !ParseFixedDigits(Trimmed, 8, 2, Day))
+	{
+		return false;
+	}
+
+	int32 Hour = 0, Minute = 0, Second = 0, Millisecond = 0;
+	int32 Index = 10;
+	if (Index < Len && Trimmed[Index] == TEXT('T'))
+	{
+		if (Len < 19 || !ParseFixedDigits(Trimmed, 11, 2, Hour) || Trimmed[13] != TEXT(':') ||
+			!ParseFixedDigits(Trimmed, 14, 2, Minute) || Trimmed[16] != TEXT(':') || !ParseFixedDigits(Trimmed, 17, 2, Second))
+		{
+			return false;
+		}
+		Index = 19;
+
+		// Like FDateTime::ParseIso8601, ".5" is 500 milliseconds
+		if (Index < Len && Trimmed[Index] == TEXT('.'))
+		{
+			int32 NumDigits = 0;
+			for (++Index; Index < Len && IsDigit(Trimmed[Index]); ++Index, ++NumDigits)
+			{
+				Millisecond = Millisecond * 10 + (Trimmed[Index] - TEXT('0'));
+				if (NumDigits == 3)
+				{
+					return false;
+				}
+			}
+			if (NumDigits == 0)
+			{
+				return false;
+			}
+			for (; NumDigits < 3; ++NumDigits)
+			{
+				Millisecond *= 10;
+			}
+		}
+
+		if (Index < Len && Trimmed[Index] == TEXT('Z'))
+		{
+			++Index;
+		}
+	}
+
+	if (Index != Len || !FDateTime::Validate(Year, Month, Day, Hour, Minute, Second, Millisecond))
+	{
+		return false;
+	}
+
+	OutResult = FDateTime(Year, Month, Day, Hour, Minute, Second, Millisecond);
+	return true;
+}
+
+bool FPMXlsxImporterValueParser::ParseSerialDate(FStringView Value, FDateTime& OutResult)
+{
+	// FDateTime can't represent dates before year 1 or after year 9999
+	double Serial = 0.0;
+	if (!ParseDouble(Value, Serial) || !(Serial >= 0.0 && Serial < 2958466.0))
+	{
+		return false;
+	}
+
+	OutResult = SerialToDateTime(Serial, /*bDate1904:*/ false);
+	return true;
+}
+
+FDateTime FPMXlsxImporterValueParser::SerialToDateTime(double Serial, bool bDate1904)
+{
+	// The 1900 date system counts 1900-02-29, which didn't exist, to stay compatible with Lotus 1-2-3. Serial dates
+	// from 1900-03-01 on are days since 1899-12-30. Earlier ones are off by one.
+	const FDateTime Epoch = bDate1904 ? FDateTime(1904, 1, 1) : (Serial < 61.0 ? FDateTime(1899, 12, 31) : FDateTime(1899, 12, 30));
+	// Excel only stores times to the millisecond, and rounding hides the error in the double
+	const int64 Milliseconds = FMath::RoundToDouble(Serial * 24.0 * 60.0 * 60.0 * 1000.0);
+	return Epoch + FTimespan(Milliseconds * ETimespan::TicksPerMillisecond);
+}
@@ -0,0 +1,884 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterWorkbook.h"
+#include "PMXlsxImporterLog.h"
+#include "PMXlsxImporterSettings.h"
+#include "PMXlsxImporterValueParser.h"
+
+// See ECMA-376 Part 1, "SpreadsheetML"
+static const TCHAR* const WORKBOOK_PART_NAME = TEXT("xl/workbook.xml");
+static const TCHAR* const WORKBOOK_RELATIONSHIPS_PART_NAME = TEXT("xl/_rels/workbook.xml.rels");
+static const TCHAR* const DEFAULT_SHARED_STRINGS_PART_NAME = TEXT("xl/sharedStrings.xml");
+static const TCHAR* const DEFAULT_STYLES_PART_NAME = TEXT("xl/styles.xml");
+static const TCHAR* const NAME_HEADER = TEXT("Name");
+
+using EToken = FPMXlsxImporterXmlReader::EToken;
+
+// Shared and inline strings escape characters that are invalid in XML as "_xHHHH_"
+static void UnescapeOoxmlString(TArray<ANSICHAR>& InOutUTF8)
+{
+	int32 WriteIndex = 0;
+	const int32 Num = InOutUTF8.Num();
+	for (int32 ReadIndex = 0; ReadIndex < Num; ++ReadIndex)
+	{
+		if (InOutUTF8[ReadIndex] == '_' && ReadIndex + 6 < Num && InOutUTF8[ReadIndex + 1] == 'x' && InOutUTF8[ReadIndex + 6] == '_' &&
+			FCharAnsi::IsHexDigit(InOutUTF8[ReadIndex + 2]) && FCharAnsi::IsHexDigit(InOutUTF8[ReadIndex + 3]) &&
+			FCharAnsi::IsHexDigit(InOutUTF8[ReadIndex + 4]) && FCharAnsi::IsHexDigit(InOutUTF8[ReadIndex + 5]))
+		{
+			const ANSICHAR HexDigits[5] = { InOutUTF8[ReadIndex + 2], InOutUTF8[ReadIndex + 3], InOutUTF8[ReadIndex + 4], InOutUTF8[ReadIndex + 5], 0 };
+			const uint32 Codepoint = FCStringAnsi::Strtoui64(HexDigits, nullptr, 16);
+			// Only control characters are escaped this way in practice, so they always fit in one byte
+			if (Codepoint < 0x80)
+			{
+				InOutUTF8[WriteIndex++] = (ANSICHAR)Codepoint;
+				ReadIndex += 6;
+				continue;
+			}
+		}
+		InOutUTF8[WriteIndex++] = InOutUTF8[ReadIndex];
+	}
+	InOutUTF8.SetNum(WriteIndex, /*bAllowShrinking:*/ false);
+}
+
+// Appends the text of a Text token to OutUTF8, decoding entities if necessary
+static void AppendText(const FPMXlsxImporterXmlReader& Reader, TArray<ANSICHAR>& OutUTF8)
+{
+	if (Reader.IsCData())
+	{
+		OutUTF8.Append(Reader.GetText().Data, Reader.GetText().Len);
+	}
+	else
+	{
+		FPMXlsxImporterXmlReader::AppendDecoded(Reader.GetText(), OutUTF8);
+	}
+}
+
+// Parses a non-negative decimal integer such as a shared string index. Returns INDEX_NONE if Span is not one.
+static int32 ParseIndex(const FPMXlsxImporterXmlSpan& Span)
+{
+	if (Span.Len == 0 || Span.Len > 9)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 Result = 0;
+	for (int32 Index = 0; Index < Span.Len; ++Index)
+	{
+		if (!FCharAnsi::IsDigit(Span.Data[Index]))
+		{
+			return INDEX_NONE;
+		}
+		Result = Result * 10 + (Span.Data[Index] - '0');
+	}
+	return Result;
+}
+
+// Converts the column letters of a cell reference like "AB12" to a zero-based column index.
+// Returns INDEX_NONE if there are no letters.
+static int32 ParseColumnIndex(const FPMXlsxImporterXmlSpan& CellReference)
+{
+	int32 Column = 0;
+	int32 Index = 0;
+	for (; Index < CellReference.Len && FCharAnsi::IsAlpha(CellReference.Data[Index]); ++Index)
+	{
+		Column = Column * 26 + (FCharAnsi::ToUpper(CellReference.Data[Index]) - 'A' + 1);
+	}
+	return Index == 0 ? INDEX_NONE : Column - 1;
+}
+
+// Returns the one-based row number of a cell reference like "AB12", or INDEX_NONE if there isn't one
+static int32 ParseRowNumber(const FPMXlsxImporterXmlSpan& CellReference)
+{
+	int32 Index = 0;
+	while (Index < CellReference.Len && FCharAnsi::IsAlpha(CellReference.Data[Index]))
+	{
+		++Index;
+	}
+	return ParseIndex(FPMXlsxImporterXmlSpan{ CellReference.Data + Index, CellReference.Len - Index });
+}
+
+// Built-in number formats that display dates or times. See ECMA-376 Part 1, 18.8.30. 27-36 and 50-58 are dates in
+// East Asian locales.
+static bool IsBuiltInDateNumberFormat(int32 NumberFormatId)
+{
+	return (NumberFormatId >= 14 && NumberFormatId <= 22) ||
+		(NumberFormatId >= 27 && NumberFormatId <= 36) ||
+		(NumberFormatId >= 45 && NumberFormatId <= 47) ||
+		(NumberFormatId >= 50 && NumberFormatId <= 58);
+}
+
+// Returns whether a custom number format code like "yyyy-mm-dd" or "h:mm AM/PM" displays a date or time.
+// Literal text ("..." or \x) and bracketed sections like colors and conditions are ignored.
+static bool IsDateFormatCode(const FString& FormatCode)
+{
+	bool bInQuotes = false;
+	for (int32 Index = 0; Index < FormatCode.Len(); ++Index)
+	{
+		const TCHAR Char = FormatCode[Index];
+		if (Char == TEXT('"'))
+		{
+			bInQuotes = !bInQuotes;
+		}
+		else if (bInQuotes)
+		{
+			continue;
+		}
+		else if (Char == TEXT('\\') || Char == TEXT('_') || Char == TEXT('*'))
+		{
+			// Escaped literal, padding or fill. The next character is not a format character.
+			++Index;
+		}
+		else if (Char == TEXT('['))
+		{
+			// Elapsed time like [h]:mm is a duration, not a date, so the whole section is skipped either way
+			const int32 End = FormatCode.Find(TEXT("]"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Index);
+			if (End == INDEX_NONE)
+			{
+				return false;
+			}
+			Index = End;
+		}
+		else
+		{
+			switch (FChar::ToLower(Char))
+			{
+			case TEXT('d'):
+			case TEXT('m'):
+			case TEXT('y'):
+			case TEXT('h'):
+			case TEXT('s'):
+				return true;
+			default:
+				break;
+			}
+		}
+	}
+	return false;
+}
+
+bool FPMXlsxImporterWorkbook::Open(const FString& AbsoluteFilePath)
+{
+	WorksheetNames.Reset();
+	WorksheetPartNames.Reset();
+	SharedStrings.Reset();
+	SharedStringsPartName = DEFAULT_SHARED_STRINGS_PART_NAME;
+	bSharedStringsRead = false;
+	DateStyles.Empty();
+	StylesPartName = DEFAULT_STYLES_PART_NAME;
+	bStylesRead = false;
+	bDate1904 = false;
+
+	UE_LOG(LogPMXlsxImporter, Verbose, TEXT("Reading xlsx file \"%s\""), *AbsoluteFilePath);
+
+	return Archive.Open(AbsoluteFilePath) && ReadWorkbookPart();
+}
+
+bool FPMXlsxImporterWorkbook::ExtractPart(const FString& PartName, TArray<uint8>& OutData) const
+{
+	const FPMXlsxImporterZipArchive::FEntry* Entry = Archive.FindEntry(PartName);
+	if (Entry == nullptr)
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s does not contain %s"), *Archive.GetFilePath(), *PartName);
+		return false;
+	}
+	return Archive.Extract(*Entry, OutData);
+}
+
+bool FPMXlsxImporterWorkbook::ReadWorkbookPart()
+{
+	// Map relationship ids to part names so that each <sheet> can be matched to its worksheet part.
+	// The relationships part is tiny, and without it sheet order and part names aren't guaranteed to line up.
+	TMap<FString, FString> RelationshipTargets;
+	TArray<uint8> Data;
+	if (Archive.FindEntry(WORKBOOK_RELATIONSHIPS_PART_NAME) != nullptr)
+	{
+		if (!ExtractPart(WORKBOOK_RELATIONSHIPS_PART_NAME, Data))
+		{
+			return false;
+		}
+
+		FPMXlsxImporterXmlReader Reader(Data.GetData(), Data.Num());
+		for (EToken Token = Reader.Next(); Token != EToken::End; Token = Reader.Next())
+		{
+			if (Token == EToken::Error)
+			{
+				UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: malformed %s"), *Archive.GetFilePath(), WORKBOOK_RELATIONSHIPS_PART_NAME);
+				return false;
+			}
+
+			if (Token != EToken::StartElement || !Reader.GetName().Equals("Relationship"))
+			{
+				continue;
+			}
+
+			FString Id;
+			FString Target;
+			FString Type;
+			if (!Reader.FindAttribute("Id", Id) || !Reader.FindAttribute("Target", Target))
+			{
+				continue;
+			}
+			Reader.FindAttribute("Type", Type);
+
+			// Targets are relative to xl/ unless they start with a slash
+			FString PartName = Target.StartsWith(TEXT("/")) ? Target.RightChop(1) : FString(TEXT("xl/")) + Target;
+			FPaths::CollapseRelativeDirectories(PartName);
+
+			if (Type.EndsWith(TEXT("/sharedStrings")))
+			{
+				SharedStringsPartName = PartName;
+			}
+			else if (Type.EndsWith(TEXT("/styles")))
+			{
+				StylesPartName = PartName;
+			}
+			RelationshipTargets.Add(Id, PartName);
+		}
+	}
+
+	if (!ExtractPart(WORKBOOK_PART_NAME, Data))
+	{
+		return false;
+	}
+
+	FPMXlsxImporterXmlReader Reader(Data.GetData(), Data.Num());
+	for (EToken Token = Reader.Next(); Token != EToken::End; Token = Reader.Next())
+	{
+		if (Token == EToken::Error)
+		{
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: malformed %s"), *Archive.GetFilePath(), WORKBOOK_PART_NAME);
+			return false;
+		}
+
+		if (Token != EToken::StartElement)
+		{
+			continue;
+		}
+
+		if (Reader.GetName().Equals("workbookPr"))
+		{
+			FPMXlsxImporterXmlSpan Date1904;
+			bDate1904 = Reader.FindAttribute("date1904", Date1904) && (Date1904.Equals("1") || Date1904.Equals("true"));
+			continue;
+		}
+
+		if (!Reader.GetName().Equals("sheet"))
+		{
+			continue;
+		}
+
+		FString SheetName;
+		if (!Reader.FindAttribute("name", SheetName))
+		{
+			continue;
+		}
+
+		// r:id. FindAttribute ignores namespace prefixes.
+		FString RelationshipId;
+		const FString* PartName = Reader.FindAttribute("id", RelationshipId) ? RelationshipTargets.Find(RelationshipId) : nullptr;
+		if (PartName == nullptr)
+		{
+			// No relationships part. Fall back on the naming convention every spreadsheet application uses.
+			FString SheetId;
+			Reader.FindAttribute("sheetId", SheetId);
+			WorksheetPartNames.Add(FString::Printf(TEXT("xl/worksheets/sheet%s.xml"), *SheetId));
+		}
+		else
+		{
+			WorksheetPartNames.Add(*PartName);
+		}
+		WorksheetNames.Add(SheetName);
+	}
+
+	UE_LOG(LogPMXlsxImporter, Verbose, TEXT("All sheet names: %s"), *FString::Join(WorksheetNames, TEXT(", ")));
+	return true;
+}
+
+bool FPMXlsxImporterWorkbook::ReadSharedStrings()
+{
+	if (bSharedStringsRead)
+	{
+		return true;
+	}
+
+	if (Archive.FindEntry(SharedStringsPartName) == nullptr)
+	{
+		// Workbooks without any text cells don't need a shared strings part
+		bSharedStringsRead = true;
+		return true;
+	}
+
+	TArray<uint8> Data;
+	if (!ExtractPart(SharedStringsPartName, Data))
+	{
+		return false;
+	}
+
+	TArray<ANSICHAR> StringBuffer;
+	bool bInText = false;
+	int32 PhoneticDepth = 0;
+
+	FPMXlsxImporterXmlReader Reader(Data.GetData(), Data.Num());
+	for (EToken Token = Reader.Next(); Token != EToken::End; Token = Reader.Next())
+	{
+		const FPMXlsxImporterXmlSpan& Name = Reader.GetName();
+		switch (Token)
+		{
+		case EToken::Error:
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: malformed %s"), *Archive.GetFilePath(), *SharedStringsPartName);
+			return false;
+
+		case EToken::StartElement:
+			if (Name.Equals("sst"))
+			{
+				FPMXlsxImporterXmlSpan UniqueCount;
+				if (Reader.FindAttribute("uniqueCount", UniqueCount))
+				{
+					SharedStrings.Reserve(FMath::Max(0, ParseIndex(UniqueCount)));
+				}
+			}
+			else if (Name.Equals("si"))
+			{
+				StringBuffer.Reset();
+			}
+			else if (Name.Equals("rPh"))
+			{
+				// Phonetic hints for East Asian text. Their <t> elements are not part of the string's value.
+				++PhoneticDepth;
+			}
+			else if (Name.Equals("t"))
+			{
+				bInText = PhoneticDepth == 0;
+			}
+			break;
+
+		case EToken::EndElement:
+			if (Name.Equals("si"))
+			{
+				UnescapeOoxmlString(StringBuffer);
+				SharedStrings.Add(FPMXlsxImporterXmlReader::ToString(StringBuffer.GetData(), StringBuffer.Num()));
+			}
+			else if (Name.Equals("rPh"))
+			{
+				--PhoneticDepth;
+			}
+			else if (Name.Equals("t"))
+			{
+				bInText = false;
+			}
+			break;
+
+		case EToken::Text:
+			if (bInText)
+			{
+				AppendText(Reader, StringBuffer);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	UE_LOG(LogPMXlsxImporter, Verbose, TEXT("Read %i shared strings from %s"), SharedStrings.Num(), *Archive.GetFilePath());
+	bSharedStringsRead = true;
+	return true;
+}
+
+bool FPMXlsxImporterWorkbook::ReadStyles()
+{
+	if (bStylesRead)
+	{
+		return true;
+	}
+
+	if (Archive.FindEntry(StylesPartName) == nullptr)
+	{
+		// Without a styles part every cell uses the General number format
+		bStylesRead = true;
+		return true;
+	}
+
+	TArray<uint8> Data;
+	if (!ExtractPart(StylesPartName, Data))
+	{
+		return false;
+	}
+
+	// Custom number formats are declared in <numFmts> before <cellXfs> refers to them
+	TSet<int32> CustomDateNumberFormats;
+	bool bInCellFormats = false;
+
+	FPMXlsxImporterXmlReader Reader(Data.GetData(), Data.Num());
+	for (EToken Token = Reader.Next(); Token != EToken::End; Token = Reader.Next())
+	{
+		const FPMXlsxImporterXmlSpan& Name = Reader.GetName();
+		switch (Token)
+		{
+		case EToken::Error:
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: malformed %s"), *Archive.GetFilePath(), *StylesPartName);
+			return false;
+
+		case EToken::StartElement:
+			if (Name.Equals("numFmt"))
+			{
+				FPMXlsxImporterXmlSpan NumberFormatId;
+				FString FormatCode;
+				if (Reader.FindAttribute("numFmtId", NumberFormatId) && Reader.FindAttribute("formatCode", FormatCode) && IsDateFormatCode(FormatCode))
+				{
+					CustomDateNumberFormats.Add(ParseIndex(NumberFormatId));
+				}
+			}
+			else if (Name.Equals("cellXfs"))
+			{
+				bInCellFormats = true;
+			}
+			else if (bInCellFormats && Name.Equals("xf"))
+			{
+				// Cell formats without a numFmtId use General
+				FPMXlsxImporterXmlSpan NumberFormatIdSpan;
+				const int32 NumberFormatId = Reader.FindAttribute("numFmtId", NumberFormatIdSpan) ? ParseIndex(NumberFormatIdSpan) : 0;
+				DateStyles.Add(IsBuiltInDateNumberFormat(NumberFormatId) || CustomDateNumberFormats.Contains(NumberFormatId));
+			}
+			break;
+
+		case EToken::EndElement:
+			if (Name.Equals("cellXfs"))
+			{
+				bInCellFormats = false;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	bStylesRead = true;
+	return true;
+}
+
+bool FPMXlsxImporterWorkbook::IsDateStyle(int32 StyleIndex) const
+{
+	return DateStyles.IsValidIndex(StyleIndex) && DateStyles[StyleIndex];
+}
+
+FDateTime FPMXlsxImporterWorkbook::SerialToDateTime(double Serial) const
+{
+	return FPMXlsxImporterValueParser::SerialToDateTime(Serial, bDate1904);
+}
+
+bool FPMXlsxImporterWorkbook::GetWorksheetFingerprint(const FString& WorksheetName, FPMXlsxImporterWorksheetFingerprint& OutFingerprint) const
+{
+	const int32 WorksheetIndex = WorksheetNames.IndexOfByKey(WorksheetName);
+	if (WorksheetIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FPMXlsxImporterZipArchive::FEntry* WorksheetEntry = Archive.FindEntry(WorksheetPartNames[WorksheetIndex]);
+	if (WorksheetEntry == nullptr)
+	{
+		return false;
+	}
+
+	OutFingerprint = FPMXlsxImporterWorksheetFingerprint();
+	OutFingerprint.WorksheetCrc32 = WorksheetEntry->Crc32;
+	OutFingerprint.WorksheetSize = WorksheetEntry->UncompressedSize;
+
+	// Workbooks without any text cells don't need a shared strings part
+	if (const FPMXlsxImporterZipArchive::FEntry* SharedStringsEntry = Archive.FindEntry(SharedStringsPartName))
+	{
+		OutFingerprint.SharedStringsCrc32 = SharedStringsEntry->Crc32;
+		OutFingerprint.SharedStringsSize = SharedStringsEntry->UncompressedSize;
+	}
+	if (const FPMXlsxImporterZipArchive::FEntry* StylesEntry = Archive.FindEntry(StylesPartName))
+	{
+		OutFingerprint.StylesCrc32 = StylesEntry->Crc32;
+		OutFingerprint.StylesSize = StylesEntry->UncompressedSize;
+	}
+	OutFingerprint.bDate1904 = bDate1904;
+	return true;
+}
+
+bool FPMXlsxImporterWorkbook::ReadWorksheet(FPMXlsxImporterWorksheet& OutWorksheet)
+{
+	FPMXlsxImporterWorksheetReader Reader(*this);
+	if (!Reader.Open(OutWorksheet.GetName()) || !Reader.ReadRows(MAX_int32, OutWorksheet))
+	{
+		return false;
+	}
+
+	OutWorksheet.Shrink();
+	UE_LOG(LogPMXlsxImporter, Verbose, TEXT("Read %i rows from %s:%s into %llu bytes"), OutWorksheet.GetNumRows(), *Archive.GetFilePath(), *OutWorksheet.GetName(), (uint64)OutWorksheet.GetAllocatedSize());
+	return true;
+}
+
+// Windows of the worksheet part are inflated this many bytes at a time
+static const int32 WORKSHEET_WINDOW_SIZE = 1024 * 1024;
+
+// Returns the length of Data up to and including the last row end tag, or 0 if there isn't one.
+// Rows are never split across windows, so the state of the cell being read never has to carry over.
+static int32 FindEndOfLastRow(const uint8* Data, int32 Num)
+{
+	for (int32 Index = Num - 4; Index >= 2; --Index)
+	{
+		if (Data[Index] != 'r' || FMemory::Memcmp(Data + Index, "row>", 4) != 0)
+		{
+			continue;
+		}
+
+		// "</row>", or "</x:row>" if the writer used a namespace prefix
+		int32 Start = Index - 1;
+		if (Data[Start] == ':')
+		{
+			while (Start > 0 && Data[Start - 1] != '/' && Data[Start - 1] != '<' && Data[Start - 1] != '>')
+			{
+				--Start;
+			}
+		}
+		else
+		{
+			++Start;
+		}
+		if (Start >= 2 && Data[Start - 1] == '/' && Data[Start - 2] == '<')
+		{
+			return Index + 4;
+		}
+	}
+	return 0;
+}
+
+FPMXlsxImporterWorksheetReader::FPMXlsxImporterWorksheetReader(FPMXlsxImporterWorkbook& InWorkbook)
+	: Workbook(InWorkbook)
+{
+}
+
+FPMXlsxImporterWorksheetReader::~FPMXlsxImporterWorksheetReader()
+{
+}
+
+bool FPMXlsxImporterWorksheetReader::Open(const FString& InWorksheetName)
+{
+	WorksheetName = InWorksheetName;
+	const FPMXlsxImporterZipArchive& Archive = Workbook.Archive;
+
+	const int32 WorksheetIndex = Workbook.WorksheetNames.IndexOfByKey(WorksheetName);
+	if (WorksheetIndex == INDEX_NONE)
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s does not have a worksheet named %s"), *Archive.GetFilePath(), *WorksheetName);
+		return false;
+	}
+
+	if (!Workbook.ReadSharedStrings() || !Workbook.ReadStyles())
+	{
+		return false;
+	}
+
+	const FString& PartName = Workbook.WorksheetPartNames[WorksheetIndex];
+	const FPMXlsxImporterZipArchive::FEntry* Entry = Archive.FindEntry(PartName);
+	if (Entry == nullptr)
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s is missing %s"), *Archive.GetFilePath(), *PartName);
+		return false;
+	}
+
+	SharedStringRefs.SetNum(Workbook.SharedStrings.Num());
+	MaxConsecutiveBlankRows = GetDefault<UPMXlsxImporterSettings>()->MaxConsecutiveBlankRows;
+	return PartReader.Open(Archive, *Entry);
+}
+
+bool FPMXlsxImporterWorksheetReader::FillWindow()
+{
+	XmlReader.Reset();
+	Window.RemoveAt(0, NumWindowBytesParsed, /*bAllowShrinking:*/ false);
+	NumWindowBytesParsed = 0;
+
+	for (;;)
+	{
+		NumWindowBytesParsed = PartReader.IsAtEnd() ? Window.Num() : FindEndOfLastRow(Window.GetData(), Window.Num());
+		if (NumWindowBytesParsed > 0)
+		{
+			XmlReader = MakeUnique<FPMXlsxImporterXmlReader>(Window.GetData(), NumWindowBytesParsed);
+			return true;
+		}
+		if (PartReader.IsAtEnd())
+		{
+			return true;
+		}
+		if (!PartReader.Read(Window, WORKSHEET_WINDOW_SIZE))
+		{
+			return false;
+		}
+	}
+}
+
+bool FPMXlsxImporterWorksheetReader::ReadRows(int32 MaxRows, FPMXlsxImporterWorksheet& OutWorksheet)
+{
+	using EToken = FPMXlsxImporterXmlReader::EToken;
+	using FStringRef = FPMXlsxImporterWorksheet::FStringRef;
+	const FString& FilePath = Workbook.Archive.GetFilePath();
+
+	OutWorksheet.ResetRows();
+	++Batch;
+	const FStringRef BoolStringRefs[2] = { OutWorksheet.AddString(TEXT("False")), OutWorksheet.AddString(TEXT("True")) };
+	const auto AddUTF8String = [&OutWorksheet](const ANSICHAR* UTF8, int32 Len)
+	{
+		if (Len <= 0)
+		{
+			return FStringRef();
+		}
+		FUTF8ToTCHAR Converter(UTF8, Len);
+		return OutWorksheet.AddString(Converter.Get(), Converter.Length());
+	};
+
+	while (!bAtEnd)
+	{
+		if (!XmlReader.IsValid())
+		{
+			if (!FillWindow())
+			{
+				return false;
+			}
+			if (!XmlReader.IsValid())
+			{
+				bAtEnd = true;
+				break;
+			}
+		}
+
+		const EToken Token = XmlReader->Next();
+		const FPMXlsxImporterXmlSpan& Name = XmlReader->GetName();
+		switch (Token)
+		{
+		case EToken::End:
+			XmlReader.Reset();
+			break;
+
+		case EToken::Error:
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: malformed worksheet %s"), *FilePath, *WorksheetName);
+			return false;
+
+		case EToken::StartElement:
+			if (Name.Equals("row"))
+			{
+				NextColumn = 0;
+				FPMXlsxImporterXmlSpan RowReference;
+				const int32 ReferencedRowNumber = XmlReader->FindAttribute("r", RowReference) ? ParseIndex(RowReference) : INDEX_NONE;
+				RowNumber = ReferencedRowNumber != INDEX_NONE ? ReferencedRowNumber : RowNumber + 1;
+				// Rows are only added once they have a value, so blank rows never take up any memory
+				Row = INDEX_NONE;
+
+				// Rows missing from the part are blank too
+				const int32 NumBlankRows = RowNumber - LastNonBlankRowNumber - 1;
+				if (bReadHeaders && (RowNumber > LastDimensionRow || (MaxConsecutiveBlankRows > 0 && NumBlankRows >= MaxConsecutiveBlankRows)))
+				{
+					if (RowNumber <= LastDimensionRow)
+					{
+						UE_LOG(LogPMXlsxImporter, Log, TEXT("%s: stopped reading worksheet %s at row %i after %i blank rows. Raise Max Consecutive Blank Rows in XLSX Import settings if there is data after them."),
+							*FilePath, *WorksheetName, RowNumber, NumBlankRows
+						);
+					}
+					XmlReader.Reset();
+					bAtEnd = true;
+					return true;
+				}
+			}
+			else if (Name.Equals("dimension"))
+			{
+				// e.g. "A1:F200". Some writers only write "A1", which doesn't say where the worksheet ends.
+				FPMXlsxImporterXmlSpan Reference;
+				if (XmlReader->FindAttribute("ref", Reference))
+				{
+					for (int32 Index = 0; Index < Reference.Len; ++Index)
+					{
+						if (Reference.Data[Index] == ':')
+						{
+							const int32 DimensionRow = ParseRowNumber(FPMXlsxImporterXmlSpan{ Reference.Data + Index + 1, Reference.Len - Index - 1 });
+							LastDimensionRow = DimensionRow != INDEX_NONE ? DimensionRow : MAX_int32;
+							break;
+						}
+					}
+				}
+			}
+			else if (Name.Equals("c"))
+			{
+				bInCell = true;
+				CellBuffer.Reset();
+				CellType = FPMXlsxImporterXmlSpan();
+				XmlReader->FindAttribute("t", CellType);
+
+				FPMXlsxImporterXmlSpan CellStyleSpan;
+				CellStyle = XmlReader->FindAttribute("s", CellStyleSpan) ? ParseIndex(CellStyleSpan) : 0;
+
+				FPMXlsxImporterXmlSpan CellReference;
+				CellColumn = XmlReader->FindAttribute("r", CellReference) ? ParseColumnIndex(CellReference) : INDEX_NONE;
+				if (CellColumn == INDEX_NONE)
+				{
+					CellColumn = NextColumn;
+				}
+				NextColumn = CellColumn + 1;
+			}
+			else if (bInCell && Name.Equals("v"))
+			{
+				bInValue = true;
+			}
+			else if (bInCell && Name.Equals("is"))
+			{
+				bInInlineString = true;
+			}
+			else if (bInInlineString && Name.Equals("rPh"))
+			{
+				++PhoneticDepth;
+			}
+			else if (bInInlineString && Name.Equals("t"))
+			{
+				bInInlineText = PhoneticDepth == 0;
+			}
+			break;
+
+		case EToken::Text:
+			if (bInValue || bInInlineText)
+			{
+				AppendText(*XmlReader, CellBuffer);
+			}
+			break;
+
+		case EToken::EndElement:
+			if (Name.Equals("v"))
+			{
+				bInValue = false;
+			}
+			else if (Name.Equals("t"))
+			{
+				bInInlineText = false;
+			}
+			else if (Name.Equals("rPh"))
+			{
+				--PhoneticDepth;
+			}
+			else if (Name.Equals("is"))
+			{
+				bInInlineString = false;
+			}
+			else if (Name.Equals("c"))
+			{
+				bInCell = false;
+
+				// Headers can be anywhere in the first row. Every other row only cares about columns with headers.
+				if (bReadHeaders && CellColumn >= OutWorksheet.GetNumColumns())
+				{
+					break;
+				}
+
+				FStringRef Value;
+				FPMXlsxImporterPythonBridgeCell Cell;
+
+				// Match the strings that str(cell.value) produces in the Python implementation where it's sensible to
+				if (CellType.Equals("s"))
+				{
+					Cell.Type = EPMXlsxImporterCellType::String;
+					const int32 SharedStringIndex = ParseIndex(FPMXlsxImporterXmlSpan{ CellBuffer.GetData(), CellBuffer.Num() });
+					if (Workbook.SharedStrings.IsValidIndex(SharedStringIndex))
+					{
+						FSharedStringRef& SharedStringRef = SharedStringRefs[SharedStringIndex];
+						if (SharedStringRef.Batch != Batch)
+						{
+							SharedStringRef.Ref = OutWorksheet.AddString(Workbook.SharedStrings[SharedStringIndex]);
+							SharedStringRef.Batch = Batch;
+						}
+						Value = SharedStringRef.Ref;
+					}
+					else
+					{
+						UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: worksheet %s has an invalid shared string index %i"), *FilePath, *WorksheetName, SharedStringIndex);
+					}
+				}
+				else if (CellType.Equals("b"))
+				{
+					const bool bValue = CellBuffer.Num() == 1 && CellBuffer[0] == '1';
+					Cell.Type = EPMXlsxImporterCellType::Bool;
+					Cell.Number = bValue ? 1.0 : 0.0;
+					Value = BoolStringRefs[bValue];
+				}
+				else if (CellType.Equals("inlineStr") || CellType.Equals("str"))
+				{
+					UnescapeOoxmlString(CellBuffer);
+					Cell.Type = EPMXlsxImporterCellType::String;
+					Value = AddUTF8String(CellBuffer.GetData(), CellBuffer.Num());
+				}
+				else if (CellType.Equals("e"))
+				{
+					Cell.Type = EPMXlsxImporterCellType::Error;
+					Value = AddUTF8String(CellBuffer.GetData(), CellBuffer.Num());
+				}
+				else if (CellType.Equals("d"))
+				{
+					// ISO8601 dates, which only some applications write
+					const FString DateString = FPMXlsxImporterXmlReader::ToString(CellBuffer.GetData(), CellBuffer.Num());
+					Cell.Type = FDateTime::ParseIso8601(*DateString, Cell.DateTime) ? EPMXlsxImporterCellType::DateTime : EPMXlsxImporterCellType::String;
+					Value = OutWorksheet.AddString(DateString);
+				}
+				else if (CellBuffer.Num() > 0)
+				{
+					CellBuffer.Add('\0');
+					Cell.Type = EPMXlsxImporterCellType::Number;
+					Cell.Number = FCStringAnsi::Atod(CellBuffer.GetData());
+					// FDateTime can't represent dates before year 1 or after year 9999
+					if (Workbook.IsDateStyle(CellStyle) && Cell.Number >= 0.0 && Cell.Number < 2958466.0)
+					{
+						Cell.Type = EPMXlsxImporterCellType::DateTime;
+						Cell.DateTime = Workbook.SerialToDateTime(Cell.Number);
+						Value = OutWorksheet.AddString(Cell.DateTime.ToIso8601());
+					}
+					else
+					{
+						Value = AddUTF8String(CellBuffer.GetData(), CellBuffer.Num() - 1);
+					}
+				}
+
+				if (!bReadHeaders)
+				{
+					if (CellColumn >= Headers.Num())
+					{
+						Headers.SetNum(CellColumn + 1);
+					}
+					Headers[CellColumn] = FString(OutWorksheet.GetString(Value));
+				}
+				else if (Value.Len > 0)
+				{
+					if (Row == INDEX_NONE)
+					{
+						Row = OutWorksheet.AddRow();
+						LastNonBlankRowNumber = RowNumber;
+					}
+					OutWorksheet.SetCell(Row, CellColumn, Value, Cell);
+				}
+			}
+			else if (Name.Equals("row"))
+			{
+				if (!bReadHeaders)
+				{
+					bReadHeaders = true;
+					if (!Headers.Contains(NAME_HEADER))
+					{
+						UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: worksheet %s does not have a \"%s\" column"), *FilePath, *WorksheetName, NAME_HEADER);
+						return false;
+					}
+					OutWorksheet.SetHeaders(MoveTemp(Headers));
+					LastNonBlankRowNumber = RowNumber;
+				}
+				else if (OutWorksheet.GetNumRows() >= MaxRows)
+				{
+					return true;
+				}
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
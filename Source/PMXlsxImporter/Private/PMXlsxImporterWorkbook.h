@@ -0,0 +1,135 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXlsxImporterZipArchive.h"
+#include "PMXlsxImporterXmlReader.h"
+#include "PMXlsxImporterWorksheet.h"
+#include "PMXlsxImporterImportState.h"
+
+// Native reader for XLSX workbooks. Opening a workbook only indexes the zip file and reads xl/workbook.xml.
+// Shared strings, styles and worksheets are inflated and parsed on demand, one SAX-style pass each.
+// All errors are logged to LogPMXlsxImporter.
+class FPMXlsxImporterWorkbook
+{
+public:
+	bool Open(const FString& AbsoluteFilePath);
+
+	const TArray<FString>& GetWorksheetNames() const
+	{
+		return WorksheetNames;
+	}
+
+	// Reads the worksheet named OutWorksheet.GetName() into OutWorksheet, which must be empty.
+	// Cells with a date number format become DateTime cells, and their string value is an ISO8601 date.
+	// See FPMXlsxImporterWorksheetReader to read a worksheet a batch of rows at a time instead.
+	bool ReadWorksheet(FPMXlsxImporterWorksheet& OutWorksheet);
+
+	// Fills in OutFingerprint from the zip central directory without inflating the worksheet or shared strings
+	bool GetWorksheetFingerprint(const FString& WorksheetName, FPMXlsxImporterWorksheetFingerprint& OutFingerprint) const;
+
+private:
+	friend class FPMXlsxImporterWorksheetReader;
+
+	bool ReadWorkbookPart();
+	bool ReadSharedStrings();
+	// Finds which cell formats display dates
+	bool ReadStyles();
+	bool IsDateStyle(int32 StyleIndex) const;
+	FDateTime SerialToDateTime(double Serial) const;
+	bool ExtractPart(const FString& PartName, TArray<uint8>& OutData) const;
+
+	FPMXlsxImporterZipArchive Archive;
+
+	TArray<FString> WorksheetNames;
+	// Zip entry names, e.g. "xl/worksheets/sheet1.xml". Parallel to WorksheetNames.
+	TArray<FString> WorksheetPartNames;
+
+	FString SharedStringsPartName;
+	TArray<FString> SharedStrings;
+	bool bSharedStringsRead = false;
+
+	FString StylesPartName;
+	// Indexed by a cell's "s" attribute
+	TBitArray<> DateStyles;
+	bool bStylesRead = false;
+
+	// Serial dates count days from 1904-01-01 instead of 1899-12-30, which old versions of Excel for Mac did
+	bool bDate1904 = false;
+};
+
+// Reads one worksheet of an FPMXlsxImporterWorkbook a batch of rows at a time. The worksheet part is inflated and
+// parsed a window at a time, so memory use depends on the batch size rather than the size of the worksheet.
+class FPMXlsxImporterWorksheetReader
+{
+public:
+	// Workbook must outlive this reader
+	explicit FPMXlsxImporterWorksheetReader(FPMXlsxImporterWorkbook& InWorkbook);
+	~FPMXlsxImporterWorksheetReader();
+
+	bool Open(const FString& InWorksheetName);
+
+	// Replaces the rows in OutWorksheet with up to MaxRows more rows. Pass the same worksheet every time: its headers
+	// are set from the first row of the file by the first call. Returns false if the worksheet is malformed.
+	// Rows without any values are skipped. Reading stops at the end of the worksheet's <dimension>, or after
+	// UPMXlsxImporterSettings::MaxConsecutiveBlankRows blank rows in a row.
+	bool ReadRows(int32 MaxRows, FPMXlsxImporterWorksheet& OutWorksheet);
+
+	// Whether every row has been read
+	bool IsAtEnd() const
+	{
+		return bAtEnd;
+	}
+
+private:
+	// Drops what has been parsed from Window and inflates until it holds at least one more complete row, then
+	// starts parsing it. XmlReader is left null once there is nothing left to parse.
+	bool FillWindow();
+
+	FPMXlsxImporterWorkbook& Workbook;
+	FString WorksheetName;
+	FPMXlsxImporterZipArchive::FEntryReader PartReader;
+
+	// Inflated bytes of the worksheet part. XmlReader parses the first NumWindowBytesParsed of them, which always
+	// end with a complete row.
+	TArray<uint8> Window;
+	int32 NumWindowBytesParsed = 0;
+	TUniquePtr<FPMXlsxImporterXmlReader> XmlReader;
+	bool bAtEnd = false;
+
+	// Each shared string is copied into the worksheet the first time a cell in the batch uses it, and every other
+	// cell in the batch using it points at the same copy. Batch tells which batch each copy belongs to.
+	struct FSharedStringRef
+	{
+		FPMXlsxImporterWorksheet::FStringRef Ref;
+		int32 Batch = INDEX_NONE;
+	};
+	TArray<FSharedStringRef> SharedStringRefs;
+	int32 Batch = 0;
+
+	TArray<FString> Headers;
+	bool bReadHeaders = false;
+	// Index of the current row in the worksheet being read into, or INDEX_NONE until the row has a value
+	int32 Row = INDEX_NONE;
+
+	// One-based number of the current row in the part, and of the last row that had any values
+	int32 RowNumber = 0;
+	int32 LastNonBlankRowNumber = 0;
+	// From the <dimension> element. Rows after it aren't read, same as openpyxl.
+	int32 LastDimensionRow = MAX_int32;
+	// See UPMXlsxImporterSettings::MaxConsecutiveBlankRows
+	int32 MaxConsecutiveBlankRows = 0;
+
+	// State of the cell being read. Windows always end between rows, so this never carries over from one to the next.
+	TArray<ANSICHAR> CellBuffer;
+	int32 NextColumn = 0;
+	int32 CellColumn = INDEX_NONE;
+	int32 CellStyle = 0;
+	FPMXlsxImporterXmlSpan CellType;
+	bool bInCell = false;
+	bool bInValue = false;
+	bool bInInlineString = false;
+	bool bInInlineText = false;
+	int32 PhoneticDepth = 0;
+};
@@ -0,0 +1,205 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterWorksheet.h"
+#include "Hash/CityHash.h"
+
+static const TCHAR* const NAME_HEADER = TEXT("Name");
+
+FPMXlsxImporterWorksheet::FPMXlsxImporterWorksheet(const FString& InName)
+	: Name(InName)
+{
+}
+
+TSharedRef<FPMXlsxImporterWorksheet> FPMXlsxImporterWorksheet::FromRows(const FString& Name, const TArray<FPMXlsxImporterPythonBridgeDataAssetInfo>& Rows)
+{
+	TSharedRef<FPMXlsxImporterWorksheet> Worksheet = MakeShared<FPMXlsxImporterWorksheet>(Name);
+
+	TArray<FString> Headers;
+	TMap<FString, int32> Columns;
+	for (const FPMXlsxImporterPythonBridgeDataAssetInfo& Row : Rows)
+	{
+		for (const TPair<FString, FString>& Value : Row.Data)
+		{
+			if (!Columns.Contains(Value.Key))
+			{
+				Columns.Add(Value.Key, Headers.Add(Value.Key));
+			}
+		}
+	}
+	Worksheet->SetHeaders(MoveTemp(Headers));
+
+	for (const FPMXlsxImporterPythonBridgeDataAssetInfo& Row : Rows)
+	{
+		const int32 RowIndex = Worksheet->AddRow();
+		for (const TPair<FString, FString>& Value : Row.Data)
+		{
+			// Readers that don't know a cell's type leave it out of Cells
+			const FPMXlsxImporterPythonBridgeCell* TypedCell = Row.Cells.Find(Value.Key);
+			FPMXlsxImporterPythonBridgeCell StringCell;
+			StringCell.Type = Value.Value.IsEmpty() ? EPMXlsxImporterCellType::Empty : EPMXlsxImporterCellType::String;
+			Worksheet->SetCell(RowIndex, Columns[Value.Key], Worksheet->AddString(Value.Value), TypedCell ? *TypedCell : StringCell);
+		}
+	}
+
+	Worksheet->Shrink();
+	return Worksheet;
+}
+
+void FPMXlsxImporterWorksheet::ToRows(TArray<FPMXlsxImporterPythonBridgeDataAssetInfo>& OutRows) const
+{
+	OutRows.Reset(NumRows);
+	for (int32 Row = 0; Row < NumRows; ++Row)
+	{
+		FPMXlsxImporterPythonBridgeDataAssetInfo& Info = OutRows.AddDefaulted_GetRef();
+		Info.AssetName = GetAssetName(Row);
+		MakeValueMap(Row, Info.Data);
+		Info.Cells.Reserve(Columns.Num());
+		for (const TPair<FString, int32>& Column : Columns)
+		{
+			Info.Cells.Add(Column.Key, GetCell(Row, Column.Value));
+		}
+	}
+}
+
+void FPMXlsxImporterWorksheet::SetHeaders(TArray<FString>&& InHeaders)
+{
+	check(NumRows == 0);
+	Headers = MoveTemp(InHeaders);
+	Columns.Reset();
+	Columns.Reserve(Headers.Num());
+	for (int32 Column = 0; Column < Headers.Num(); ++Column)
+	{
+		// Same as adding to a TMap in column order: the last column with a duplicate header wins
+		if (!Headers[Column].IsEmpty())
+		{
+			Columns.Add(Headers[Column], Column);
+		}
+	}
+	const int32* NameColumnPtr = Columns.Find(NAME_HEADER);
+	NameColumn = NameColumnPtr ? *NameColumnPtr : INDEX_NONE;
+}
+
+int32 FPMXlsxImporterWorksheet::AddRow()
+{
+	Cells.AddDefaulted(Headers.Num());
+	return NumRows++;
+}
+
+FPMXlsxImporterWorksheet::FStringRef FPMXlsxImporterWorksheet::AddString(const TCHAR* Chars, int32 Len)
+{
+	FStringRef Ref;
+	Ref.Offset = Strings.Num();
+	Ref.Len = Len;
+	Strings.Append(Chars, Len);
+	return Ref;
+}
+
+void FPMXlsxImporterWorksheet::SetCell(int32 Row, int32 Column, FStringRef String, const FPMXlsxImporterPythonBridgeCell& Cell)
+{
+	checkSlow(Column < Headers.Num());
+	FCell& StoredCell = Cells[Row * Headers.Num() + Column];
+	StoredCell.StringOffset = String.Offset;
+	StoredCell.StringLen = String.Len;
+	StoredCell.Type = Cell.Type;
+	if (Cell.Type == EPMXlsxImporterCellType::DateTime)
+	{
+		StoredCell.Ticks = Cell.DateTime.GetTicks();
+	}
+	else
+	{
+		StoredCell.Number = Cell.Number;
+	}
+}
+
+void FPMXlsxImporterWorksheet::Shrink()
+{
+	Cells.Shrink();
+	Strings.Shrink();
+}
+
+void FPMXlsxImporterWorksheet::ResetRows()
+{
+	NumRows = 0;
+	Cells.Reset();
+	Strings.Reset();
+}
+
+int32 FPMXlsxImporterWorksheet::FindColumnByHash(uint32 HeaderHash, const FString& Header) const
+{
+	const int32* Column = Columns.FindByHash(HeaderHash, Header);
+	return Column ? *Column : INDEX_NONE;
+}
+
+void FPMXlsxImporterWorksheet::CopyValue(int32 Row, int32 Column, FString& OutValue) const
+{
+	const FStringView Value = GetValue(Row, Column);
+	OutValue.Reset(Value.Len());
+	OutValue.AppendChars(Value.GetData(), Value.Len());
+}
+
+FPMXlsxImporterPythonBridgeCell FPMXlsxImporterWorksheet::GetCell(int32 Row, int32 Column) const
+{
+	const FCell& StoredCell = Cells[Row * Headers.Num() + Column];
+	FPMXlsxImporterPythonBridgeCell Cell;
+	Cell.Type = StoredCell.Type;
+	if (StoredCell.Type == EPMXlsxImporterCellType::DateTime)
+	{
+		Cell.DateTime = FDateTime(StoredCell.Ticks);
+	}
+	else
+	{
+		Cell.Number = StoredCell.Number;
+	}
+	return Cell;
+}
+
+FString FPMXlsxImporterWorksheet::GetAssetName(int32 Row) const
+{
+	return NameColumn == INDEX_NONE ? FString() : FString(GetValue(Row, NameColumn));
+}
+
+void FPMXlsxImporterWorksheet::MakeValueMap(int32 Row, TMap<FString, FString>& OutValues) const
+{
+	OutValues.Reset();
+	OutValues.Reserve(Columns.Num());
+	for (int32 Column = 0; Column < Headers.Num(); ++Column)
+	{
+		if (!Headers[Column].IsEmpty())
+		{
+			OutValues.Add(Headers[Column], FString(GetValue(Row, Column)));
+		}
+	}
+}
+
+uint64 FPMXlsxImporterWorksheet::HashRow(int32 Row) const
+{
+	// Hashing each string's length as well keeps ("ab", "c") and ("a", "bc") apart
+	uint64 Hash = 0;
+	const auto HashString = [&Hash](const TCHAR* Chars, int32 Len)
+	{
+		const uint64 Len64 = Len;
+		Hash = CityHash64WithSeed((const char*)&Len64, sizeof(Len64), Hash);
+		Hash = CityHash64WithSeed((const char*)Chars, Len * sizeof(TCHAR), Hash);
+	};
+
+	for (int32 Column = 0; Column < Headers.Num(); ++Column)
+	{
+		if (!Headers[Column].IsEmpty())
+		{
+			const FStringView Value = GetValue(Row, Column);
+			HashString(*Headers[Column], Headers[Column].Len());
+			HashString(Value.GetData(), Value.Len());
+		}
+	}
+	return Hash;
+}
+
+SIZE_T FPMXlsxImporterWorksheet::GetAllocatedSize() const
+{
+	SIZE_T Size = Headers.GetAllocatedSize() + Columns.GetAllocatedSize() + Cells.GetAllocatedSize() + Strings.GetAllocatedSize();
+	for (const FString& Header : Headers)
+	{
+		Size += Header.GetAllocatedSize();
+	}
+	return Size;
+}
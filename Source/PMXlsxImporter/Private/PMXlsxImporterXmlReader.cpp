@@ -0,0 +1,373 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterXmlReader.h"
+
+static bool IsXmlWhitespace(ANSICHAR Char)
+{
+	return Char == ' ' || Char == '\t' || Char == '\r' || Char == '\n';
+}
+
+static FPMXlsxImporterXmlSpan MakeLocalName(const ANSICHAR* Start, int32 Len)
+{
+	// Strip namespace prefixes, e.g. "x:row" -> "row". Some generators write prefixed SpreadsheetML.
+	for (int32 Index = Len - 1; Index >= 0; --Index)
+	{
+		if (Start[Index] == ':')
+		{
+			return FPMXlsxImporterXmlSpan{ Start + Index + 1, Len - Index - 1 };
+		}
+	}
+	return FPMXlsxImporterXmlSpan{ Start, Len };
+}
+
+static void AppendCodepointAsUTF8(uint32 Codepoint, TArray<ANSICHAR>& OutUTF8)
+{
+	if (Codepoint < 0x80)
+	{
+		OutUTF8.Add((ANSICHAR)Codepoint);
+	}
+	else if (Codepoint < 0x800)
+	{
+		OutUTF8.Add((ANSICHAR)(0xC0 | (Codepoint >> 6)));
+		OutUTF8.Add((ANSICHAR)(0x80 | (Codepoint & 0x3F)));
+	}
+	else if (Codepoint < 0x10000)
+	{
+		OutUTF8.Add((ANSICHAR)(0xE0 | (Codepoint >> 12)));
+		OutUTF8.Add((ANSICHAR)(0x80 | ((Codepoint >> 6) & 0x3F)));
+		OutUTF8.Add((ANSICHAR)(0x80 | (Codepoint & 0x3F)));
+	}
+	else
+	{
+		OutUTF8.Add((ANSICHAR)(0xF0 | (Codepoint >> 18)));
+		OutUTF8.Add((ANSICHAR)(0x80 | ((Codepoint >> 12) & 0x3F)));
+		OutUTF8.Add((ANSICHAR)(0x80 | ((Codepoint >> 6) & 0x3F)));
+		OutUTF8.Add((ANSICHAR)(0x80 | (Codepoint & 0x3F)));
+	}
+}
+
+bool FPMXlsxImporterXmlSpan::Equals(const ANSICHAR* Literal) const
+{
+	const int32 LiteralLen = FCStringAnsi::Strlen(Literal);
+	return Len == LiteralLen && FMemory::Memcmp(Data, Literal, Len) == 0;
+}
+
+FPMXlsxImporterXmlReader::FPMXlsxImporterXmlReader(const uint8* InData, int32 InNum)
+	: Data((const ANSICHAR*)InData)
+	, Num(InNum)
+	, Pos(0)
+	, bIsCData(false)
+	, bPendingEnd(false)
+{
+	// Skip the UTF-8 byte order mark if there is one
+	if (Num >= 3 && (uint8)Data[0] == 0xEF && (uint8)Data[1] == 0xBB && (uint8)Data[2] == 0xBF)
+	{
+		Pos = 3;
+	}
+}
+
+FPMXlsxImporterXmlReader::EToken FPMXlsxImporterXmlReader::Next()
+{
+	if (bPendingEnd)
+	{
+		// Second half of a self-closing element. Name is unchanged.
+		bPendingEnd = false;
+		Attributes = FPMXlsxImporterXmlSpan();
+		return EToken::EndElement;
+	}
+
+	while (Pos < Num)
+	{
+		if (Data[Pos] != '<')
+		{
+			const int32 Start = Pos;
+			while (Pos < Num && Data[Pos] != '<')
+			{
+				++Pos;
+			}
+			Text = FPMXlsxImporterXmlSpan{ Data + Start, Pos - Start };
+			bIsCData = false;
+			return EToken::Text;
+		}
+
+		const int32 Remaining = Num - Pos;
+		const ANSICHAR* Tag = Data + Pos;
+
+		if (Remaining >= 2 && Tag[1] == '?')
+		{
+			if (!SkipPast("?>"))
+			{
+				return EToken::Error;
+			}
+			continue;
+		}
+
+		if (Remaining >= 4 && FMemory::Memcmp(Tag, "<!--", 4) == 0)
+		{
+			if (!SkipPast("-->"))
+			{
+				return EToken::Error;
+			}
+			continue;
+		}
+
+		if (Remaining >= 9 && FMemory::Memcmp(Tag, "<![CDATA[", 9) == 0)
+		{
+			const int32 Start = Pos + 9;
+			Pos = Start;
+			if (!SkipPast("]]>"))
+			{
+				return EToken::Error;
+			}
+			Text = FPMXlsxImporterXmlSpan{ Data + Start, Pos - 3 - Start };
+			bIsCData = true;
+			return EToken::Text;
+		}
+
+		if (Remaining >= 2 && Tag[1] == '!')
+		{
+			// <!DOCTYPE ...>. XLSX parts don't have internal subsets, so the first '>' ends it.
+			if (!SkipPast(">"))
+			{
+				return EToken::Error;
+			}
+			continue;
+		}
+
+		if (Remaining >= 2 && Tag[1] == '/')
+		{
+			const int32 NameStart = Pos + 2;
+			const int32 NameEnd = ScanName(NameStart);
+			Name = MakeLocalName(Data + NameStart, NameEnd - NameStart);
+			Attributes = FPMXlsxImporterXmlSpan();
+			Pos = NameEnd;
+			if (!SkipPast(">"))
+			{
+				return EToken::Error;
+			}
+			return EToken::EndElement;
+		}
+
+		const int32 NameStart = Pos + 1;
+		const int32 NameEnd = ScanName(NameStart);
+		if (NameEnd == NameStart)
+		{
+			return EToken::Error;
+		}
+
+		// Find the closing '>', ignoring any inside quoted attribute values
+		int32 Index = NameEnd;
+		ANSICHAR Quote = 0;
+		for (; Index < Num; ++Index)
+		{
+			const ANSICHAR Char = Data[Index];
+			if (Quote != 0)
+			{
+				if (Char == Quote)
+				{
+					Quote = 0;
+				}
+			}
+			else if (Char == '"' || Char == '\'')
+			{
+				Quote = Char;
+			}
+			else if (Char == '>')
+			{
+				break;
+			}
+		}
+
+		if (Index >= Num)
+		{
+			return EToken::Error;
+		}
+
+		const bool bSelfClosing = Data[Index - 1] == '/';
+		Name = MakeLocalName(Data + NameStart, NameEnd - NameStart);
+		Attributes = FPMXlsxImporterXmlSpan{ Data + NameEnd, (bSelfClosing ? Index - 1 : Index) - NameEnd };
+		bPendingEnd = bSelfClosing;
+		Pos = Index + 1;
+		return EToken::StartElement;
+	}
+
+	return EToken::End;
+}
+
+bool FPMXlsxImporterXmlReader::SkipPast(const ANSICHAR* Terminator)
+{
+	const int32 TerminatorLen = FCStringAnsi::Strlen(Terminator);
+	for (int32 Index = Pos; Index + TerminatorLen <= Num; ++Index)
+	{
+		if (Data[Index] == Terminator[0] && FMemory::Memcmp(Data + Index, Terminator, TerminatorLen) == 0)
+		{
+			Pos = Index + TerminatorLen;
+			return true;
+		}
+	}
+	Pos = Num;
+	return false;
+}
+
+int32 FPMXlsxImporterXmlReader::ScanName(int32 Start) const
+{
+	int32 Index = Start;
+	while (Index < Num && !IsXmlWhitespace(Data[Index]) && Data[Index] != '>' && Data[Index] != '/' && Data[Index] != '=')
+	{
+		++Index;
+	}
+	return Index;
+}
+
+bool FPMXlsxImporterXmlReader::FindAttribute(const ANSICHAR* AttributeName, FPMXlsxImporterXmlSpan& OutValue) const
+{
+	const ANSICHAR* Cursor = Attributes.Data;
+	const ANSICHAR* End = Attributes.Data + Attributes.Len;
+
+	while (Cursor < End)
+	{
+		while (Cursor < End && IsXmlWhitespace(*Cursor))
+		{
+			++Cursor;
+		}
+
+		const ANSICHAR* NameStart = Cursor;
+		while (Cursor < End && *Cursor != '=' && !IsXmlWhitespace(*Cursor))
+		{
+			++Cursor;
+		}
+		const FPMXlsxImporterXmlSpan AttributeLocalName = MakeLocalName(NameStart, (int32)(Cursor - NameStart));
+
+		while (Cursor < End && (IsXmlWhitespace(*Cursor) || *Cursor == '='))
+		{
+			++Cursor;
+		}
+		if (Cursor >= End || (*Cursor != '"' && *Cursor != '\''))
+		{
+			return false; // Malformed
+		}
+
+		const ANSICHAR Quote = *Cursor++;
+		const ANSICHAR* ValueStart = Cursor;
+		while (Cursor < End && *Cursor != Quote)
+		{
+			++Cursor;
+		}
+
+		if (AttributeLocalName.Equals(AttributeName))
+		{
+			OutValue = FPMXlsxImporterXmlSpan{ ValueStart, (int32)(Cursor - ValueStart) };
+			return true;
+		}
+
+		++Cursor; // Closing quote
+	}
+
+	return false;
+}
+
+bool FPMXlsxImporterXmlReader::FindAttribute(const ANSICHAR* AttributeName, FString& OutValue) const
+{
+	FPMXlsxImporterXmlSpan RawValue;
+	if (!FindAttribute(AttributeName, RawValue))
+	{
+		return false;
+	}
+
+	TArray<ANSICHAR> Decoded;
+	AppendDecoded(RawValue, Decoded);
+	OutValue = ToString(Decoded.GetData(), Decoded.Num());
+	return true;
+}
+
+void FPMXlsxImporterXmlReader::AppendDecoded(const FPMXlsxImporterXmlSpan& Raw, TArray<ANSICHAR>& OutUTF8)
+{
+	const ANSICHAR* Cursor = Raw.Data;
+	const ANSICHAR* End = Raw.Data + Raw.Len;
+
+	while (Cursor < End)
+	{
+		// Copy everything up to the next entity in one go
+		const ANSICHAR* Ampersand = Cursor;
+		while (Ampersand < End && *Ampersand != '&')
+		{
+			++Ampersand;
+		}
+		OutUTF8.Append(Cursor, (int32)(Ampersand - Cursor));
+		Cursor = Ampersand;
+		if (Cursor >= End)
+		{
+			break;
+		}
+
+		const ANSICHAR* Semicolon = Cursor + 1;
+		while (Semicolon < End && *Semicolon != ';' && Semicolon - Cursor < 12)
+		{
+			++Semicolon;
+		}
+		if (Semicolon >= End || *Semicolon != ';')
+		{
+			// Not a well formed entity. Keep the ampersand so no data is lost.
+			OutUTF8.Add('&');
+			++Cursor;
+			continue;
+		}
+
+		const FPMXlsxImporterXmlSpan Entity{ Cursor + 1, (int32)(Semicolon - Cursor - 1) };
+		if (Entity.Equals("lt"))
+		{
+			OutUTF8.Add('<');
+		}
+		else if (Entity.Equals("gt"))
+		{
+			OutUTF8.Add('>');
+		}
+		else if (Entity.Equals("amp"))
+		{
+			OutUTF8.Add('&');
+		}
+		else if (Entity.Equals("quot"))
+		{
+			OutUTF8.Add('"');
+		}
+		else if (Entity.Equals("apos"))
+		{
+			OutUTF8.Add('\'');
+		}
+		else if (Entity.Len > 1 && Entity.Data[0] == '#')
+		{
+			const bool bHex = Entity.Data[1] == 'x' || Entity.Data[1] == 'X';
+			uint32 Codepoint = 0;
+			for (int32 Index = bHex ? 2 : 1; Index < Entity.Len; ++Index)
+			{
+				const ANSICHAR Char = Entity.Data[Index];
+				if (bHex)
+				{
+					Codepoint = Codepoint * 16 + (FCharAnsi::IsDigit(Char) ? Char - '0' : (FCharAnsi::ToLower(Char) - 'a' + 10));
+				}
+				else
+				{
+					Codepoint = Codepoint * 10 + (Char - '0');
+				}
+			}
+			AppendCodepointAsUTF8(FMath::Min<uint32>(Codepoint, 0x10FFFF), OutUTF8);
+		}
+		else
+		{
+			OutUTF8.Append(Cursor, (int32)(Semicolon - Cursor + 1));
+		}
+
+		Cursor = Semicolon + 1;
+	}
+}
+
+FString FPMXlsxImporterXmlReader::ToString(const ANSICHAR* UTF8, int32 Len)
+{
+	if (Len <= 0)
+	{
+		return FString();
+	}
+
+	FUTF8ToTCHAR Converter(UTF8, Len);
+	return FString(Converter.Length(), Converter.Get());
+}
@@ -0,0 +1,85 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Non-owning view of UTF-8 bytes inside the buffer being read by FPMXlsxImporterXmlReader
+struct FPMXlsxImporterXmlSpan
+{
+	const ANSICHAR* Data = nullptr;
+	int32 Len = 0;
+
+	bool IsEmpty() const
+	{
+		return Len == 0;
+	}
+
+	// Case sensitive, because XML is
+	bool Equals(const ANSICHAR* Literal) const;
+};
+
+// Forward-only, non-validating XML pull parser over a UTF-8 buffer.
+// This only understands as much XML as the parts of an XLSX file use: elements, attributes, text, CDATA,
+// comments and processing instructions. Nothing is allocated while reading; text and attribute values are
+// returned as spans into the buffer and only decoded when the caller asks for them.
+class FPMXlsxImporterXmlReader
+{
+public:
+	enum class EToken : uint8
+	{
+		StartElement,
+		EndElement, // Also emitted immediately after StartElement for self-closing elements like <c r="A1"/>
+		Text,
+		End,
+		Error,
+	};
+
+	FPMXlsxImporterXmlReader(const uint8* InData, int32 InNum);
+
+	EToken Next();
+
+	// Local name of the current element, with any namespace prefix removed. Valid after StartElement or EndElement.
+	const FPMXlsxImporterXmlSpan& GetName() const
+	{
+		return Name;
+	}
+
+	// Finds an attribute on the current start element by local name and returns its raw (undecoded) value
+	bool FindAttribute(const ANSICHAR* AttributeName, FPMXlsxImporterXmlSpan& OutValue) const;
+
+	// Convenience wrapper around FindAttribute that decodes the value
+	bool FindAttribute(const ANSICHAR* AttributeName, FString& OutValue) const;
+
+	// Raw text of the current Text token. Entities are not decoded unless IsCData() is true, in which case
+	// there is nothing to decode.
+	const FPMXlsxImporterXmlSpan& GetText() const
+	{
+		return Text;
+	}
+
+	bool IsCData() const
+	{
+		return bIsCData;
+	}
+
+	// Appends Raw to OutUTF8 after replacing XML entities (&amp; &#65; etc.)
+	static void AppendDecoded(const FPMXlsxImporterXmlSpan& Raw, TArray<ANSICHAR>& OutUTF8);
+
+	// Converts UTF-8 bytes to an FString
+	static FString ToString(const ANSICHAR* UTF8, int32 Len);
+
+private:
+	bool SkipPast(const ANSICHAR* Terminator);
+	int32 ScanName(int32 Start) const;
+
+	const ANSICHAR* Data;
+	int32 Num;
+	int32 Pos;
+
+	FPMXlsxImporterXmlSpan Name;
+	FPMXlsxImporterXmlSpan Attributes;
+	FPMXlsxImporterXmlSpan Text;
+	bool bIsCData;
+	bool bPendingEnd;
+};
@@ -0,0 +1,402 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterZipArchive.h"
+#include "PMXlsxImporterLog.h"
+#include "HAL/PlatformFilemanager.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+// See https://pkware.cachefly.net/webdocs/casestudies/APPNOTE.TXT
+static const uint32 END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+static const uint32 CENTRAL_DIRECTORY_HEADER_SIGNATURE = 0x02014b50;
+static const uint32 LOCAL_FILE_HEADER_SIGNATURE = 0x04034b50;
+
+static const int32 END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+static const int32 CENTRAL_DIRECTORY_HEADER_SIZE = 46;
+static const int32 LOCAL_FILE_HEADER_SIZE = 30;
+static const int32 MAX_ZIP_COMMENT_SIZE = 0xFFFF;
+
+// FEntryReader reads compressed data from the file this many bytes at a time
+static const int32 COMPRESSED_CHUNK_SIZE = 256 * 1024;
+
+static const uint16 COMPRESSION_METHOD_STORED = 0;
+static const uint16 COMPRESSION_METHOD_DEFLATED = 8;
+static const uint16 FLAG_ENCRYPTED = 0x1;
+
+static uint16 ReadUInt16(const uint8* Data)
+{
+	return (uint16)Data[0] | ((uint16)Data[1] << 8);
+}
+
+static uint32 ReadUInt32(const uint8* Data)
+{
+	return (uint32)Data[0] | ((uint32)Data[1] << 8) | ((uint32)Data[2] << 16) | ((uint32)Data[3] << 24);
+}
+
+bool FPMXlsxImporterZipArchive::Open(const FString& AbsoluteFilePath)
+{
+	FilePath = AbsoluteFilePath;
+	Entries.Reset();
+	EntryIndices.Reset();
+
+	// Allow writing so that files that are open in a spreadsheet application can still be read
+	FileHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*AbsoluteFilePath, /*bAllowWrite:*/ true));
+	if (!FileHandle.IsValid())
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("Unable to read %s"), *AbsoluteFilePath);
+		return false;
+	}
+	FileSize = FileHandle->Size();
+
+	return ReadCentralDirectory();
+}
+
+bool FPMXlsxImporterZipArchive::ReadAt(int64 Offset, int64 Num, uint8* OutData) const
+{
+	if (Offset < 0 || Num < 0 || Offset + Num > FileSize || !FileHandle->Seek(Offset) || !FileHandle->Read(OutData, Num))
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("Unable to read %lld bytes at offset %lld of %s"), Num, Offset, *FilePath);
+		return false;
+	}
+	return true;
+}
+
+bool FPMXlsxImporterZipArchive::ReadCentralDirectory()
+{
+	// The end of central directory record is at the very end of the file, followed only by an optional comment, so
+	// only the end of the file has to be searched for it
+	const int64 TailSize = FMath::Min<int64>(FileSize, END_OF_CENTRAL_DIRECTORY_SIZE + MAX_ZIP_COMMENT_SIZE);
+	const int64 TailOffset = FileSize - TailSize;
+	TArray<uint8> Tail;
+	Tail.SetNumUninitialized(TailSize);
+	if (!ReadAt(TailOffset, TailSize, Tail.GetData()))
+	{
+		return false;
+	}
+
+	int64 EndOfCentralDirectoryOffset = INDEX_NONE;
+	for (int64 Offset = TailSize - END_OF_CENTRAL_DIRECTORY_SIZE; Offset >= 0; --Offset)
+	{
+		if (ReadUInt32(Tail.GetData() + Offset) == END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+		{
+			EndOfCentralDirectoryOffset = TailOffset + Offset;
+			break;
+		}
+	}
+
+	if (EndOfCentralDirectoryOffset == INDEX_NONE)
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s is not a zip archive"), *FilePath);
+		return false;
+	}
+
+	const uint8* EndOfCentralDirectory = Tail.GetData() + (EndOfCentralDirectoryOffset - TailOffset);
+	const uint16 NumEntries = ReadUInt16(EndOfCentralDirectory + 10);
+	const uint32 CentralDirectorySize = ReadUInt32(EndOfCentralDirectory + 12);
+	const uint32 CentralDirectoryOffset = ReadUInt32(EndOfCentralDirectory + 16);
+
+	if (NumEntries == 0xFFFF || CentralDirectoryOffset == 0xFFFFFFFF)
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s is a zip64 archive, which is not supported by the native reader"), *FilePath);
+		return false;
+	}
+
+	if ((int64)CentralDirectoryOffset + CentralDirectorySize > EndOfCentralDirectoryOffset)
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s has a corrupt central directory"), *FilePath);
+		return false;
+	}
+
+	TArray<uint8> CentralDirectory;
+	CentralDirectory.SetNumUninitialized(CentralDirectorySize);
+	if (!ReadAt(CentralDirectoryOffset, CentralDirectorySize, CentralDirectory.GetData()))
+	{
+		return false;
+	}
+	const uint8* Data = CentralDirectory.GetData();
+
+	Entries.Reserve(NumEntries);
+	EntryIndices.Reserve(NumEntries);
+
+	// Offsets into CentralDirectory
+	int64 Offset = 0;
+	for (int32 Index = 0; Index < NumEntries; ++Index)
+	{
+		if (Offset + CENTRAL_DIRECTORY_HEADER_SIZE > CentralDirectorySize ||
+			ReadUInt32(Data + Offset) != CENTRAL_DIRECTORY_HEADER_SIGNATURE)
+		{
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s has a corrupt central directory"), *FilePath);
+			return false;
+		}
+
+		const uint8* Header = Data + Offset;
+		const uint16 NameLength = ReadUInt16(Header + 28);
+		const uint16 ExtraLength = ReadUInt16(Header + 30);
+		const uint16 CommentLength = ReadUInt16(Header + 32);
+		if (Offset + CENTRAL_DIRECTORY_HEADER_SIZE + NameLength > CentralDirectorySize)
+		{
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s has a corrupt central directory"), *FilePath);
+			return false;
+		}
+
+		FEntry& Entry = Entries.AddDefaulted_GetRef();
+		Entry.CompressionMethod = ReadUInt16(Header + 10);
+		Entry.Crc32 = ReadUInt32(Header + 16);
+		Entry.CompressedSize = ReadUInt32(Header + 20);
+		Entry.UncompressedSize = ReadUInt32(Header + 24);
+		Entry.LocalHeaderOffset = ReadUInt32(Header + 42);
+		// Entry names in XLSX files are always ASCII part names like "xl/worksheets/sheet1.xml"
+		Entry.Name = FString(FUTF8ToTCHAR((const ANSICHAR*)(Header + CENTRAL_DIRECTORY_HEADER_SIZE), NameLength));
+
+		if ((ReadUInt16(Header + 8) & FLAG_ENCRYPTED) != 0)
+		{
+			// Leave it in the list so that Extract can report a useful error for the specific part
+			UE_LOG(LogPMXlsxImporter, Verbose, TEXT("%s: %s is encrypted"), *FilePath, *Entry.Name);
+			Entry.CompressionMethod = 0xFFFF;
+		}
+
+		EntryIndices.Add(Entry.Name, Entries.Num() - 1);
+		Offset += CENTRAL_DIRECTORY_HEADER_SIZE + NameLength + ExtraLength + CommentLength;
+	}
+
+	return true;
+}
+
+const FPMXlsxImporterZipArchive::FEntry* FPMXlsxImporterZipArchive::FindEntry(const FString& EntryName) const
+{
+	const int32* Index = EntryIndices.Find(EntryName);
+	return Index ? &Entries[*Index] : nullptr;
+}
+
+bool FPMXlsxImporterZipArchive::FindCompressedData(const FEntry& Entry, int64& OutCompressedDataOffset) const
+{
+	const int64 HeaderOffset = Entry.LocalHeaderOffset;
+	uint8 Header[LOCAL_FILE_HEADER_SIZE];
+	if (HeaderOffset + LOCAL_FILE_HEADER_SIZE > FileSize || !ReadAt(HeaderOffset, LOCAL_FILE_HEADER_SIZE, Header) || ReadUInt32(Header) != LOCAL_FILE_HEADER_SIGNATURE)
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: corrupt local header for %s"), *FilePath, *Entry.Name);
+		return false;
+	}
+
+	// The local header repeats the name, but its extra field may differ in length from the central directory's copy
+	const int64 DataOffset = HeaderOffset + LOCAL_FILE_HEADER_SIZE + ReadUInt16(Header + 26) + ReadUInt16(Header + 28);
+	if (DataOffset + Entry.CompressedSize > FileSize || Entry.UncompressedSize > (uint32)MAX_int32)
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: %s extends past the end of the file"), *FilePath, *Entry.Name);
+		return false;
+	}
+
+	OutCompressedDataOffset = DataOffset;
+	return true;
+}
+
+bool FPMXlsxImporterZipArchive::Extract(const FEntry& Entry, TArray<uint8>& OutData) const
+{
+	OutData.Reset();
+
+	int64 CompressedDataOffset = 0;
+	if (!FindCompressedData(Entry, CompressedDataOffset))
+	{
+		return false;
+	}
+
+	OutData.SetNumUninitialized(Entry.UncompressedSize);
+
+	if (Entry.CompressionMethod == COMPRESSION_METHOD_STORED)
+	{
+		if (Entry.CompressedSize != Entry.UncompressedSize)
+		{
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: %s has mismatched sizes"), *FilePath, *Entry.Name);
+			return false;
+		}
+		if (!ReadAt(CompressedDataOffset, Entry.CompressedSize, OutData.GetData()))
+		{
+			return false;
+		}
+	}
+	else if (Entry.CompressionMethod == COMPRESSION_METHOD_DEFLATED)
+	{
+		TArray<uint8> CompressedData;
+		CompressedData.SetNumUninitialized(Entry.CompressedSize);
+		if (!ReadAt(CompressedDataOffset, Entry.CompressedSize, CompressedData.GetData()))
+		{
+			return false;
+		}
+
+		z_stream Stream;
+		FMemory::Memzero(Stream);
+		Stream.next_in = (Bytef*)CompressedData.GetData();
+		Stream.avail_in = Entry.CompressedSize;
+		Stream.next_out = (Bytef*)OutData.GetData();
+		Stream.avail_out = Entry.UncompressedSize;
+
+		// Negative window bits means a raw deflate stream with no zlib header, which is what zip files contain
+		if (inflateInit2(&Stream, -MAX_WBITS) != Z_OK)
+		{
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: unable to initialize zlib for %s"), *FilePath, *Entry.Name);
+			return false;
+		}
+		const int32 Result = inflate(&Stream, Z_FINISH);
+		inflateEnd(&Stream);
+
+		if (Result != Z_STREAM_END || Stream.total_out != Entry.UncompressedSize)
+		{
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: unable to inflate %s (zlib error %i)"), *FilePath, *Entry.Name, Result);
+			return false;
+		}
+	}
+	else
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: %s uses an unsupported compression method or encryption"), *FilePath, *Entry.Name);
+		return false;
+	}
+
+	if (crc32(0L, (const Bytef*)OutData.GetData(), OutData.Num()) != Entry.Crc32)
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: CRC mismatch in %s"), *FilePath, *Entry.Name);
+		return false;
+	}
+
+	return true;
+}
+
+FPMXlsxImporterZipArchive::FEntryReader::FEntryReader()
+{
+}
+
+FPMXlsxImporterZipArchive::FEntryReader::~FEntryReader()
+{
+	Close();
+}
+
+void FPMXlsxImporterZipArchive::FEntryReader::Close()
+{
+	if (Stream != nullptr)
+	{
+		inflateEnd(Stream);
+		delete Stream;
+		Stream = nullptr;
+	}
+}
+
+bool FPMXlsxImporterZipArchive::FEntryReader::Open(const FPMXlsxImporterZipArchive& InArchive, const FEntry& InEntry)
+{
+	Close();
+	Archive = &InArchive;
+	Entry = &InEntry;
+	NumRead = 0;
+	NumCompressedRead = 0;
+	Crc32 = 0;
+	bAtEnd = false;
+
+	if (!Archive->FindCompressedData(*Entry, CompressedDataOffset))
+	{
+		return false;
+	}
+
+	if (Entry->CompressionMethod == COMPRESSION_METHOD_STORED)
+	{
+		if (Entry->CompressedSize != Entry->UncompressedSize)
+		{
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: %s has mismatched sizes"), *Archive->FilePath, *Entry->Name);
+			return false;
+		}
+	}
+	else if (Entry->CompressionMethod == COMPRESSION_METHOD_DEFLATED)
+	{
+		// Compressed data is read from the file as inflate needs it
+		Stream = new z_stream;
+		FMemory::Memzero(*Stream);
+
+		// See Extract
+		if (inflateInit2(Stream, -MAX_WBITS) != Z_OK)
+		{
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: unable to initialize zlib for %s"), *Archive->FilePath, *Entry->Name);
+			delete Stream;
+			Stream = nullptr;
+			return false;
+		}
+	}
+	else
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: %s uses an unsupported compression method or encryption"), *Archive->FilePath, *Entry->Name);
+		return false;
+	}
+
+	bAtEnd = Entry->UncompressedSize == 0;
+	return true;
+}
+
+bool FPMXlsxImporterZipArchive::FEntryReader::Read(TArray<uint8>& OutData, int32 MaxBytes)
+{
+	if (bAtEnd)
+	{
+		return true;
+	}
+
+	const uint32 NumToRead = FMath::Min<uint32>(MaxBytes, Entry->UncompressedSize - NumRead);
+	const int32 OldNum = OutData.Num();
+	OutData.AddUninitialized(NumToRead);
+	uint8* Out = OutData.GetData() + OldNum;
+
+	uint32 NumInflated = NumToRead;
+	if (Stream == nullptr)
+	{
+		if (!Archive->ReadAt(CompressedDataOffset + NumRead, NumToRead, Out))
+		{
+			OutData.SetNum(OldNum, /*bAllowShrinking:*/ false);
+			return false;
+		}
+	}
+	else
+	{
+		Stream->next_out = (Bytef*)Out;
+		Stream->avail_out = NumToRead;
+		int32 Result = Z_OK;
+		while (Stream->avail_out > 0 && Result == Z_OK)
+		{
+			if (Stream->avail_in == 0)
+			{
+				const uint32 NumChunkBytes = FMath::Min<uint32>(COMPRESSED_CHUNK_SIZE, Entry->CompressedSize - NumCompressedRead);
+				CompressedChunk.SetNumUninitialized(NumChunkBytes, /*bAllowShrinking:*/ false);
+				if (NumChunkBytes > 0 && !Archive->ReadAt(CompressedDataOffset + NumCompressedRead, NumChunkBytes, CompressedChunk.GetData()))
+				{
+					OutData.SetNum(OldNum, /*bAllowShrinking:*/ false);
+					return false;
+				}
+				NumCompressedRead += NumChunkBytes;
+				Stream->next_in = (Bytef*)CompressedChunk.GetData();
+				Stream->avail_in = NumChunkBytes;
+			}
+			// Z_BUF_ERROR means no progress could be made, i.e. the compressed data ended too soon
+			Result = inflate(Stream, Z_NO_FLUSH);
+		}
+
+		NumInflated = NumToRead - Stream->avail_out;
+		// The output buffer never extends past the end of the entry, so anything short of filling it means it's corrupt
+		if ((Result != Z_OK && Result != Z_STREAM_END) || NumInflated != NumToRead)
+		{
+			UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: unable to inflate %s (zlib error %i)"), *Archive->FilePath, *Entry->Name, Result);
+			OutData.SetNum(OldNum, /*bAllowShrinking:*/ false);
+			return false;
+		}
+	}
+
+	Crc32 = crc32(Crc32, (const Bytef*)Out, NumInflated);
+	NumRead += NumInflated;
+	if (NumRead < Entry->UncompressedSize)
+	{
+		return true;
+	}
+
+	bAtEnd = true;
+	Close();
+	if (Crc32 != Entry->Crc32)
+	{
+		UE_LOG(LogPMXlsxImporter, Error, TEXT("%s: CRC mismatch in %s"), *Archive->FilePath, *Entry->Name);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,92 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+struct z_stream_s;
+
+// Minimal read-only zip reader used by the native XLSX reader.
+// Only supports the subset of the zip format that spreadsheet applications write:
+// stored or deflated entries, no encryption, no zip64, no multi-disk archives.
+class FPMXlsxImporterZipArchive
+{
+public:
+	struct FEntry
+	{
+		FString Name;
+		uint32 Crc32 = 0;
+		uint32 CompressedSize = 0;
+		uint32 UncompressedSize = 0;
+		uint32 LocalHeaderOffset = 0;
+		uint16 CompressionMethod = 0;
+	};
+
+	// Opens the file and indexes its central directory, which is the only part of the file that gets read. Entries are
+	// only read from the file, and inflated, when they're extracted. The file stays open until the archive is destroyed.
+	// Logs an error and returns false if the file is not a zip archive this class can read.
+	bool Open(const FString& AbsoluteFilePath);
+
+	// Returns null if there is no entry with exactly this name (e.g. "xl/workbook.xml")
+	const FEntry* FindEntry(const FString& EntryName) const;
+
+	// Inflates Entry into OutData and checks it against the CRC recorded in the central directory
+	bool Extract(const FEntry& Entry, TArray<uint8>& OutData) const;
+
+	// Inflates one entry a piece at a time, so that large entries never have to be held in memory all at once.
+	// Must not outlive the archive it was opened on.
+	class FEntryReader
+	{
+	public:
+		FEntryReader();
+		~FEntryReader();
+
+		FEntryReader(const FEntryReader&) = delete;
+		FEntryReader& operator=(const FEntryReader&) = delete;
+
+		bool Open(const FPMXlsxImporterZipArchive& InArchive, const FEntry& InEntry);
+
+		// Inflates up to MaxBytes more bytes onto the end of OutData. The CRC recorded in the central directory is
+		// checked once the last byte has been read.
+		bool Read(TArray<uint8>& OutData, int32 MaxBytes);
+
+		bool IsAtEnd() const
+		{
+			return bAtEnd;
+		}
+
+	private:
+		void Close();
+
+		const FPMXlsxImporterZipArchive* Archive = nullptr;
+		const FEntry* Entry = nullptr;
+		int64 CompressedDataOffset = 0;
+		// Null for stored entries
+		z_stream_s* Stream = nullptr;
+		// Compressed data waiting to be inflated
+		TArray<uint8> CompressedChunk;
+		uint32 NumCompressedRead = 0;
+		uint32 NumRead = 0;
+		uint32 Crc32 = 0;
+		bool bAtEnd = false;
+	};
+
+	const FString& GetFilePath() const
+	{
+		return FilePath;
+	}
+
+private:
+	bool ReadCentralDirectory();
+	// Finds where Entry's compressed data starts in the file, after its local header
+	bool FindCompressedData(const FEntry& Entry, int64& OutCompressedDataOffset) const;
+	// Reads Num bytes from the file into OutData, logging an error if they can't be read
+	bool ReadAt(int64 Offset, int64 Num, uint8* OutData) const;
+
+	FString FilePath;
+	TUniquePtr<IFileHandle> FileHandle;
+	int64 FileSize = 0;
+	TArray<FEntry> Entries;
+	TMap<FString, int32> EntryIndices;
+};
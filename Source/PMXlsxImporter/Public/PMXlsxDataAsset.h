@@ -1,124 +1,219 @@
-// Copyright 2022 Proletariat, Inc.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include <type_traits>
-#include "PMXlsxImporterContextLogger.h"
-#include "PMXlsxDataAsset.generated.h"
-
-UCLASS()
-class PMXLSXIMPORTER_API UPMXlsxDataAsset : public UDataAsset
-{
-	GENERATED_BODY()
-
-#ifdef WITH_EDITOR
-public:
-	// Input: A map of column headers to stringified values for each of those headers.
-	// Make sure to force values to strings in python using the str(...) function
-	// or Unreal won't be able to convert the map properly.
-	// Record all errors by adding them to InOutErrors
-	// Override this function if you want to parse non-UPROPERTY fields.
-	void ImportFromXLSX(const TMap<FString, FString>& Values, FPMXlsxImporterContextLogger& InOutErrors);
-
-	// Validate that this object has been set up correctly against both itself and the UPMXlsxDataAsset that came
-	// before it in the XLSX file.
-	void Validate(const UPMXlsxDataAsset* Previous, FPMXlsxImporterContextLogger& InOutErrors) const;
-
-protected:
-	virtual void ImportFromXLSXImpl(const TMap<FString, FString>& Values, FPMXlsxImporterContextLogger& InOutErrors);
-	virtual void ValidateImpl(FPMXlsxImporterContextLogger& InOutErrors) const;
-	virtual void ValidateAgainstPreviousImpl(const UPMXlsxDataAsset* Previous, FPMXlsxImporterContextLogger& InOutErrors) const {}
-
-	// ImportFromXLSX makes a copy of this before parsing anything. This function checks if anything has changed
-	// by exporting this and the copy to text, then comparing the text results.
-	// If your subclass parses non-UPROPERTY properties, override WasModified and check those properties here.
-	virtual bool WasModified(UPMXlsxDataAsset* Original);
-
-	// Parse Value according to type info in Property, then store the parsed value in Result.
-	// All Parse* functions return a bool indicating whether the string was successfully parsed.
-	// If it was not successfully parsed, the function should push an error onto InOutErrors.
-	// Subclasses may override this to parse class-specific types.
-	// Subclasses should do their own parsing for custom types then call Super::ParseValue if necessary,
-	// because UPMXlsxDataAsset::ParseValue appends an error if it fails
-	virtual bool ParseValue(FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
-
-	// Accepts numbers ending in ".0" because sometimes XLSX files are like that
-	template<typename TInt>
-	bool ParseInt(const FString& Value, TInt& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
-	{
-		// uint64 is not supported. Unreal does not have FDefaultValueHelper::ParseUInt64.
-		static_assert(!std::is_same<TInt, uint64>::value, "uint64 is not supported by PMXlsxDataAsset::ParseInt.");
-		static_assert(sizeof(TInt) <= sizeof(int64), "Data types larger than int64 are not supported.");
-
-		int64 Result64 = 0;
-		if (!UPMXlsxDataAsset::ParseInt64Internal(Value, Result64))
-		{
-			AddUnableToParseError(Value, InOutErrors);
-			return false;
-		}
-
-		if (Result64 < (int64)TNumericLimits<TInt>::Min() || Result64 > (int64)TNumericLimits<TInt>::Max())
-		{
-			InOutErrors.Logf(TEXT("Value %li is outside storage limits"), Result64);
-			return false;
-		}
-
-		OutResult = (TInt)Result64;
-		return true;
-	}
-
-	// Accepts either the enum's name or the integer value of the enum as valid input.
-	template<typename TInt>
-	bool ParseEnum(const FString& Value, const UEnum& EnumType, TInt& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
-	{
-		// uint64 is not supported. Unreal's enum interface returns int64s, which do not overlap with uint64s.
-		static_assert(!std::is_same<TInt, uint64>::value, "uint64 is not supported by PMXlsxDataAsset::ParseEnum.");
-
-		int64 Result64 = EnumType.GetValueByNameString(Value, EGetByNameFlags::CheckAuthoredName);
-		if (Result64 != INDEX_NONE)
-		{
-			OutResult = (TInt)Result64;
-			return true;
-		}
-
-		if (ParseInt64Internal(Value, Result64))
-		{
-			if (EnumType.IsValidEnumValue(Result64))
-			{
-				OutResult = (TInt)Result64;
-				return true;
-			}
-			else
-			{
-				InOutErrors.Logf(TEXT("%i is not a valid value for %s"), Result64, *EnumType.GetName());
-				return false;
-			}
-		}
-
-		AddUnableToParseError(Value, InOutErrors);
-		return false;
-	}
-
-	// Accepts case insensitive "TRUE", "FALSE", or an int32.
-	bool ParseBool(const FString& Value, bool& OutResult, FPMXlsxImporterContextLogger& InOutErrors);
-	// ISO8601 formatted datetimes
-	bool ParseDateTime(const FString& Value, FDateTime& OutResult, FPMXlsxImporterContextLogger& InOutErrors);
-	// Automatically sets up localization namespace and key
-	bool ParseText(const FString& PropName, const FString& Value, FText& OutResult, FPMXlsxImporterContextLogger& InOutErrors);
-	// Splits Value by commas and recursively parses each element
-	bool ParseArray(const FArrayProperty& Property, const FString& Value, void* OutResult, FPMXlsxImporterContextLogger& InOutErrors);
-
-	// Ensures the asset type exists or is empty.
-	void ValidatePrimaryAssetType(const FPrimaryAssetType& AssetType, FPMXlsxImporterContextLogger& InOutErrors) const;
-	// Ensures the asset id refers to a valid asset or empty.
-	void ValidatePrimaryAssetId(const FPrimaryAssetId& AssetId, FPMXlsxImporterContextLogger& InOutErrors) const;
-
-	// Pushes a generic "unable to parse" error on the end of InOutErrors
-	void AddUnableToParseError(const FString& Value, FPMXlsxImporterContextLogger& InOutErrors);
-
-private:
-	// Parses an Int64 but does not add an error if it fails. Used by ParseInt and ParseEnum.
-	bool ParseInt64Internal(const FString& Value, int64& OutResult);
-#endif
-};
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <type_traits>
+#include "PMXlsxImporterContextLogger.h"
+#include "PMXlsxDataAsset.generated.h"
+
+class UPMXlsxDataAsset;
+class FPMXlsxImporterParserRegistry;
+struct FPMXlsxImporterImportPlanColumns;
+struct FPMXlsxImporterImportPlanProperty;
+struct FPMXlsxImporterImportPlanStagedRow;
+class FPMXlsxImporterPrimaryAssetSnapshot;
+struct FPMXlsxImporterPythonBridgeCell;
+class FPMXlsxImporterWorksheet;
+
+// Parses Value into Result, which points at Property's value inside Asset. See UPMXlsxDataAsset::ParseValue and
+// FPMXlsxImporterParserRegistry.
+typedef bool (*FPMXlsxImporterParseFunction)(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+
+// Parses a typed cell into Result without going through its string, e.g. a number cell into an int32 property.
+// Returns false without logging anything if Cell's type or value doesn't fit, in which case the cell's string is
+// parsed by the matching FPMXlsxImporterParseFunction instead, which reports the error.
+typedef bool (*FPMXlsxImporterParseCellFunction)(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result);
+
+UCLASS()
+class PMXLSXIMPORTER_API UPMXlsxDataAsset : public UDataAsset
+{
+	GENERATED_BODY()
+
+#ifdef WITH_EDITOR
+public:
+	// Input: A map of column headers to stringified values for each of those headers.
+	// Make sure to force values to strings in python using the str(...) function
+	// or Unreal won't be able to convert the map properly.
+	// Record all errors by adding them to InOutErrors
+	// Override this function if you want to parse non-UPROPERTY fields.
+	// Returns whether the asset was modified and needs to be checked out and saved. This function does neither.
+	bool ImportFromXLSX(const TMap<FString, FString>& Values, FPMXlsxImporterContextLogger& InOutErrors);
+
+	// Validate that this object has been set up correctly against both itself and the UPMXlsxDataAsset that came
+	// before it in the XLSX file.
+	void Validate(const UPMXlsxDataAsset* Previous, FPMXlsxImporterContextLogger& InOutErrors) const;
+
+protected:
+	virtual void ImportFromXLSXImpl(const TMap<FString, FString>& Values, FPMXlsxImporterContextLogger& InOutErrors);
+	virtual void ValidateImpl(FPMXlsxImporterContextLogger& InOutErrors) const;
+	virtual void ValidateAgainstPreviousImpl(const UPMXlsxDataAsset* Previous, FPMXlsxImporterContextLogger& InOutErrors) const {}
+
+	// ImportFromXLSX makes a full copy of this before parsing anything, then calls WasModified with it to decide
+	// whether this asset needs to be checked out and saved. That copy is slow, so if your subclass doesn't override
+	// WasModified, override RequiresOriginalForWasModified to return false. ImportFromXLSX will then only snapshot the
+	// ImportFromXLSX properties and compare those instead.
+	virtual bool RequiresOriginalForWasModified() const { return true; }
+
+	// Only called if RequiresOriginalForWasModified returns true. Checks if anything has changed
+	// by exporting this and Original to text, then comparing the text results.
+	// Override this and check your non-UPROPERTY properties here.
+	virtual bool WasModified(UPMXlsxDataAsset* Original);
+
+	// Each row is copied into the map of column headers to values passed to ImportFromXLSXImpl. UPMXlsxDataAsset
+	// itself reads rows straight from their worksheet, so if your subclass doesn't override ImportFromXLSXImpl, or
+	// its override doesn't read Values, override RequiresValueMap to return false and skip that copy.
+	virtual bool RequiresValueMap() const { return true; }
+
+	// Return true if ParseValue, including any override, is safe to call on a worker thread for this class: it only
+	// reads from this asset and doesn't load or create objects. ParseData then parses this class's rows in parallel.
+	// Properties without a thread safe parser (see FPMXlsxImporterParserRegistry) are still parsed on the game
+	// thread, and so is everything done by ImportFromXLSXImpl overrides.
+	virtual bool CanParseOnWorkerThreads() const { return false; }
+
+	// Return true if ValidateImpl and ValidateAgainstPreviousImpl, including any overrides, are safe to call on a
+	// worker thread for this class: they only read from assets and don't load objects or use UAssetManager directly.
+	// Validate then validates this class's rows in parallel. ValidatePrimaryAssetType and ValidatePrimaryAssetId
+	// are safe to call.
+	virtual bool CanValidateOnWorkerThreads() const { return false; }
+
+	// Return true if this class doesn't override ParseValue, or its override doesn't change how int32, float, FName
+	// or uint8 enum elements are parsed. ParseArray then parses arrays of those in bulk instead of calling ParseValue
+	// for each element.
+	virtual bool CanParseArraysInBulk() const { return false; }
+
+	// Parse Value according to type info in Property, then store the parsed value in Result.
+	// All Parse* functions return a bool indicating whether the string was successfully parsed.
+	// If it was not successfully parsed, the function should push an error onto InOutErrors.
+	// Subclasses may override this to parse class-specific types.
+	// Subclasses should do their own parsing for custom types then call Super::ParseValue if necessary,
+	// because UPMXlsxDataAsset::ParseValue appends an error if it fails
+	// Types used by many subclasses can be registered with FPMXlsxImporterParserRegistry instead.
+	// Number, bool and date cells are parsed without looking at Value when they're passed through unchanged to
+	// UPMXlsxDataAsset::ParseValue, so overrides always see the string but don't slow down the types they don't handle.
+	virtual bool ParseValue(FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+
+	// Accepts numbers ending in ".0" because sometimes XLSX files are like that
+	template<typename TInt>
+	bool ParseInt(const FString& Value, TInt& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
+	{
+		// uint64 is not supported. Unreal does not have FDefaultValueHelper::ParseUInt64.
+		static_assert(!std::is_same<TInt, uint64>::value, "uint64 is not supported by PMXlsxDataAsset::ParseInt.");
+		static_assert(sizeof(TInt) <= sizeof(int64), "Data types larger than int64 are not supported.");
+
+		int64 Result64 = 0;
+		if (!UPMXlsxDataAsset::ParseInt64Internal(Value, Result64))
+		{
+			AddUnableToParseError(Value, InOutErrors);
+			return false;
+		}
+
+		if (Result64 < (int64)TNumericLimits<TInt>::Min() || Result64 > (int64)TNumericLimits<TInt>::Max())
+		{
+			InOutErrors.Logf(TEXT("Value %li is outside storage limits"), Result64);
+			return false;
+		}
+
+		OutResult = (TInt)Result64;
+		return true;
+	}
+
+	// Accepts either the enum's name or the integer value of the enum as valid input.
+	template<typename TInt>
+	bool ParseEnum(const FString& Value, const UEnum& EnumType, TInt& OutResult, FPMXlsxImporterContextLogger& InOutErrors)
+	{
+		// uint64 is not supported. Unreal's enum interface returns int64s, which do not overlap with uint64s.
+		static_assert(!std::is_same<TInt, uint64>::value, "uint64 is not supported by PMXlsxDataAsset::ParseEnum.");
+
+		int64 Result64 = 0;
+		if (!ParseEnumInternal(Value, EnumType, Result64, InOutErrors))
+		{
+			return false;
+		}
+
+		OutResult = (TInt)Result64;
+		return true;
+	}
+
+	// Accepts case insensitive "TRUE", "FALSE", or an int32.
+	bool ParseBool(const FString& Value, bool& OutResult, FPMXlsxImporterContextLogger& InOutErrors);
+	// ISO8601 formatted datetimes, or Excel serial dates like "44927.5"
+	bool ParseDateTime(const FString& Value, FDateTime& OutResult, FPMXlsxImporterContextLogger& InOutErrors);
+	// Automatically sets up localization namespace and key
+	bool ParseText(const FString& PropName, const FString& Value, FText& OutResult, FPMXlsxImporterContextLogger& InOutErrors);
+	// Splits Value by the property's XLSXDelimiter metadata, or commas, and recursively parses each element.
+	// If CanParseArraysInBulk returns true, elements of int32, float, FName and uint8 enum arrays are parsed without
+	// calling ParseValue for each of them.
+	bool ParseArray(const FArrayProperty& Property, const FString& Value, void* OutResult, FPMXlsxImporterContextLogger& InOutErrors);
+
+	// Ensures the asset type exists or is empty.
+	void ValidatePrimaryAssetType(const FPrimaryAssetType& AssetType, FPMXlsxImporterContextLogger& InOutErrors) const;
+	// Ensures the asset id refers to a valid asset or empty.
+	void ValidatePrimaryAssetId(const FPrimaryAssetId& AssetId, FPMXlsxImporterContextLogger& InOutErrors) const;
+
+	// Pushes a generic "unable to parse" error on the end of InOutErrors
+	void AddUnableToParseError(const FString& Value, FPMXlsxImporterContextLogger& InOutErrors);
+
+private:
+	friend class FPMXlsxImporterParserRegistry;
+	friend struct FPMXlsxImporterSettingsEntry;
+	// Lets the PMXlsxImporterTests module import rows the way ParseData does
+	friend struct FPMXlsxImporterTestAccess;
+
+	// Parses an Int64 but does not add an error if it fails. Used by ParseInt and ParseEnum.
+	bool ParseInt64Internal(const FString& Value, int64& OutResult);
+	// Looks Value up in EnumType's FPMXlsxImporterEnumLookup, which is built once per import run. Used by ParseEnum.
+	bool ParseEnumInternal(const FString& Value, const UEnum& EnumType, int64& OutResult, FPMXlsxImporterContextLogger& InOutErrors);
+
+	// While set, ValidatePrimaryAssetType and ValidatePrimaryAssetId use Snapshot instead of UAssetManager so that
+	// they can run on worker threads. Game thread only.
+	static void SetPrimaryAssetSnapshot(const FPMXlsxImporterPrimaryAssetSnapshot* Snapshot);
+
+	// Parses each property in Row's plan that can be parsed on a worker thread into Row.ParsedValues.
+	// Safe to call from any thread if CanParseOnWorkerThreads returns true.
+	void StageFromXLSX(FPMXlsxImporterImportPlanStagedRow& Row);
+	// Same as ImportRowFromXLSX, but applies Row.ParsedValues instead of parsing them again
+	bool ImportStagedFromXLSX(const FPMXlsxImporterImportPlanStagedRow& Row, FPMXlsxImporterContextLogger& InOutErrors);
+	// Calls ImportFromXLSX, which reads Row straight from Columns.Worksheet, parsing its typed cells where possible.
+	// Columns must have been looked up for this asset's class. The map passed to ImportFromXLSX is left empty if
+	// RequiresValueMap returns false.
+	bool ImportRowFromXLSX(const FPMXlsxImporterImportPlanColumns& Columns, int32 Row, FPMXlsxImporterContextLogger& InOutErrors);
+	// Same as above, but looks up the columns of Worksheet for just this row
+	bool ImportRowFromXLSX(const FPMXlsxImporterWorksheet& Worksheet, int32 Row, FPMXlsxImporterContextLogger& InOutErrors);
+
+	// Parses PlanProperty's Column of Worksheet's Row, or its value in Values if Worksheet is null, into Result.
+	// Values read from Worksheet are copied into ValueBuffer, which can be reused from one property to the next.
+	void ParsePlannedProperty(const FPMXlsxImporterImportPlanProperty& PlanProperty, const FPMXlsxImporterWorksheet* Worksheet, int32 Row, int32 Column, const TMap<FString, FString>* Values, FString& ValueBuffer, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+	// Calls ParseValue, letting UPMXlsxDataAsset::ParseValue use the parse functions already resolved by the import
+	// plan and parse from Cell, which may be null, instead of Value
+	bool ParsePlannedValue(const FPMXlsxImporterImportPlanProperty& PlanProperty, const FString& Value, const FPMXlsxImporterPythonBridgeCell* Cell, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+
+	// Registers the FPMXlsxImporterParseFunctions below for each supported type
+	static void RegisterDefaultParsers(FPMXlsxImporterParserRegistry& Registry);
+
+	// FPMXlsxImporterParseFunctions for each supported type
+	static bool ParseBoolProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+	template<typename TInt>
+	static bool ParseIntProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+	template<typename TInt>
+	static bool ParseEnumProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+	static bool ParseTextProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+	static bool ParseDateTimeProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+	static bool ParseArrayProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+	static bool ParseFloatProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+	static bool ParseNameProperty(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors);
+
+	// FPMXlsxImporterParseCellFunctions for the types above that can be stored in a number, bool or date cell
+	static bool ParseBoolCell(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result);
+	template<typename TInt>
+	static bool ParseIntCell(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result);
+	template<typename TInt>
+	static bool ParseEnumCell(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result);
+	template<typename TFloat>
+	static bool ParseFloatCell(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result);
+	static bool ParseDateTimeCell(UPMXlsxDataAsset& Asset, FProperty& Property, const FPMXlsxImporterPythonBridgeCell& Cell, void* Result);
+
+	// Integral numbers that fit in an int64. Bool cells aren't numbers here, just like "True" isn't parsed as one.
+	static bool CellToInt64(const FPMXlsxImporterPythonBridgeCell& Cell, int64& OutResult);
+#endif
+};
@@ -1,28 +1,28 @@
-// Copyright 2022 Proletariat, Inc.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Modules/ModuleManager.h"
-
-class FToolBarBuilder;
-class FMenuBuilder;
-
-class FPMXlsxImporterModule : public IModuleInterface
-{
-public:
-
-	/** IModuleInterface implementation */
-	virtual void StartupModule() override;
-	virtual void ShutdownModule() override;
-	
-	/** This function will be bound to Command. */
-	void PluginButtonClicked();
-	
-private:
-
-	void RegisterMenus();
-
-private:
-	TSharedPtr<class FUICommandList> PluginCommands;
-};
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+class FToolBarBuilder;
+class FMenuBuilder;
+
+class FPMXlsxImporterModule : public IModuleInterface
+{
+public:
+
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+	
+	/** This function will be bound to Command. */
+	void PluginButtonClicked();
+	
+private:
+
+	void RegisterMenus();
+
+private:
+	TSharedPtr<class FUICommandList> PluginCommands;
+};
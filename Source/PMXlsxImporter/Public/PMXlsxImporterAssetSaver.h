@@ -0,0 +1,53 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXlsxImporterContextLogger.h"
+
+class ISourceControlProvider;
+class FPMXlsxImporterStats;
+class UPMXlsxDataAsset;
+
+// Collects the assets modified during an import run so that they can be checked out with one source control
+// operation and saved with one bulk save, instead of a server round trip and a package save per asset.
+class PMXLSXIMPORTER_API FPMXlsxImporterAssetSaver
+{
+public:
+	// Uses the editor's current source control provider
+	FPMXlsxImporterAssetSaver();
+	// Uses Provider instead, e.g. a stub provider when testing
+	explicit FPMXlsxImporterAssetSaver(ISourceControlProvider& InProvider);
+
+	// Workbook and Worksheet are the asset's source, which is added to the context of any error about the asset
+	void Add(UPMXlsxDataAsset& Asset, const FString& Workbook, const FString& Worksheet);
+
+	int32 Num() const
+	{
+		return Assets.Num();
+	}
+
+	// Checks out then saves every asset added since the last call. Assets that can't be checked out are not saved.
+	// Each asset that fails to check out or save adds an error to InOutErrors. Time spent and assets saved are added
+	// to Stats if it isn't null.
+	void CheckOutAndSave(FPMXlsxImporterContextLogger& InOutErrors, FPMXlsxImporterStats* Stats = nullptr);
+
+private:
+	// Returns the packages that are safe to save: checked out, or not under source control at all
+	TArray<UPackage*> CheckOut(const TArray<UPackage*>& Packages, FPMXlsxImporterContextLogger& InOutErrors);
+
+	// Logs Message with the source and path of the asset in Package
+	void LogPackageError(FPMXlsxImporterContextLogger& InOutErrors, const UPackage& Package, const FString& Message) const;
+
+	struct FAsset
+	{
+		TWeakObjectPtr<UPMXlsxDataAsset> Asset;
+		FString Workbook;
+		FString Worksheet;
+	};
+
+	ISourceControlProvider& Provider;
+	TArray<FAsset> Assets;
+	// Index in Assets of the first asset in each package being saved. Only valid during CheckOutAndSave.
+	TMap<const UPackage*, int32> PackageAssets;
+};
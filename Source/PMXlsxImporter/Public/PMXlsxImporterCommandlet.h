@@ -1,19 +1,23 @@
-// Copyright 2022 Proletariat, Inc.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Commandlets/Commandlet.h"
-#include "PMXlsxImporterCommandlet.generated.h"
-
-// Imports all XLSX files currently configured in project settings.
-// Run using -run=PMXlsxImporter
-// Options: -c (only import XLSX files that are locally checked out in source control)
-UCLASS()
-class UPMXlsxImporterCommandlet : public UCommandlet
-{
-	GENERATED_BODY()
-
-public:
-	virtual int32 Main(const FString& Params) override;
-};
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PMXlsxImporterCommandlet.generated.h"
+
+// Imports all XLSX files currently configured in project settings.
+// Run using -run=PMXlsxImporter
+// Options: -c (only import XLSX files that are locally checked out in source control)
+//          -full (import every row, even the ones that haven't changed since the last import)
+//          -streaming (import a batch of rows at a time, as if bStreamingImport was set in settings)
+//          -report=<path> (write every error to <path> as JUnit XML if it ends in .xml, JSON otherwise)
+//          -stats=<path> (write the time spent per entry and phase, and how much was read and saved, to <path> as CSV)
+UCLASS()
+class UPMXlsxImporterCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	virtual int32 Main(const FString& Params) override;
+};
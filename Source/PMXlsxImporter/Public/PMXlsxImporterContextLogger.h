@@ -1,49 +1,143 @@
-// Copyright 2022 Proletariat, Inc.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
-// In-memory collection of FStrings to be logged out later.
-// Tracks context in a stack system and prepends that context to each log.
-class PMXLSXIMPORTER_API FPMXlsxImporterContextLogger : public FOutputDevice
-{
-public:
-	friend class FPMXlsxImporterContextLoggerScopedContext;
-
-	FPMXlsxImporterContextLogger();
-
-	// FOutputDevice interface
-	// "Error" is the only verbosity used by this class. Category is ignored.
-	virtual void Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const FName& Category) override;
-	virtual void Flush() override;
-	virtual bool IsMemoryOnly() const override
-	{
-		return true;
-	}
-
-	// Context is prepended to each log statement, from oldest to newest.
-	// For example: PushContext("classname"); PushContext(".propertyname"); Log("foo");
-	// will serialize "classname.propertyname foo"
-	class FPMXlsxImporterContextLoggerScopedContext PushContext(const FString& Context);
-
-	// Returns the number of errors that have been collected
-	int32 Num() const;
-
-private:
-	void PopContext(); // Called when a ScopedContext falls out of scope
-
-	TArray<FString> Errors;
-	TArray<FString> ContextStack;
-};
-
-// Object that automatically pops a FPMXlsxImporterContextLogger's context when leaving scope
-class PMXLSXIMPORTER_API FPMXlsxImporterContextLoggerScopedContext
-{
-public:
-	FPMXlsxImporterContextLoggerScopedContext(FPMXlsxImporterContextLogger& Owner);
-	~FPMXlsxImporterContextLoggerScopedContext();
-
-private:
-	FPMXlsxImporterContextLogger& Owner;
-};
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EPMXlsxImporterErrorSeverity : uint8
+{
+	Warning,
+	Error,
+};
+
+// One logged error, with the context it was logged in broken out into fields so that it can be reported per cell.
+// Fields the context didn't provide are left empty.
+struct PMXLSXIMPORTER_API FPMXlsxImporterErrorRecord
+{
+	// Project-relative path of the XLSX file
+	FString Workbook;
+	FString Worksheet;
+	// 1-based index of the row among the worksheet's data rows, not counting the header. 0 if unknown.
+	int32 Row = 0;
+	// Header of the column the value came from
+	FString Column;
+	// Path name of the asset being imported or validated
+	FString Asset;
+	// C++ name of the property, followed by [Index] for array elements
+	FString Property;
+	// Every pushed context, formatted from oldest to newest
+	FString Context;
+	FString Message;
+	EPMXlsxImporterErrorSeverity Severity = EPMXlsxImporterErrorSeverity::Error;
+};
+
+// In-memory collection of FStrings to be logged out later.
+// Tracks context in a stack system and prepends that context to each log.
+// Pushing context only records a reference to it. Context is formatted when an error is logged, so pushing it for
+// every row, property and array element costs next to nothing when nothing goes wrong.
+// A logger must only be used by one thread at a time. Work on worker threads logs into its own logger, which is then
+// merged with AppendErrors, so logging in parallel needs no locks and the merged output doesn't depend on scheduling.
+class PMXLSXIMPORTER_API FPMXlsxImporterContextLogger : public FOutputDevice
+{
+public:
+	friend class FPMXlsxImporterContextLoggerScopedContext;
+
+	FPMXlsxImporterContextLogger();
+
+	// FOutputDevice interface
+	// "Warning" logs a warning, anything else logs an error. Category is ignored.
+	virtual void Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const FName& Category) override;
+	virtual void Flush() override;
+	virtual bool IsMemoryOnly() const override
+	{
+		return true;
+	}
+
+	// Context is prepended to each log statement, from oldest to newest.
+	// For example: PushContext("classname"); PushContext(".propertyname"); Log("foo");
+	// will serialize "classname.propertyname foo"
+	// Context is copied. Prefer one of the functions below in code that runs for every row.
+	class FPMXlsxImporterContextLoggerScopedContext PushContext(const FString& Context);
+
+	// Literal must outlive the returned scoped context, e.g. a TEXT() string literal
+	class FPMXlsxImporterContextLoggerScopedContext PushLiteralContext(const TCHAR* Literal);
+	class FPMXlsxImporterContextLoggerScopedContext PushNameContext(FName Name);
+	// Serializes as "[Index]"
+	class FPMXlsxImporterContextLoggerScopedContext PushIndexContext(int32 Index);
+	// Serializes as ".PropertyName PropertyType"
+	class FPMXlsxImporterContextLoggerScopedContext PushPropertyContext(const FProperty& Property);
+	// Serializes as ": ClassName ObjectName"
+	class FPMXlsxImporterContextLoggerScopedContext PushObjectContext(const UObject& Object);
+	// Serializes as "Workbook:Worksheet". Both strings must outlive the returned scoped context.
+	class FPMXlsxImporterContextLoggerScopedContext PushWorksheetContext(const FString& Workbook, const FString& Worksheet);
+	// Only sets FPMXlsxImporterErrorRecord::Row. Doesn't serialize anything.
+	class FPMXlsxImporterContextLoggerScopedContext PushRowContext(int32 Row);
+
+	// Returns the number of errors that have been collected
+	int32 Num() const;
+
+	const TArray<FPMXlsxImporterErrorRecord>& GetErrors() const
+	{
+		return Errors;
+	}
+
+	// Adds Other's errors from StartIndex up to (but not including) EndIndex, with this logger's current context
+	// prepended to each of their contexts. Used to merge errors logged on worker threads.
+	void AppendErrors(const FPMXlsxImporterContextLogger& Other, int32 StartIndex, int32 EndIndex);
+
+	// The context a property pushed with PushPropertyContext serializes as
+	static FString FormatPropertyContext(const FProperty& Property);
+
+private:
+	void PopContext(); // Called when a ScopedContext falls out of scope
+
+	// Prepends the context stack to Error.Context and fills in the fields Error doesn't have yet
+	void ApplyContext(FPMXlsxImporterErrorRecord& Error) const;
+
+	struct FContextFrame
+	{
+		enum class EType : uint8
+		{
+			String, // Index into OwnedStrings
+			Literal,
+			Name,
+			Index,
+			Property,
+			Object,
+			Worksheet,
+			Row,
+		};
+
+		EType Type;
+		union
+		{
+			const TCHAR* Literal;
+			const FProperty* Property;
+			const UObject* Object;
+			int32 Index;
+			struct
+			{
+				const FString* Workbook;
+				const FString* Worksheet;
+			} Sheet;
+		};
+		FName Name;
+	};
+
+	TArray<FPMXlsxImporterErrorRecord> Errors;
+	// Deep enough for entry, row, asset, property and a few levels of array elements without allocating
+	TArray<FContextFrame, TInlineAllocator<8>> ContextStack;
+	// Copies of the strings passed to PushContext
+	TArray<FString> OwnedStrings;
+};
+
+// Object that automatically pops a FPMXlsxImporterContextLogger's context when leaving scope
+class PMXLSXIMPORTER_API FPMXlsxImporterContextLoggerScopedContext
+{
+public:
+	FPMXlsxImporterContextLoggerScopedContext(FPMXlsxImporterContextLogger& Owner);
+	~FPMXlsxImporterContextLoggerScopedContext();
+
+private:
+	FPMXlsxImporterContextLogger& Owner;
+};
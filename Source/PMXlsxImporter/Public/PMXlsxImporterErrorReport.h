@@ -0,0 +1,22 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXlsxImporterContextLogger.h"
+
+// Writes the errors collected during an import run to a file that CI can read without scraping the log
+class PMXLSXIMPORTER_API FPMXlsxImporterErrorReport
+{
+public:
+	// Writes JUnit XML if FilePath ends in .xml, JSON otherwise
+	static bool Write(const FPMXlsxImporterContextLogger& Errors, const FString& FilePath);
+
+	// {"errors": [{"workbook": ..., "worksheet": ..., "row": ..., "column": ..., "asset": ..., "property": ...,
+	// "message": ..., "severity": "error"|"warning"}, ...]}
+	static FString ToJson(const TArray<FPMXlsxImporterErrorRecord>& Errors);
+
+	// One test suite per worksheet and one test case per error. Warnings are passing test cases with the warning
+	// in system-out. A run without errors is a single passing test case.
+	static FString ToJUnit(const TArray<FPMXlsxImporterErrorRecord>& Errors);
+};
@@ -0,0 +1,78 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Identifies the contents of a worksheet without reading it, using the CRC32s and sizes the XLSX file's zip central
+// directory records for the worksheet part, the shared strings part and the styles part, which decides which cells
+// are dates
+struct FPMXlsxImporterWorksheetFingerprint
+{
+	uint32 WorksheetCrc32 = 0;
+	uint32 WorksheetSize = 0;
+	uint32 SharedStringsCrc32 = 0;
+	uint32 SharedStringsSize = 0;
+	uint32 StylesCrc32 = 0;
+	uint32 StylesSize = 0;
+	bool bDate1904 = false;
+	// The native and python readers don't produce identical rows
+	bool bReadNatively = false;
+
+	// Worksheet parts are never empty, so a zero size means the fingerprint couldn't be taken
+	bool IsValid() const
+	{
+		return WorksheetSize != 0;
+	}
+
+	bool operator==(const FPMXlsxImporterWorksheetFingerprint& Other) const
+	{
+		return WorksheetCrc32 == Other.WorksheetCrc32 &&
+			WorksheetSize == Other.WorksheetSize &&
+			SharedStringsCrc32 == Other.SharedStringsCrc32 &&
+			SharedStringsSize == Other.SharedStringsSize &&
+			StylesCrc32 == Other.StylesCrc32 &&
+			StylesSize == Other.StylesSize &&
+			bDate1904 == Other.bDate1904 &&
+			bReadNatively == Other.bReadNatively;
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FPMXlsxImporterWorksheetFingerprint& Fingerprint);
+};
+
+// What previous successful import runs imported, persisted in Saved/PMXlsxImporter/ so that later runs can skip
+// worksheets and rows that would not change anything. Everything is thrown away if the plugin version or file format changes.
+class PMXLSXIMPORTER_API FPMXlsxImporterImportState
+{
+public:
+	// State of one FPMXlsxImporterSettingsEntry. See FPMXlsxImporterSettingsEntry::GetImportStateKey.
+	struct FEntry
+	{
+		// FPMXlsxImporterImportPlan::GetLayoutHash of the class the rows were imported into
+		uint64 LayoutHash = 0;
+		// Asset name -> FPMXlsxImporterWorksheet::HashRow of the row it was last imported from
+		TMap<FString, uint64> RowHashes;
+		// The worksheet as it was last imported. Invalid if it couldn't be fingerprinted.
+		FPMXlsxImporterWorksheetFingerprint Fingerprint;
+
+		friend FArchive& operator<<(FArchive& Ar, FEntry& Entry);
+	};
+
+	static FString GetDefaultFilePath();
+
+	// Replaces the current state with the contents of FilePath. Returns false and leaves the state empty if the file
+	// doesn't exist, is corrupt, or was written by a different version of the plugin.
+	bool Load(const FString& FilePath);
+	bool Save(const FString& FilePath) const;
+
+	const FEntry* FindEntry(const FString& EntryKey) const;
+	FEntry& FindOrAddEntry(const FString& EntryKey);
+
+	// Copies every entry in Other over this state's entry with the same key
+	void Append(const FPMXlsxImporterImportState& Other);
+
+private:
+	static int32 GetPluginVersion();
+
+	TMap<FString, FEntry> Entries;
+};
@@ -0,0 +1,61 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXlsxDataAsset.h"
+
+// Maps property types to the functions UPMXlsxDataAsset::ParseValue uses to parse them.
+// Properties are looked up by their FFieldClass (FIntProperty, FTextProperty...), except for struct properties,
+// which are looked up by their UScriptStruct, and enum properties, which are looked up by the FFieldClass of their
+// underlying numeric property.
+//
+// Modules can register parsers for their own types, typically from StartupModule. For example:
+//   FPMXlsxImporterParserRegistry::Get().RegisterStructParser(FMyStruct::StaticStruct(), &ParseMyStruct);
+// Registered parsers are used by every UPMXlsxDataAsset subclass. Overriding ParseValue still works for parsing
+// that is specific to one subclass, and overrides are always called before anything in this registry.
+class PMXLSXIMPORTER_API FPMXlsxImporterParserRegistry
+{
+public:
+	static FPMXlsxImporterParserRegistry& Get();
+
+	// Game thread only, and not while an import is running.
+	// Registering a type that already has a parser replaces that parser.
+	// Pass bThreadSafe = true if ParseFunction only reads from Asset and doesn't load or create objects, so that it
+	// can run on worker threads for classes that parse in parallel (see UPMXlsxDataAsset::CanParseOnWorkerThreads).
+	// ParseCellFunction is optional. If set, it's tried first for cells the reader knows the type of, and must be
+	// thread safe if ParseFunction is.
+	void RegisterPropertyParser(FFieldClass* PropertyClass, FPMXlsxImporterParseFunction ParseFunction, bool bThreadSafe = false, FPMXlsxImporterParseCellFunction ParseCellFunction = nullptr);
+	void RegisterStructParser(const UScriptStruct* Struct, FPMXlsxImporterParseFunction ParseFunction, bool bThreadSafe = false, FPMXlsxImporterParseCellFunction ParseCellFunction = nullptr);
+	void RegisterEnumParser(FFieldClass* UnderlyingPropertyClass, FPMXlsxImporterParseFunction ParseFunction, bool bThreadSafe = false, FPMXlsxImporterParseCellFunction ParseCellFunction = nullptr);
+
+	void UnregisterPropertyParser(FFieldClass* PropertyClass);
+	void UnregisterStructParser(const UScriptStruct* Struct);
+
+	// Returns null if no parser is registered for Property's type, in which case ParseValue falls back on
+	// FProperty::ImportText. Safe to call from any thread.
+	FPMXlsxImporterParseFunction Find(const FProperty& Property) const;
+	// Returns null if the parser registered for Property's type can't parse typed cells. Safe to call from any thread.
+	FPMXlsxImporterParseCellFunction FindCellParser(const FProperty& Property) const;
+
+	// Returns whether Property has a parser registered as thread safe. For arrays, the element type's parser must be
+	// thread safe too. FProperty::ImportText, the fallback when there's no parser, is never considered thread safe.
+	bool IsThreadSafe(const FProperty& Property) const;
+
+private:
+	struct FParser
+	{
+		FPMXlsxImporterParseFunction Function = nullptr;
+		FPMXlsxImporterParseCellFunction CellFunction = nullptr;
+		bool bThreadSafe = false;
+	};
+
+	FPMXlsxImporterParserRegistry();
+
+	const FParser* FindParser(const FProperty& Property) const;
+	static const FParser* FindInClassHierarchy(const TMap<FFieldClass*, FParser>& Parsers, FFieldClass* PropertyClass);
+
+	TMap<FFieldClass*, FParser> PropertyParsers;
+	TMap<const UScriptStruct*, FParser> StructParsers;
+	TMap<FFieldClass*, FParser> EnumParsers;
+};
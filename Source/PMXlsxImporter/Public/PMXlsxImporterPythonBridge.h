@@ -1,39 +1,123 @@
-// Copyright 2022 Proletariat, Inc.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "PMXlsxImporterPythonBridge.generated.h"
-
-USTRUCT(Blueprintable, BlueprintType)
-struct FPMXlsxImporterPythonBridgeDataAssetInfo
-{
-	GENERATED_BODY()
-
-public:
-	UPROPERTY(BlueprintReadWrite, Category = XlsxImporter)
-	FString AssetName;
-
-	// Map of header to value for that data
-	UPROPERTY(BlueprintReadWrite, Category = XlsxImporter)
-	TMap<FString, FString> Data;
-};
-
-UCLASS(Blueprintable)
-class UPMXlsxImporterPythonBridge : public UObject
-{
-	GENERATED_BODY()
-
-public:
-
-	// Returns the Python subclass of UPMXlsxImporterPythonBridge which contains all of the
-	// UFUNCTION(BlueprintImplementableEvent)s that have been implemented in Python
-	// See https://forums.unrealengine.com/t/running-a-python-script-with-c/114117/3
-	static UPMXlsxImporterPythonBridge* Get();
-
-	UFUNCTION(BlueprintImplementableEvent, Category = Python)
-	TArray<FString> ReadWorksheetNames(const FString& AbsoluteFilePath);
-
-	UFUNCTION(BlueprintImplementableEvent, Category = Python)
-	TArray<FPMXlsxImporterPythonBridgeDataAssetInfo> ReadWorksheet(const FString& AbsoluteFilePath, const FString& WorksheetName);
-};
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Optional.h"
+#include "PMXlsxImporterPythonBridge.generated.h"
+
+class FPMXlsxImporterWorksheet;
+
+UENUM(BlueprintType)
+enum class EPMXlsxImporterCellType : uint8
+{
+	Empty,
+	Number,
+	Bool,
+	String,
+	DateTime,
+	// Formula errors such as #DIV/0!
+	Error,
+};
+
+// Typed value of one cell, so that numbers, booleans and dates can be parsed without going through a string.
+// Strings and the text of error cells are only stored in FPMXlsxImporterPythonBridgeDataAssetInfo::Data.
+USTRUCT(BlueprintType)
+struct FPMXlsxImporterPythonBridgeCell
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadWrite, Category = XlsxImporter)
+	EPMXlsxImporterCellType Type = EPMXlsxImporterCellType::Empty;
+
+	// Set for Number cells, and to 1 or 0 for Bool cells
+	UPROPERTY(BlueprintReadWrite, Category = XlsxImporter)
+	double Number = 0.0;
+
+	// Set for DateTime cells
+	UPROPERTY(BlueprintReadWrite, Category = XlsxImporter)
+	FDateTime DateTime;
+};
+
+USTRUCT(Blueprintable, BlueprintType)
+struct FPMXlsxImporterPythonBridgeDataAssetInfo
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadWrite, Category = XlsxImporter)
+	FString AssetName;
+
+	// Map of header to value for that data
+	UPROPERTY(BlueprintReadWrite, Category = XlsxImporter)
+	TMap<FString, FString> Data;
+
+	// Map of header to the typed value of that data. Headers missing from Cells are parsed from their string in Data.
+	UPROPERTY(BlueprintReadWrite, Category = XlsxImporter)
+	TMap<FString, FPMXlsxImporterPythonBridgeCell> Cells;
+};
+
+USTRUCT(Blueprintable, BlueprintType)
+struct FPMXlsxImporterPythonBridgeWorksheet
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadWrite, Category = XlsxImporter)
+	FString WorksheetName;
+
+	UPROPERTY(BlueprintReadWrite, Category = XlsxImporter)
+	TArray<FPMXlsxImporterPythonBridgeDataAssetInfo> Rows;
+};
+
+// Reads XLSX files. This class implements each function natively in C++. The Python subclass in
+// Content/Python/init_unreal.py overrides them with openpyxl-based implementations.
+UCLASS(Blueprintable)
+class UPMXlsxImporterPythonBridge : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	// Returns the object to read XLSX files with: this class's CDO if UPMXlsxImporterSettings::bUseNativeReader is set,
+	// otherwise the Python subclass of UPMXlsxImporterPythonBridge which contains all of the
+	// UFUNCTION(BlueprintNativeEvent)s that have been implemented in Python
+	// See https://forums.unrealengine.com/t/running-a-python-script-with-c/114117/3
+	static UPMXlsxImporterPythonBridge* Get();
+
+	UFUNCTION(BlueprintNativeEvent, Category = Python)
+	TArray<FString> ReadWorksheetNames(const FString& AbsoluteFilePath);
+
+	UFUNCTION(BlueprintNativeEvent, Category = Python)
+	TArray<FPMXlsxImporterPythonBridgeDataAssetInfo> ReadWorksheet(const FString& AbsoluteFilePath, const FString& WorksheetName);
+
+	// Same as ReadWorksheet, but reads several worksheets while only opening the file once.
+	// Worksheets that can't be read are left out of the result.
+	UFUNCTION(BlueprintNativeEvent, Category = Python)
+	TArray<FPMXlsxImporterPythonBridgeWorksheet> ReadWorksheets(const FString& AbsoluteFilePath, const TArray<FString>& WorksheetNames);
+
+	// Same as ReadWorksheet and ReadWorksheets, but return FPMXlsxImporterWorksheets, which is what the importer uses.
+	// The native reader reads straight into them. Rows returned by the Python implementation are converted.
+	// ReadColumnarWorksheet returns null if the native reader can't read the worksheet and there's no Python
+	// implementation to fall back on, so that a failed read can't be mistaken for an empty worksheet.
+	TSharedPtr<FPMXlsxImporterWorksheet> ReadColumnarWorksheet(const FString& AbsoluteFilePath, const FString& WorksheetName);
+	TArray<TSharedRef<FPMXlsxImporterWorksheet>> ReadColumnarWorksheets(const FString& AbsoluteFilePath, const TArray<FString>& WorksheetNames);
+
+protected:
+	// Native implementations. If the native reader can't read a file, these fall back on the Python implementation.
+	virtual TArray<FString> ReadWorksheetNames_Implementation(const FString& AbsoluteFilePath);
+	virtual TArray<FPMXlsxImporterPythonBridgeDataAssetInfo> ReadWorksheet_Implementation(const FString& AbsoluteFilePath, const FString& WorksheetName);
+	virtual TArray<FPMXlsxImporterPythonBridgeWorksheet> ReadWorksheets_Implementation(const FString& AbsoluteFilePath, const TArray<FString>& WorksheetNames);
+
+private:
+	// Returns null if Python or openpyxl isn't available
+	static UPMXlsxImporterPythonBridge* GetPythonImplementation();
+
+	// Whether this is UPMXlsxImporterPythonBridge's CDO rather than a Python subclass
+	bool IsNative() const;
+
+	// Return null if the native reader can't read the file, without falling back on Python
+	static TSharedPtr<FPMXlsxImporterWorksheet> ReadWorksheetNatively(const FString& AbsoluteFilePath, const FString& WorksheetName);
+	static TOptional<TArray<TSharedRef<FPMXlsxImporterWorksheet>>> ReadWorksheetsNatively(const FString& AbsoluteFilePath, const TArray<FString>& WorksheetNames);
+};
@@ -0,0 +1,117 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXlsxImporterWorksheet.h"
+#include "PMXlsxImporterAssetSaver.h"
+#include "PMXlsxImporterImportState.h"
+#include "PMXlsxImporterStats.h"
+
+struct FPMXlsxImporterSettingsEntry;
+struct FFileStatData;
+class FPMXlsxImporterPrimaryAssetSnapshot;
+
+// State shared by the SyncAssets, ParseData and Validate phases of a single import run.
+// Create one per run (see UPMXlsxImporterSettings::ImportAll) so that nothing is cached across runs.
+class PMXLSXIMPORTER_API FPMXlsxImporterSession
+{
+public:
+	// If bInFullImport is true, every row is imported even if it hasn't changed since the last successful run.
+	// If InStreamingBatchSize isn't 0, worksheets are imported that many rows at a time. See UPMXlsxImporterSettings::bStreamingImport.
+	explicit FPMXlsxImporterSession(bool bInFullImport = false, int32 InStreamingBatchSize = 0);
+	~FPMXlsxImporterSession();
+
+	// Returns the parsed worksheet. The file is only read the first time a worksheet is requested, or if it has
+	// changed on disk since then. Returns null if there is no python bridge to read it with, or if it couldn't be read.
+	// Callers must treat null as a failure: an empty worksheet would make SyncAssets delete every asset it made.
+	TSharedPtr<const FPMXlsxImporterWorksheet> ReadWorksheet(const FString& XlsxAbsolutePath, const FString& WorksheetName);
+
+	// Reads every worksheet used by Entries into the cache. Entries are grouped by XLSX file so that each file is only
+	// opened (and its shared strings only decoded) once, no matter how many entries use it.
+	void ReadWorkbooks(const TArray<const FPMXlsxImporterSettingsEntry*>& Entries);
+
+	// 0 unless worksheets are imported a batch of rows at a time
+	int32 GetStreamingBatchSize() const
+	{
+		return StreamingBatchSize;
+	}
+
+	bool IsStreaming() const
+	{
+		return StreamingBatchSize > 0;
+	}
+
+	// Assets modified by ParseData, checked out and saved together once every entry has been parsed, or once per batch
+	// when streaming
+	FPMXlsxImporterAssetSaver& GetAssetSaver()
+	{
+		return AssetSaver;
+	}
+
+	FPMXlsxImporterStats& GetStats()
+	{
+		return Stats;
+	}
+
+	// Returns a snapshot of UAssetManager's primary asset types and ids for validating on worker threads, taking it
+	// the first time it's needed. Game thread only.
+	const FPMXlsxImporterPrimaryAssetSnapshot& GetPrimaryAssetSnapshot();
+
+	// Returns the entries whose worksheet, shared strings or target class changed since the last successful import.
+	// Worksheets are compared using the zip central directory, so nothing is inflated. Full imports return Entries.
+	TArray<const FPMXlsxImporterSettingsEntry*> FindChangedEntries(const TArray<const FPMXlsxImporterSettingsEntry*>& Entries);
+
+	// Returns whether the row with RowHash was imported into AssetName by the last successful run, into a class with
+	// the same layout. Always false for full imports.
+	bool IsRowUnchanged(const FString& EntryKey, uint64 LayoutHash, const FString& AssetName, uint64 RowHash) const;
+	// Records that the row with RowHash was imported into AssetName, or skipped because it was unchanged.
+	// Every row of an entry must be recorded, or the missing rows will be imported again next time.
+	void RecordRow(const FString& EntryKey, uint64 LayoutHash, const FString& AssetName, uint64 RowHash);
+	// Makes sure the next IsRowUnchanged for AssetName returns false, e.g. because the asset was just created
+	void ForgetRow(const FString& EntryKey, const FString& AssetName);
+
+	// Saves the rows recorded this run on top of the state of previous runs.
+	// Only call this if the run succeeded, otherwise rows that failed to import would be skipped next time.
+	void SaveImportState();
+
+private:
+	struct FWorksheetKey
+	{
+		FString XlsxAbsolutePath;
+		FString WorksheetName;
+		FDateTime ModificationTime;
+		int64 FileSize = 0;
+
+		bool operator==(const FWorksheetKey& Other) const
+		{
+			return XlsxAbsolutePath == Other.XlsxAbsolutePath &&
+				WorksheetName == Other.WorksheetName &&
+				ModificationTime == Other.ModificationTime &&
+				FileSize == Other.FileSize;
+		}
+
+		friend uint32 GetTypeHash(const FWorksheetKey& Key)
+		{
+			return HashCombine(HashCombine(GetTypeHash(Key.XlsxAbsolutePath), GetTypeHash(Key.WorksheetName)), GetTypeHash(Key.ModificationTime));
+		}
+	};
+
+	static FWorksheetKey MakeWorksheetKey(const FString& XlsxAbsolutePath, const FString& WorksheetName, const FFileStatData& StatData);
+
+	TMap<FWorksheetKey, TSharedPtr<const FPMXlsxImporterWorksheet>> ParsedWorksheets;
+
+	FPMXlsxImporterAssetSaver AssetSaver;
+
+	FPMXlsxImporterStats Stats;
+
+	// Taken after SyncAssets has rescanned every output dir, when the first parallel validation starts
+	TUniquePtr<FPMXlsxImporterPrimaryAssetSnapshot> PrimaryAssetSnapshot;
+
+	bool bFullImport;
+	int32 StreamingBatchSize;
+	// Loaded from disk when the session is created
+	FPMXlsxImporterImportState PreviousImportState;
+	// Rows recorded during this run
+	FPMXlsxImporterImportState CurrentImportState;
+};
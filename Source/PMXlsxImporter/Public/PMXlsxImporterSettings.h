@@ -1,48 +1,79 @@
-// Copyright 2022 Proletariat, Inc.
-
-#pragma once
-
-#include "Engine/DeveloperSettings.h"
-#include "PMXlsxImporterSettingsEntry.h"
-#include "PMXlsxImporterContextLogger.h"
-#include "PMXlsxImporterSettings.generated.h"
-
-UCLASS(config = Plugins, defaultconfig, DisplayName="XLSX Import Settings")
-class PMXLSXIMPORTER_API UPMXlsxImporterSettings : public UDeveloperSettings
-{
-	GENERATED_BODY()
-
-public:
-	virtual FName GetCategoryName() const override { return TEXT("Plugins"); }
-	virtual FName GetSectionName() const override { return TEXT("XLSX Import"); }
-#if WITH_EDITOR
-	virtual FText GetSectionText() const override { return FText::FromString(TEXT("XLSX Import")); }
-	virtual FText GetSectionDescription() const override { return FText::FromString(TEXT("Configure the XLSX importer plugin")); }
-
-	virtual void PostEditChangeChainProperty(struct FPropertyChangedChainEvent& PropertyChangedEvent) override;
-#endif
-
-	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter)
-	TArray<FPMXlsxImporterSettingsEntry> AssetImportSettings;
-
-	// While importing, up to this many errors will be accumulated and reported before stopping the import process
-	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter)
-	int32 MaxErrors = 100;
-
-	void ImportCheckedOut(FPMXlsxImporterContextLogger& InOutErrors) const;
-	void ImportAll(FPMXlsxImporterContextLogger& InOutErrors) const;
-	void ImportEntry(int32 Index, FPMXlsxImporterContextLogger& InOutErrors) const;
-
-	// Unreal will call this function because FPMXlsxImporterSettingsEntry's WorksheetName UPROPERTY has the GetOptions meta tag
-	// We can't put this function on that struct because USTRUCTS can't have UFUNCTIONS, so instead it looks for this function
-	// on the struct's outer object (this)
-	UFUNCTION()
-	TArray<FString> GetWorksheetNames() const;
-
-private:
-#if WITH_EDITORONLY_DATA
-	// Save off the index of the last edited SettingEntry so that when it calls GetWorksheetNames(), we know which worksheet to read
-	int32 LastEditedSettingsIndex;
-#endif
-
-};
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "Engine/DeveloperSettings.h"
+#include "PMXlsxImporterSettingsEntry.h"
+#include "PMXlsxImporterContextLogger.h"
+#include "PMXlsxImporterSettings.generated.h"
+
+UCLASS(config = Plugins, defaultconfig, DisplayName="XLSX Import Settings")
+class PMXLSXIMPORTER_API UPMXlsxImporterSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	virtual FName GetCategoryName() const override { return TEXT("Plugins"); }
+	virtual FName GetSectionName() const override { return TEXT("XLSX Import"); }
+#if WITH_EDITOR
+	virtual FText GetSectionText() const override { return FText::FromString(TEXT("XLSX Import")); }
+	virtual FText GetSectionDescription() const override { return FText::FromString(TEXT("Configure the XLSX importer plugin")); }
+
+	virtual void PostEditChangeChainProperty(struct FPropertyChangedChainEvent& PropertyChangedEvent) override;
+#endif
+
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter)
+	TArray<FPMXlsxImporterSettingsEntry> AssetImportSettings;
+
+	// While importing, up to this many errors will be accumulated and reported before stopping the import process
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter)
+	int32 MaxErrors = 100;
+
+	// Read XLSX files with the plugin's native C++ reader instead of openpyxl. Files the native reader can't read
+	// still fall back on the Python implementation in Content/Python/init_unreal.py if openpyxl is installed.
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter)
+	bool bUseNativeReader = true;
+
+	// Skip rows that haven't changed since the last successful import. What was imported is remembered in
+	// Saved/PMXlsxImporter/. Turn this off, or pass -full to the commandlet, if assets were changed by hand and need
+	// to be imported again.
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter)
+	bool bIncrementalImport = true;
+
+	// Stop reading a worksheet after this many blank rows in a row. Formatting whole columns makes worksheets reach
+	// row 1,048,576, and this keeps those rows from being read. 0 reads every row. Blank rows never become assets.
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter, meta = (ClampMin = 0))
+	int32 MaxConsecutiveBlankRows = 1000;
+
+	// Import each worksheet StreamingImportBatchSize rows at a time: each batch is read, imported, saved and unloaded
+	// before the next one is read, so memory use doesn't grow with the size of the worksheet. Slower than importing
+	// everything at once, since each worksheet is read once per phase. Pass -streaming to the commandlet to turn this on
+	// for one run.
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter)
+	bool bStreamingImport = false;
+
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter, meta = (EditCondition = "bStreamingImport", ClampMin = 1))
+	int32 StreamingImportBatchSize = 1024;
+
+	// If bFullImport is true, every row is imported even if bIncrementalImport is set.
+	// A summary of the time spent per entry and phase is logged at the end of the run, and copied to OutStats if it isn't null.
+	void ImportCheckedOut(FPMXlsxImporterContextLogger& InOutErrors, bool bFullImport = false, FPMXlsxImporterStats* OutStats = nullptr) const;
+	void ImportAll(FPMXlsxImporterContextLogger& InOutErrors, bool bFullImport = false, FPMXlsxImporterStats* OutStats = nullptr) const;
+	void ImportEntry(int32 Index, FPMXlsxImporterContextLogger& InOutErrors, bool bFullImport = false, FPMXlsxImporterStats* OutStats = nullptr) const;
+
+	// Unreal will call this function because FPMXlsxImporterSettingsEntry's WorksheetName UPROPERTY has the GetOptions meta tag
+	// We can't put this function on that struct because USTRUCTS can't have UFUNCTIONS, so instead it looks for this function
+	// on the struct's outer object (this)
+	UFUNCTION()
+	TArray<FString> GetWorksheetNames() const;
+
+private:
+	// Runs each import phase over the entries in AllEntries that have changed since the last import
+	void Import(const TArray<const FPMXlsxImporterSettingsEntry*>& AllEntries, bool bFullImport, FPMXlsxImporterContextLogger& InOutErrors, FPMXlsxImporterStats* OutStats) const;
+
+#if WITH_EDITORONLY_DATA
+	// Save off the index of the last edited SettingEntry so that when it calls GetWorksheetNames(), we know which worksheet to read
+	int32 LastEditedSettingsIndex;
+#endif
+
+};
@@ -1,69 +1,88 @@
-// Copyright 2022 Proletariat, Inc.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "PMXlsxImporterPythonBridge.h"
-#include "PMXlsxImporterContextLogger.h"
-#include "SourceControlHelpers.h"
-#include "PMXlsxImporterSettingsEntry.generated.h"
-
-USTRUCT(BlueprintType)
-struct PMXLSXIMPORTER_API FPMXlsxImporterSettingsEntry
-{
-	GENERATED_BODY()
-
-public:
-	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter)
-	FPrimaryAssetType DataAssetType;
-
-	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter, meta = (RelativeToGameDir))
-	FFilePath XlsxFile;
-
-	// GetOptions calls GetWorksheetNames on this struct's outer UPMXlsxImporterSettings
-
-	// Due to limitations in Unreal's GetOptions metadata, the dropdown for this field
-	// may occasionally be incorrect. Change one of the settings in this entry to get it
-	// to fix itself.
-	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter, meta = (GetOptions="GetWorksheetNames"))
-	FString WorksheetName;
-
-	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter, meta = (RelativeToGameContentDir))
-	FDirectoryPath OutputDir;
-
-	// Create all autogenerated assets and also delete assets in the autogenerated folder that no longer exist
-	// Does not import data from xlsx, only the existence or absence of each asset.
-	// Data is imported in a separate step so that assets can be created, then point to each other.
-	// Stops if InOutErrors.Num() >= MaxErrors
-	void SyncAssets(FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const;
-
-	// Read XlsxFile and get each asset listed to parse its own data from strings
-	void ParseData(FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const;
-
-	// Get each asset in XlsxFile to check if it has been set up correctly.
-	// Do this after all asset data has been parsed in case validation of one DataAsset depends on another parsed DataAsset's data.
-	void Validate(FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const;
-
-	FSourceControlState GetXlsxFileSourceControlState(bool bSilent = false) const;
-
-#ifdef WITH_EDITOR
-	// This is a struct, not a UObject-derived class. This function is called by the owning UPMXlsxImporterSettings
-	// rather than directly from the Unreal editor.
-	void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent);
-#endif
-
-	TArray<FString> GetWorksheetNames() const;
-
-private:
-
-	// Gets a complete path in the format "C:/.../<ProjectName>/Content/<XlsxFile>"
-	FString GetXlsxAbsolutePath() const;
-
-	// Returns "/Game/<OutputDir>", which is the format required by UEditorAssetLibrary functions
-	FString GetProjectRootOutputDir() const;
-	// Returns "/Game/<OutputDir>/<AssetName>", which is the format required by UEditorAssetLibrary functions
-	FString GetProjectRootOutputPath(const FString& AssetName) const;
-
-	// AssetPath is from UEditorAssetLibrary::ListAssets, so format is "/Game/.../AssetName.AssetName"
-	bool ShouldAssetExist(const FString& AssetPath, const TArray<FPMXlsxImporterPythonBridgeDataAssetInfo>& ParsedWorksheet) const;
-};
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXlsxImporterPythonBridge.h"
+#include "PMXlsxImporterContextLogger.h"
+#include "PMXlsxImporterSession.h"
+#include "SourceControlHelpers.h"
+#include "PMXlsxImporterSettingsEntry.generated.h"
+
+struct FPMXlsxImporterParseDataRow;
+
+USTRUCT(BlueprintType)
+struct PMXLSXIMPORTER_API FPMXlsxImporterSettingsEntry
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter)
+	FPrimaryAssetType DataAssetType;
+
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter, meta = (RelativeToGameDir))
+	FFilePath XlsxFile;
+
+	// GetOptions calls GetWorksheetNames on this struct's outer UPMXlsxImporterSettings
+
+	// Due to limitations in Unreal's GetOptions metadata, the dropdown for this field
+	// may occasionally be incorrect. Change one of the settings in this entry to get it
+	// to fix itself.
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter, meta = (GetOptions="GetWorksheetNames"))
+	FString WorksheetName;
+
+	UPROPERTY(EditAnywhere, Config, Category = XlsxImporter, meta = (RelativeToGameContentDir))
+	FDirectoryPath OutputDir;
+
+	// Create all autogenerated assets and also delete assets in the autogenerated folder that no longer exist
+	// Does not import data from xlsx, only the existence or absence of each asset.
+	// Data is imported in a separate step so that assets can be created, then point to each other.
+	// Stops if InOutErrors.Num() >= MaxErrors
+	// All three phases read XlsxFile through Session, so it only gets parsed once per run. Streaming sessions read it
+	// again in each phase instead, one batch of rows at a time, releasing each batch's assets before the next.
+	void SyncAssets(FPMXlsxImporterSession& Session, FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const;
+
+	// Read XlsxFile and get each asset listed to parse its own data from strings.
+	// Rows that haven't changed since the last successful import are skipped unless Session is a full import.
+	// Streaming sessions check out and save each batch's assets before moving on to the next batch.
+	void ParseData(FPMXlsxImporterSession& Session, FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const;
+
+	// Get each asset in XlsxFile to check if it has been set up correctly.
+	// Do this after all asset data has been parsed in case validation of one DataAsset depends on another parsed DataAsset's data.
+	void Validate(FPMXlsxImporterSession& Session, FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors) const;
+
+	FSourceControlState GetXlsxFileSourceControlState(bool bSilent = false) const;
+
+#ifdef WITH_EDITOR
+	// This is a struct, not a UObject-derived class. This function is called by the owning UPMXlsxImporterSettings
+	// rather than directly from the Unreal editor.
+	void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent);
+#endif
+
+	TArray<FString> GetWorksheetNames() const;
+
+	// Gets a complete path in the format "C:/.../<ProjectName>/Content/<XlsxFile>"
+	FString GetXlsxAbsolutePath() const;
+
+	// Identifies this entry in FPMXlsxImporterImportState
+	FString GetImportStateKey() const;
+
+	// Identifies this entry in FPMXlsxImporterStats: "<XlsxFile>:<WorksheetName>"
+	FString GetStatsName() const;
+
+private:
+
+	// Returns "/Game/<OutputDir>", which is the format required by UEditorAssetLibrary functions
+	FString GetProjectRootOutputDir() const;
+	// Returns "/Game/<OutputDir>/<AssetName>", which is the format required by UEditorAssetLibrary functions
+	FString GetProjectRootOutputPath(const FString& AssetName) const;
+
+	// Parses every row in Batch that can be parsed on worker threads in parallel, then imports each row into its
+	// asset on the game thread, in order, so that errors are logged in the same order as a serial import.
+	// Returns false if InOutErrors reached MaxErrors.
+	static bool ParseDataBatch(FPMXlsxImporterSession& Session, TArray<FPMXlsxImporterParseDataRow>& Batch, FPMXlsxImporterContextLogger& InOutErrors, int32 MaxErrors);
+
+	// AssetPath is from UEditorAssetLibrary::ListAssets, so format is "/Game/.../AssetName.AssetName"
+	// AssetNames is the name of every asset in the worksheet
+	bool ShouldAssetExist(const FString& AssetPath, const TSet<FString>& AssetNames) const;
+};
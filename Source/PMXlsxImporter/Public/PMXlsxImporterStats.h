@@ -0,0 +1,75 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EPMXlsxImporterPhase : uint8
+{
+	ReadWorkbook,
+	SyncAssets,
+	// Part of SyncAssets, so it's left out of totals
+	ScanAssetRegistry,
+	ParseData,
+	CheckOut,
+	Save,
+	Validate,
+	Num,
+};
+
+// Time spent in each phase of an import run and how much was imported, per entry. Printed at the end of each run and
+// written as CSV by the commandlet's -stats switch. Game thread only.
+class PMXLSXIMPORTER_API FPMXlsxImporterStats
+{
+public:
+	struct FRow
+	{
+		// "Workbook:Worksheet" for an entry, the workbook's path for reading it, or empty for phases that only run
+		// once per run (CheckOut and Save)
+		FString Name;
+		double Seconds[(int32)EPMXlsxImporterPhase::Num] = {};
+		int64 NumRows = 0;
+		int64 NumCells = 0;
+		int64 NumBytesRead = 0;
+		int64 NumAssetsSaved = 0;
+
+		// Sum of every phase except the ones nested in another phase
+		double GetTotalSeconds() const;
+	};
+
+	// Adds the time between construction and destruction to Phase in Stats' row Name. Does nothing if Stats is null.
+	class PMXLSXIMPORTER_API FScopedTimer
+	{
+	public:
+		FScopedTimer(FPMXlsxImporterStats* InStats, EPMXlsxImporterPhase InPhase, const FString& InName);
+		~FScopedTimer();
+
+	private:
+		FPMXlsxImporterStats* Stats;
+		EPMXlsxImporterPhase Phase;
+		FString Name;
+		double StartTime;
+	};
+
+	FRow& FindOrAddRow(const FString& Name);
+
+	const TArray<FRow>& GetRows() const
+	{
+		return Rows;
+	}
+
+	// Sum of every row
+	FRow GetTotals() const;
+
+	// Logs a table with one line per row, then totals
+	void LogSummary() const;
+
+	// Same columns as LogSummary, times in seconds
+	FString ToCsv() const;
+	bool WriteCsv(const FString& FilePath) const;
+
+	static const TCHAR* GetPhaseName(EPMXlsxImporterPhase Phase);
+
+private:
+	TArray<FRow> Rows;
+};
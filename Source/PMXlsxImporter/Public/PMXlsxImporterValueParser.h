@@ -0,0 +1,33 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+// Parsers for the numbers and dates cells are written as, working on views so that nothing is copied or allocated.
+// Each one only accepts the common forms it can parse exactly, ignoring whitespace around them, and returns false for
+// anything else. Callers then fall back on the engine's parsers, so every value parses to the same bits either way.
+class PMXLSXIMPORTER_API FPMXlsxImporterValueParser
+{
+public:
+	// Decimal integers, e.g. "-42". Integral numbers with a fraction or exponent, e.g. "2.0" or "1.5E3", are parsed
+	// by ParseDouble then converted, like UPMXlsxDataAsset::ParseInt64Internal. Integers with leading zeros are left
+	// to FDefaultValueHelper::ParseInt64, which reads them as octal.
+	static bool ParseInt64(FStringView Value, int64& OutResult);
+
+	// Decimal numbers with an optional fraction and exponent, e.g. "-1.25E-3". Only accepts numbers whose digits and
+	// exponent are small enough to be converted with a single correctly rounded multiplication or division, so the
+	// result is always the same as FCString::Atod's.
+	static bool ParseDouble(FStringView Value, double& OutResult);
+
+	// "YYYY-MM-DD", optionally followed by "THH:MM:SS", up to 3 digits of milliseconds and "Z". Dates with a time zone
+	// offset are left to FDateTime::ParseIso8601.
+	static bool ParseIso8601(FStringView Value, FDateTime& OutResult);
+
+	// Excel serial dates in the 1900 date system, e.g. "44927.5", which is 2023-01-01 12:00
+	static bool ParseSerialDate(FStringView Value, FDateTime& OutResult);
+
+	// Days since 1899-12-30, or 1904-01-01 if bDate1904, rounded to the millisecond. Serial must be in [0, 2958466).
+	static FDateTime SerialToDateTime(double Serial, bool bDate1904);
+};
@@ -0,0 +1,135 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+#include "PMXlsxImporterPythonBridge.h"
+
+// One worksheet as read by the native or Python reader. The first row of the file is the headers, and every row after
+// that is one entry named after its "Name" column.
+// Headers are stored once and cells are looked up by row and column index. Cells are stored row-major in one array,
+// and every string value is stored in one shared buffer, so a worksheet costs a handful of allocations no matter how
+// many rows and columns it has.
+class PMXLSXIMPORTER_API FPMXlsxImporterWorksheet
+{
+public:
+	// A string in the worksheet's string buffer. The same string can be used by any number of cells.
+	struct FStringRef
+	{
+		int32 Offset = 0;
+		int32 Len = 0;
+	};
+
+	explicit FPMXlsxImporterWorksheet(const FString& InName);
+
+	// Converts rows returned by UPMXlsxImporterPythonBridge's Blueprint/Python interface. Columns are every header
+	// used by any row, in the order they first appear.
+	static TSharedRef<FPMXlsxImporterWorksheet> FromRows(const FString& Name, const TArray<FPMXlsxImporterPythonBridgeDataAssetInfo>& Rows);
+	// The reverse of FromRows
+	void ToRows(TArray<FPMXlsxImporterPythonBridgeDataAssetInfo>& OutRows) const;
+
+	// Must be called once, before any rows are added. Empty headers keep their column so that indices match the file,
+	// but FindColumn can't find them and they're left out of value maps.
+	void SetHeaders(TArray<FString>&& InHeaders);
+	// Adds a row with every cell empty and returns its index
+	int32 AddRow();
+	FStringRef AddString(const TCHAR* Chars, int32 Len);
+	FStringRef AddString(const FString& String)
+	{
+		return AddString(*String, String.Len());
+	}
+	// Column must be less than GetNumColumns()
+	void SetCell(int32 Row, int32 Column, FStringRef String, const FPMXlsxImporterPythonBridgeCell& Cell);
+	// Frees the slack left over from adding rows and strings
+	void Shrink();
+	// Removes every row and string but keeps the headers and the memory already allocated, so that the next batch of
+	// rows can be read into this worksheet
+	void ResetRows();
+
+	const FString& GetName() const
+	{
+		return Name;
+	}
+
+	const TArray<FString>& GetHeaders() const
+	{
+		return Headers;
+	}
+
+	int32 GetNumRows() const
+	{
+		return NumRows;
+	}
+
+	int32 GetNumColumns() const
+	{
+		return Headers.Num();
+	}
+
+	// Returns INDEX_NONE if no column has Header
+	int32 FindColumn(const FString& Header) const
+	{
+		return FindColumnByHash(GetTypeHash(Header), Header);
+	}
+	// HeaderHash must be GetTypeHash(Header)
+	int32 FindColumnByHash(uint32 HeaderHash, const FString& Header) const;
+
+	// Valid for as long as this worksheet is
+	FStringView GetValue(int32 Row, int32 Column) const
+	{
+		const FCell& Cell = Cells[Row * Headers.Num() + Column];
+		return FStringView(Strings.GetData() + Cell.StringOffset, Cell.StringLen);
+	}
+
+	FStringView GetString(FStringRef String) const
+	{
+		return FStringView(Strings.GetData() + String.Offset, String.Len);
+	}
+
+	// Replaces OutValue's contents without reallocating it if it's big enough
+	void CopyValue(int32 Row, int32 Column, FString& OutValue) const;
+
+	FPMXlsxImporterPythonBridgeCell GetCell(int32 Row, int32 Column) const;
+
+	// Value of the row's "Name" column
+	FString GetAssetName(int32 Row) const;
+
+	// Builds the header -> value map that UPMXlsxDataAsset::ImportFromXLSXImpl takes
+	void MakeValueMap(int32 Row, TMap<FString, FString>& OutValues) const;
+
+	// Hash of each (header, value) pair in the row, in column order. See FPMXlsxImporterImportState.
+	uint64 HashRow(int32 Row) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FCell
+	{
+		FCell()
+			: Number(0.0)
+		{
+		}
+
+		int32 StringOffset = 0;
+		int32 StringLen = 0;
+		// Number for Number and Bool cells, FDateTime ticks for DateTime cells
+		union
+		{
+			double Number;
+			int64 Ticks;
+		};
+		EPMXlsxImporterCellType Type = EPMXlsxImporterCellType::Empty;
+	};
+
+	FString Name;
+	TArray<FString> Headers;
+	// Header -> column index, without empty headers
+	TMap<FString, int32> Columns;
+	int32 NameColumn = INDEX_NONE;
+
+	int32 NumRows = 0;
+	// Row-major. Row * Headers.Num() + Column.
+	TArray<FCell> Cells;
+	TArray<TCHAR> Strings;
+};
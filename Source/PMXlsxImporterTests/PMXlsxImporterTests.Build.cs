@@ -0,0 +1,32 @@
+// Copyright 2022 Proletariat, Inc.
+
+using UnrealBuildTool;
+
+// Benchmarks and automation tests for PMXlsxImporter. Kept out of the main module so that their classes don't show up
+// in projects that use the plugin.
+public class PMXlsxImporterTests : ModuleRules
+{
+    public PMXlsxImporterTests(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+		bEnforceIWYU = true;
+
+        PrivateDependencyModuleNames.AddRange(
+            new string[]
+            {
+                "Core",
+                "CoreUObject",
+                "Engine",
+                "UnrealEd",
+                "EditorScriptingUtilities",
+				"GameplayTags",
+				"SlateCore",
+				"SourceControl",
+				"PMXlsxImporter"
+			}
+            );
+
+        // Used to write the generated workbooks
+        AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
+    }
+}
@@ -0,0 +1,308 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterAssetSaver.h"
+#include "PMXlsxImporterStats.h"
+#include "PMXlsxImporterTestDataAssets.h"
+#include "ISourceControlProvider.h"
+#include "ISourceControlState.h"
+#include "SourceControlHelpers.h"
+#include "SourceControlOperations.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#if SOURCE_CONTROL_WITH_SLATE
+#include "Widgets/SNullWidget.h"
+#endif
+#if ENGINE_MAJOR_VERSION == 5
+#include "Textures/SlateIcon.h"
+#endif
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const int32 TEST_FLAGS = EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter;
+
+static const FString TEST_WORKBOOK = TEXT("Test.xlsx");
+static const FString TEST_WORKSHEET = TEXT("Test");
+
+// State of one file in FPMXlsxImporterTestSourceControlProvider. Every file is under source control.
+class FPMXlsxImporterTestSourceControlState : public ISourceControlState
+{
+public:
+	explicit FPMXlsxImporterTestSourceControlState(const FString& InFilename)
+		: Filename(InFilename)
+	{
+	}
+
+	FString Filename;
+	bool bCheckedOut = false;
+	// Set if someone else has the file checked out
+	FString CheckedOutBy;
+
+	// ISourceControlState interface
+	virtual int32 GetHistorySize() const override { return 0; }
+	virtual TSharedPtr<ISourceControlRevision, ESPMode::ThreadSafe> GetHistoryItem(int32 HistoryIndex) const override { return nullptr; }
+	virtual TSharedPtr<ISourceControlRevision, ESPMode::ThreadSafe> FindHistoryRevision(int32 RevisionNumber) const override { return nullptr; }
+	virtual TSharedPtr<ISourceControlRevision, ESPMode::ThreadSafe> FindHistoryRevision(const FString& InRevision) const override { return nullptr; }
+	virtual TSharedPtr<ISourceControlRevision, ESPMode::ThreadSafe> GetBaseRevForMerge() const override { return nullptr; }
+#if ENGINE_MAJOR_VERSION == 4
+	virtual FName GetIconName() const override { return NAME_None; }
+	virtual FName GetSmallIconName() const override { return NAME_None; }
+#elif ENGINE_MAJOR_VERSION == 5
+	virtual FSlateIcon GetIcon() const override { return FSlateIcon(); }
+#endif
+	virtual FText GetDisplayName() const override { return FText::GetEmpty(); }
+	virtual FText GetDisplayTooltip() const override { return FText::GetEmpty(); }
+	virtual const FString& GetFilename() const override { return Filename; }
+	virtual const FDateTime& GetTimeStamp() const override { return TimeStamp; }
+	virtual bool CanCheckIn() const override { return bCheckedOut; }
+	virtual bool CanCheckout() const override { return !bCheckedOut && CheckedOutBy.IsEmpty(); }
+	virtual bool IsCheckedOut() const override { return bCheckedOut; }
+	virtual bool IsCheckedOutOther(FString* Who = nullptr) const override
+	{
+		if (Who != nullptr)
+		{
+			*Who = CheckedOutBy;
+		}
+		return !CheckedOutBy.IsEmpty();
+	}
+	virtual bool IsCheckedOutInOtherBranch(const FString& CurrentBranch = FString()) const override { return false; }
+	virtual bool IsModifiedInOtherBranch(const FString& CurrentBranch = FString()) const override { return false; }
+	virtual TArray<FString> GetCheckedOutBranches() const override { return TArray<FString>(); }
+	virtual FString GetOtherUserBranchCheckedOuts() const override { return FString(); }
+	virtual bool GetOtherBranchHeadModification(FString& HeadBranchOut, FString& ActionOut, int32& HeadChangeListOut) const override { return false; }
+	virtual bool IsCurrent() const override { return true; }
+	virtual bool IsSourceControlled() const override { return true; }
+	virtual bool IsAdded() const override { return false; }
+	virtual bool IsDeleted() const override { return false; }
+	virtual bool IsIgnored() const override { return false; }
+	virtual bool CanEdit() const override { return bCheckedOut; }
+	virtual bool CanDelete() const override { return bCheckedOut; }
+	virtual bool IsUnknown() const override { return false; }
+	virtual bool IsModified() const override { return false; }
+	virtual bool CanAdd() const override { return false; }
+	virtual bool IsConflicted() const override { return false; }
+	virtual bool CanRevert() const override { return bCheckedOut; }
+
+private:
+	FDateTime TimeStamp;
+};
+
+// Synchronous source control provider that keeps its state in memory and records every operation it executes, so that
+// FPMXlsxImporterAssetSaver can be tested without a server
+class FPMXlsxImporterTestSourceControlProvider : public ISourceControlProvider
+{
+public:
+	struct FExecutedOperation
+	{
+		FName Name;
+		TArray<FString> Files;
+	};
+
+	TArray<FExecutedOperation> ExecutedOperations;
+	// Files that stay checked in when FCheckOut is executed on them
+	TSet<FString> FilesThatFailCheckOut;
+
+	TSharedRef<FPMXlsxImporterTestSourceControlState, ESPMode::ThreadSafe> FindOrAddState(const FString& Filename)
+	{
+		if (const TSharedRef<FPMXlsxImporterTestSourceControlState, ESPMode::ThreadSafe>* State = States.Find(Filename))
+		{
+			return *State;
+		}
+		return States.Add(Filename, MakeShared<FPMXlsxImporterTestSourceControlState, ESPMode::ThreadSafe>(Filename));
+	}
+
+	// ISourceControlProvider interface
+	virtual void Init(bool bForceConnection = true) override {}
+	virtual void Close() override {}
+	virtual FText GetStatusText() const override { return FText::GetEmpty(); }
+	virtual bool IsEnabled() const override { return true; }
+	virtual bool IsAvailable() const override { return true; }
+	virtual const FName& GetName() const override { return Name; }
+	virtual bool QueryStateBranchConfig(const FString& ConfigSrc, const FString& ConfigDest) override { return false; }
+	virtual void RegisterStateBranches(const TArray<FString>& BranchNames, const FString& ContentRoot) override {}
+	virtual int32 GetStateBranchIndex(const FString& BranchName) const override { return INDEX_NONE; }
+
+	virtual ECommandResult::Type GetState(const TArray<FString>& InFiles, TArray<FSourceControlStateRef>& OutState, EStateCacheUsage::Type InStateCacheUsage) override
+	{
+		for (const FString& File : InFiles)
+		{
+			OutState.Add(FindOrAddState(File));
+		}
+		return ECommandResult::Succeeded;
+	}
+
+	virtual ECommandResult::Type GetState(const TArray<FSourceControlChangelistRef>& InChangelists, TArray<FSourceControlChangelistStateRef>& OutState, EStateCacheUsage::Type InStateCacheUsage) override
+	{
+		return ECommandResult::Failed;
+	}
+
+	virtual TArray<FSourceControlStateRef> GetCachedStateByPredicate(TFunctionRef<bool(const FSourceControlStateRef&)> Predicate) const override
+	{
+		TArray<FSourceControlStateRef> Result;
+		for (const TPair<FString, TSharedRef<FPMXlsxImporterTestSourceControlState, ESPMode::ThreadSafe>>& Pair : States)
+		{
+			const FSourceControlStateRef State = Pair.Value;
+			if (Predicate(State))
+			{
+				Result.Add(State);
+			}
+		}
+		return Result;
+	}
+
+	virtual FDelegateHandle RegisterSourceControlStateChanged_Handle(const FSourceControlStateChanged::FDelegate& SourceControlStateChanged) override { return FDelegateHandle(); }
+	virtual void UnregisterSourceControlStateChanged_Handle(FDelegateHandle Handle) override {}
+
+	virtual ECommandResult::Type Execute(const FSourceControlOperationRef& InOperation, FSourceControlChangelistPtr InChangelist, const TArray<FString>& InFiles, EConcurrency::Type InConcurrency = EConcurrency::Synchronous, const FSourceControlOperationComplete& InOperationCompleteDelegate = FSourceControlOperationComplete()) override
+	{
+		ExecutedOperations.Add({ InOperation->GetName(), InFiles });
+
+		ECommandResult::Type Result = ECommandResult::Succeeded;
+		if (InOperation->GetName() == TEXT("CheckOut"))
+		{
+			for (const FString& File : InFiles)
+			{
+				if (FilesThatFailCheckOut.Contains(File))
+				{
+					Result = ECommandResult::Failed;
+				}
+				else
+				{
+					FindOrAddState(File)->bCheckedOut = true;
+				}
+			}
+		}
+		InOperationCompleteDelegate.ExecuteIfBound(InOperation, Result);
+		return Result;
+	}
+
+	virtual bool CanCancelOperation(const FSourceControlOperationRef& InOperation) const override { return false; }
+	virtual void CancelOperation(const FSourceControlOperationRef& InOperation) override {}
+	virtual bool UsesLocalReadOnlyState() const override { return false; }
+	virtual bool UsesChangelists() const override { return false; }
+	virtual bool UsesCheckout() const override { return true; }
+	virtual void Tick() override {}
+	virtual TArray<TSharedRef<ISourceControlLabel>> GetLabels(const FString& InMatchingSpec) const override { return TArray<TSharedRef<ISourceControlLabel>>(); }
+	virtual TArray<FSourceControlChangelistRef> GetChangelists(EStateCacheUsage::Type InStateCacheUsage) override { return TArray<FSourceControlChangelistRef>(); }
+#if SOURCE_CONTROL_WITH_SLATE
+	virtual TSharedRef<SWidget> MakeSettingsWidget() const override { return SNullWidget::NullWidget; }
+#endif
+
+private:
+	FName Name = TEXT("PMXlsxImporterTest");
+	TMap<FString, TSharedRef<FPMXlsxImporterTestSourceControlState, ESPMode::ThreadSafe>> States;
+};
+
+// A standalone asset in its own new package under /Temp, which saves to the project's Saved directory
+static UPMXlsxImporterWasModifiedTestDataAsset* MakeTestAsset(const FString& Name)
+{
+	UPackage* Package = CreatePackage(*FString::Printf(TEXT("/Temp/PMXlsxImporterTests/%s"), *Name));
+	UPMXlsxImporterWasModifiedTestDataAsset* Asset = NewObject<UPMXlsxImporterWasModifiedTestDataAsset>(Package, *Name, RF_Public | RF_Standalone);
+	Package->MarkPackageDirty();
+	return Asset;
+}
+
+// Lets the assets made by MakeTestAsset be garbage collected, and deletes any files they were saved to
+static void DestroyTestAssets(const TArray<UPMXlsxImporterWasModifiedTestDataAsset*>& Assets)
+{
+	for (UPMXlsxImporterWasModifiedTestDataAsset* Asset : Assets)
+	{
+		UPackage* Package = Asset->GetOutermost();
+		Asset->ClearFlags(RF_Public | RF_Standalone);
+		Package->SetDirtyFlag(false);
+		IFileManager::Get().Delete(*SourceControlHelpers::PackageFilename(Package), /*RequireExists:*/ false, /*EvenReadOnly:*/ true);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPMXlsxImporterAssetSaverCheckOutFailureTest, "PMXlsxImporter.AssetSaver.CheckOutFailure", TEST_FLAGS)
+bool FPMXlsxImporterAssetSaverCheckOutFailureTest::RunTest(const FString& Parameters)
+{
+	FPMXlsxImporterTestSourceControlProvider Provider;
+	UPMXlsxImporterWasModifiedTestDataAsset* FailedAsset = MakeTestAsset(TEXT("CheckOutFailure_Failed"));
+	UPMXlsxImporterWasModifiedTestDataAsset* LockedAsset = MakeTestAsset(TEXT("CheckOutFailure_Locked"));
+	const FString FailedFilename = SourceControlHelpers::PackageFilename(FailedAsset->GetOutermost());
+	const FString LockedFilename = SourceControlHelpers::PackageFilename(LockedAsset->GetOutermost());
+	Provider.FilesThatFailCheckOut.Add(FailedFilename);
+	Provider.FindOrAddState(LockedFilename)->CheckedOutBy = TEXT("Someone");
+
+	FPMXlsxImporterAssetSaver Saver(Provider);
+	Saver.Add(*FailedAsset, TEST_WORKBOOK, TEST_WORKSHEET);
+	Saver.Add(*LockedAsset, TEST_WORKBOOK, TEST_WORKSHEET);
+	FPMXlsxImporterContextLogger Errors;
+	Saver.CheckOutAndSave(Errors);
+
+	// Every status is updated at once, and only the asset that could be checked out is
+	if (TestEqual(TEXT("Number of operations"), Provider.ExecutedOperations.Num(), 2))
+	{
+		TestTrue(TEXT("First operation is UpdateStatus"), Provider.ExecutedOperations[0].Name == TEXT("UpdateStatus"));
+		TestEqual(TEXT("Files updated"), Provider.ExecutedOperations[0].Files.Num(), 2);
+		TestTrue(TEXT("Second operation is CheckOut"), Provider.ExecutedOperations[1].Name == TEXT("CheckOut"));
+		TestTrue(TEXT("Only the failed asset is checked out"), Provider.ExecutedOperations[1].Files == TArray<FString>({ FailedFilename }));
+	}
+
+	// One error per asset, in the order they were added, with the asset's source
+	if (TestEqual(TEXT("Errors"), Errors.Num(), 2))
+	{
+		const TArray<FPMXlsxImporterErrorRecord>& Records = Errors.GetErrors();
+		for (int32 Index = 0; Index < Records.Num(); ++Index)
+		{
+			TestEqual(TEXT("Error workbook"), Records[Index].Workbook, TEST_WORKBOOK);
+			TestEqual(TEXT("Error worksheet"), Records[Index].Worksheet, TEST_WORKSHEET);
+		}
+		TestEqual(TEXT("Failed asset error asset"), Records[0].Asset, FailedAsset->GetPathName());
+		TestTrue(TEXT("Failed asset error message"), Records[0].Message.StartsWith(TEXT("Unable to checkout asset")));
+		TestEqual(TEXT("Locked asset error asset"), Records[1].Asset, LockedAsset->GetPathName());
+		TestTrue(TEXT("Locked asset error message"), Records[1].Message.Contains(TEXT("checked out by Someone")));
+	}
+
+	// Assets that couldn't be checked out aren't saved, and aren't tried again by the next call
+	TestTrue(TEXT("Failed asset is still dirty"), FailedAsset->GetOutermost()->IsDirty());
+	TestTrue(TEXT("Locked asset is still dirty"), LockedAsset->GetOutermost()->IsDirty());
+	TestEqual(TEXT("Assets left to save"), Saver.Num(), 0);
+
+	DestroyTestAssets({ FailedAsset, LockedAsset });
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPMXlsxImporterAssetSaverBatchedSaveTest, "PMXlsxImporter.AssetSaver.BatchedSave", TEST_FLAGS)
+bool FPMXlsxImporterAssetSaverBatchedSaveTest::RunTest(const FString& Parameters)
+{
+	FPMXlsxImporterTestSourceControlProvider Provider;
+	const TArray<UPMXlsxImporterWasModifiedTestDataAsset*> Assets = {
+		MakeTestAsset(TEXT("BatchedSave_0")),
+		MakeTestAsset(TEXT("BatchedSave_1")),
+		MakeTestAsset(TEXT("BatchedSave_2")),
+	};
+
+	FPMXlsxImporterAssetSaver Saver(Provider);
+	for (UPMXlsxImporterWasModifiedTestDataAsset* Asset : Assets)
+	{
+		Saver.Add(*Asset, TEST_WORKBOOK, TEST_WORKSHEET);
+	}
+	// Adding an asset twice doesn't check out or save its package twice
+	Saver.Add(*Assets[0], TEST_WORKBOOK, TEST_WORKSHEET);
+
+	FPMXlsxImporterContextLogger Errors;
+	FPMXlsxImporterStats Stats;
+	Saver.CheckOutAndSave(Errors, &Stats);
+
+	TestEqual(TEXT("Errors"), Errors.Num(), 0);
+	if (TestEqual(TEXT("Number of operations"), Provider.ExecutedOperations.Num(), 2))
+	{
+		TestTrue(TEXT("First operation is UpdateStatus"), Provider.ExecutedOperations[0].Name == TEXT("UpdateStatus"));
+		TestEqual(TEXT("Files updated"), Provider.ExecutedOperations[0].Files.Num(), Assets.Num());
+		TestTrue(TEXT("Second operation is CheckOut"), Provider.ExecutedOperations[1].Name == TEXT("CheckOut"));
+		TestEqual(TEXT("Files checked out"), Provider.ExecutedOperations[1].Files.Num(), Assets.Num());
+	}
+
+	TestEqual(TEXT("Assets saved"), Stats.GetTotals().NumAssetsSaved, (int64)Assets.Num());
+	for (UPMXlsxImporterWasModifiedTestDataAsset* Asset : Assets)
+	{
+		TestFalse(TEXT("Saved package is dirty"), Asset->GetOutermost()->IsDirty());
+		TestTrue(TEXT("Saved package exists"), IFileManager::Get().FileExists(*SourceControlHelpers::PackageFilename(Asset->GetOutermost())));
+	}
+
+	DestroyTestAssets(Assets);
+	return true;
+}
+
+#endif
@@ -0,0 +1,252 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterBenchmarkCommandlet.h"
+#include "PMXlsxImporterBenchmarkDataAsset.h"
+#include "PMXlsxImporterBenchmarkWorkbook.h"
+#include "PMXlsxImporterCountingMalloc.h"
+#include "PMXlsxImporterSettings.h"
+#include "PMXlsxImporterSettingsEntry.h"
+#include "PMXlsxImporterSession.h"
+#include "PMXlsxImporterStats.h"
+#include "PMXlsxImporterTestsLog.h"
+#include "EditorAssetLibrary.h"
+#include "Engine/AssetManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+
+static const TCHAR* const BENCHMARK_DIRECTORY = TEXT("PMXlsxImporterBenchmark");
+
+// Runs the same phases as UPMXlsxImporterSettings::Import on a single entry, without loading or saving import state
+static bool ImportBenchmarkEntry(const FPMXlsxImporterSettingsEntry& Entry, FPMXlsxImporterStats& OutStats, int32& OutNumErrors)
+{
+	const int32 MaxErrors = GetDefault<UPMXlsxImporterSettings>()->MaxErrors;
+	FPMXlsxImporterContextLogger Errors;
+	FPMXlsxImporterSession Session(/*bInFullImport:*/ true);
+
+	const TArray<const FPMXlsxImporterSettingsEntry*> Entries = { &Entry };
+	Session.ReadWorkbooks(Entries);
+	Entry.SyncAssets(Session, Errors, MaxErrors);
+	if (Errors.Num() < MaxErrors)
+	{
+		Entry.ParseData(Session, Errors, MaxErrors);
+	}
+	Session.GetAssetSaver().CheckOutAndSave(Errors, &Session.GetStats());
+	if (Errors.Num() < MaxErrors)
+	{
+		Entry.Validate(Session, Errors, MaxErrors);
+	}
+
+	Errors.Flush();
+	OutStats = Session.GetStats();
+	OutNumErrors = Errors.Num();
+	return OutNumErrors == 0;
+}
+
+// Times each kernel on its own and counts the allocations it makes, without reading workbooks or touching assets.
+// Whether each kernel parses the values it's given correctly is checked by the PMXlsxImporter.Benchmark automation
+// tests. Returns 1 if the results couldn't be written, 0 otherwise.
+static int32 BenchmarkKernels(int32 NumCells, int32 ArrayLength, int32 Seed, const FString& OutputPath)
+{
+	// Errors are logged in batches so that failing kernels don't collect every error in one huge array
+	const int32 BATCH_SIZE = 1024;
+
+	UPMXlsxImporterBenchmarkDataAsset* Asset = NewObject<UPMXlsxImporterBenchmarkDataAsset>();
+	FPMXlsxImporterCountingMalloc& CountingMalloc = FPMXlsxImporterCountingMalloc::Get();
+	FRandomStream Random(Seed);
+
+	FString Csv = TEXT("Kernel,Cells,Parsed,Seconds,NsPerCell,AllocationsPerCell\n");
+	UE_LOG(LogPMXlsxImporterTests, Display, TEXT("%-26s %10s %10s %12s %14s"), TEXT("Kernel"), TEXT("Cells"), TEXT("Parsed"), TEXT("ns/cell"), TEXT("allocs/cell"));
+	TArray<TArray<FString>> Batches;
+	FStructProperty* PreviousStructProperty = nullptr;
+	for (int32 KernelIndex = 0; KernelIndex < (int32)EPMXlsxImporterBenchmarkKernel::Num; ++KernelIndex)
+	{
+		const EPMXlsxImporterBenchmarkKernel Kernel = (EPMXlsxImporterBenchmarkKernel)KernelIndex;
+		// Each ImportText kernel parses the same values as the struct kernel before it
+		FStructProperty* StructProperty = Asset->GetStructKernelProperty(Kernel);
+		const bool bImportTextKernel = StructProperty != nullptr && StructProperty == PreviousStructProperty;
+		PreviousStructProperty = StructProperty;
+		if (!bImportTextKernel)
+		{
+			Batches.Reset();
+			for (int32 Start = 0; Start < NumCells; Start += BATCH_SIZE)
+			{
+				UPMXlsxImporterBenchmarkDataAsset::GenerateKernelValues(Kernel, FMath::Min(BATCH_SIZE, NumCells - Start), ArrayLength, Random, Batches.AddDefaulted_GetRef());
+			}
+		}
+
+		// Warm up caches, FName tables and the localization manager before measuring
+		{
+			FPMXlsxImporterContextLogger WarmUpErrors;
+			Asset->RunKernel(Kernel, Batches[0], WarmUpErrors);
+		}
+
+		int32 NumParsed = 0;
+		CountingMalloc.Install();
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (const TArray<FString>& Batch : Batches)
+		{
+			FPMXlsxImporterContextLogger Errors;
+			NumParsed += Asset->RunKernel(Kernel, Batch, Errors);
+		}
+		const uint64 EndCycles = FPlatformTime::Cycles64();
+		CountingMalloc.Uninstall();
+
+		const double Seconds = FPlatformTime::ToSeconds64(EndCycles - StartCycles);
+		const double NsPerCell = Seconds * 1.0e9 / NumCells;
+		const double AllocationsPerCell = (double)CountingMalloc.GetNumAllocations() / NumCells;
+		const TCHAR* KernelName = UPMXlsxImporterBenchmarkDataAsset::GetKernelName(Kernel);
+		UE_LOG(LogPMXlsxImporterTests, Display, TEXT("%-26s %10i %10i %12.1f %14.2f"), KernelName, NumCells, NumParsed, NsPerCell, AllocationsPerCell);
+		Csv += FString::Printf(TEXT("%s,%i,%i,%.6f,%.1f,%.3f\n"), KernelName, NumCells, NumParsed, Seconds, NsPerCell, AllocationsPerCell);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		UE_LOG(LogPMXlsxImporterTests, Error, TEXT("Unable to write benchmark results to %s"), *OutputPath);
+		return 1;
+	}
+	UE_LOG(LogPMXlsxImporterTests, Display, TEXT("Wrote benchmark results to %s"), *OutputPath);
+	return 0;
+}
+
+int32 UPMXlsxImporterBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TCHAR* SERIAL_SWITCH = TEXT("serial");
+	const TCHAR* KEEP_SWITCH = TEXT("keep");
+	const TCHAR* KERNELS_SWITCH = TEXT("kernels");
+
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	ParseCommandLine(*Params, Tokens, Switches);
+
+	// From PythonScriptCommandlet.cpp: tick once to ensure that any start-up scripts have been run
+	FTicker::GetCoreTicker().Tick(0.0f);
+
+	TArray<int32> RowCounts = { 1000, 10000, 100000 };
+	FString RowCountsParam;
+	if (FParse::Value(*Params, TEXT("rows="), RowCountsParam, /*bShouldStopOnSeparator:*/ false))
+	{
+		TArray<FString> RowCountStrings;
+		RowCountsParam.ParseIntoArray(RowCountStrings, TEXT(","));
+		RowCounts.Reset();
+		for (const FString& RowCountString : RowCountStrings)
+		{
+			RowCounts.Add(FMath::Max(1, FCString::Atoi(*RowCountString)));
+		}
+	}
+
+	FPMXlsxImporterBenchmarkWorkbookOptions Options;
+	FParse::Value(*Params, TEXT("extracolumns="), Options.NumExtraColumns);
+	FParse::Value(*Params, TEXT("numeric="), Options.ExtraNumericRatio);
+	FParse::Value(*Params, TEXT("arraylength="), Options.ArrayLength);
+	FParse::Value(*Params, TEXT("shared="), Options.SharedStringRatio);
+	FParse::Value(*Params, TEXT("seed="), Options.Seed);
+
+	const bool bKernels = Switches.Contains(KERNELS_SWITCH);
+	FString OutputPath = FPaths::ProjectSavedDir() / BENCHMARK_DIRECTORY / (bKernels ? TEXT("Kernels.csv") : TEXT("Results.csv"));
+	FParse::Value(*Params, TEXT("output="), OutputPath);
+	OutputPath = FPaths::ConvertRelativePathToFull(OutputPath);
+
+	if (bKernels)
+	{
+		int32 NumCells = 100000;
+		FParse::Value(*Params, TEXT("cells="), NumCells);
+		// Longer than the import benchmark's arrays, so that ParseArray's per-element cost dominates
+		int32 ArrayLength = 64;
+		FParse::Value(*Params, TEXT("arraylength="), ArrayLength);
+		return BenchmarkKernels(FMath::Max(1, NumCells), FMath::Max(1, ArrayLength), Options.Seed, OutputPath);
+	}
+
+	UPMXlsxImporterBenchmarkDataAsset::bUseWorkerThreads = !Switches.Contains(SERIAL_SWITCH);
+	const bool bKeep = Switches.Contains(KEEP_SWITCH);
+
+	const FString ContentDir = FString::Printf(TEXT("/Game/%s"), BENCHMARK_DIRECTORY);
+	if (UEditorAssetLibrary::DoesDirectoryExist(ContentDir))
+	{
+		UE_LOG(LogPMXlsxImporterTests, Log, TEXT("Deleting assets left behind by a previous benchmark in %s"), *ContentDir);
+		UEditorAssetLibrary::DeleteDirectory(ContentDir);
+	}
+
+	// Settings entries look their class up through the asset manager
+	const FPrimaryAssetType AssetType(TEXT("PMXlsxImporterBenchmark"));
+	UAssetManager::Get().ScanPathForPrimaryAssets(AssetType, ContentDir, UPMXlsxImporterBenchmarkDataAsset::StaticClass(),
+		/*bHasBlueprintClasses:*/ false, /*bIsEditorOnly:*/ true, /*bForceSynchronousScan:*/ true);
+
+	FString Csv = TEXT("Rows,Pass,Workers");
+	for (int32 Phase = 0; Phase < (int32)EPMXlsxImporterPhase::Num; ++Phase)
+	{
+		Csv += TEXT(",");
+		Csv += FPMXlsxImporterStats::GetPhaseName((EPMXlsxImporterPhase)Phase);
+	}
+	Csv += TEXT(",Total,RowsPerSecond,Cells,BytesRead,AssetsSaved,Errors\n");
+
+	int32 NumFailedPasses = 0;
+	for (const int32 NumRows : RowCounts)
+	{
+		const FString XlsxAbsolutePath = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / BENCHMARK_DIRECTORY / FString::Printf(TEXT("Rows%i.xlsx"), NumRows));
+
+		FPMXlsxImporterSettingsEntry Entry;
+		Entry.DataAssetType = AssetType;
+		Entry.XlsxFile.FilePath = XlsxAbsolutePath;
+		Entry.WorksheetName = FPMXlsxImporterBenchmarkWorkbook::WorksheetName;
+		Entry.OutputDir.Path = FString::Printf(TEXT("%s/Rows%i"), BENCHMARK_DIRECTORY, NumRows);
+
+		struct FPass
+		{
+			const TCHAR* Name;
+			int32 SeedOffset;
+		};
+		// Reimport uses the same data, so nothing gets saved. Modify changes every row.
+		const FPass Passes[] = { { TEXT("Create"), 0 }, { TEXT("Reimport"), 0 }, { TEXT("Modify"), 1 } };
+
+		for (const FPass& Pass : Passes)
+		{
+			FPMXlsxImporterBenchmarkWorkbookOptions PassOptions = Options;
+			PassOptions.NumRows = NumRows;
+			PassOptions.Seed = Options.Seed + Pass.SeedOffset;
+			if (!FPMXlsxImporterBenchmarkWorkbook::Write(XlsxAbsolutePath, PassOptions, AssetType))
+			{
+				return 1;
+			}
+
+			UE_LOG(LogPMXlsxImporterTests, Display, TEXT("Benchmarking %s pass with %i rows"), Pass.Name, NumRows);
+
+			FPMXlsxImporterStats Stats;
+			int32 NumErrors = 0;
+			NumFailedPasses += ImportBenchmarkEntry(Entry, Stats, NumErrors) ? 0 : 1;
+			Stats.LogSummary();
+
+			const FPMXlsxImporterStats::FRow Totals = Stats.GetTotals();
+			Csv += FString::Printf(TEXT("%i,%s,%s"), NumRows, Pass.Name, UPMXlsxImporterBenchmarkDataAsset::bUseWorkerThreads ? TEXT("true") : TEXT("false"));
+			for (int32 Phase = 0; Phase < (int32)EPMXlsxImporterPhase::Num; ++Phase)
+			{
+				Csv += FString::Printf(TEXT(",%.6f"), Totals.Seconds[Phase]);
+			}
+			const double TotalSeconds = Totals.GetTotalSeconds();
+			Csv += FString::Printf(TEXT(",%.6f,%.1f,%lld,%lld,%lld,%i\n"),
+				TotalSeconds, TotalSeconds > 0.0 ? Totals.NumRows / TotalSeconds : 0.0, Totals.NumCells, Totals.NumBytesRead, Totals.NumAssetsSaved, NumErrors);
+
+			// Don't let assets from one pass or size hold on to memory during the next
+			CollectGarbage(RF_NoFlags);
+		}
+
+		if (!bKeep)
+		{
+			UEditorAssetLibrary::DeleteDirectory(FString::Printf(TEXT("/Game/%s"), *Entry.OutputDir.Path));
+			IFileManager::Get().Delete(*XlsxAbsolutePath);
+		}
+	}
+
+	if (!bKeep)
+	{
+		UEditorAssetLibrary::DeleteDirectory(ContentDir);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		UE_LOG(LogPMXlsxImporterTests, Error, TEXT("Unable to write benchmark results to %s"), *OutputPath);
+		return 1;
+	}
+	UE_LOG(LogPMXlsxImporterTests, Display, TEXT("Wrote benchmark results to %s"), *OutputPath);
+
+	return NumFailedPasses;
+}
@@ -0,0 +1,34 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PMXlsxImporterBenchmarkCommandlet.generated.h"
+
+// Generates workbooks of several sizes, imports each of them into UPMXlsxImporterBenchmarkDataAssets and writes the
+// time spent in each phase as CSV. Each size is imported three times: creating every asset, reimporting the same
+// data, and importing data where every row has changed. Generated files and assets are deleted afterwards.
+// With -kernels, instead times UPMXlsxDataAsset's parsing functions on their own (see
+// EPMXlsxImporterBenchmarkKernel) and writes the nanoseconds and allocations per cell for each. Only timings are
+// measured here. Whether the kernels parse correctly is checked by the PMXlsxImporter automation tests.
+// Run using -run=PMXlsxImporterBenchmark
+// Options: -rows=<n,n,...> (workbook sizes, default 1000,10000,100000)
+//          -extracolumns=<n> (columns without a matching property, default 0)
+//          -numeric=<ratio> (fraction of the extra columns that hold numbers, default 0.5)
+//          -arraylength=<n> (elements in each array cell, default 8, or 64 with -kernels)
+//          -shared=<ratio> (fraction of text cells that use the shared strings part, default 0.5)
+//          -seed=<n>
+//          -serial (don't parse or validate on worker threads)
+//          -kernels (benchmark the parsing functions instead of whole imports)
+//          -cells=<n> (values parsed by each kernel with -kernels, default 100000)
+//          -output=<path> (default Saved/PMXlsxImporterBenchmark/Results.csv, or Kernels.csv with -kernels)
+//          -keep (don't delete the generated workbooks and assets)
+UCLASS()
+class UPMXlsxImporterBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,339 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterBenchmarkDataAsset.h"
+#include "Math/RandomStream.h"
+#include "UObject/StructOnScope.h"
+
+bool UPMXlsxImporterBenchmarkDataAsset::bUseWorkerThreads = true;
+
+const TCHAR* UPMXlsxImporterBenchmarkDataAsset::GetKernelName(EPMXlsxImporterBenchmarkKernel Kernel)
+{
+	switch (Kernel)
+	{
+	case EPMXlsxImporterBenchmarkKernel::ParseInt: return TEXT("ParseInt");
+	case EPMXlsxImporterBenchmarkKernel::ParseIntFromDouble: return TEXT("ParseIntFromDouble");
+	case EPMXlsxImporterBenchmarkKernel::ParseIntOutOfRange: return TEXT("ParseIntOutOfRange");
+	case EPMXlsxImporterBenchmarkKernel::ParseEnumByName: return TEXT("ParseEnumByName");
+	case EPMXlsxImporterBenchmarkKernel::ParseEnumByValue: return TEXT("ParseEnumByValue");
+	case EPMXlsxImporterBenchmarkKernel::ParseBool: return TEXT("ParseBool");
+	case EPMXlsxImporterBenchmarkKernel::ParseDateTime: return TEXT("ParseDateTime");
+	case EPMXlsxImporterBenchmarkKernel::ParseText: return TEXT("ParseText");
+	case EPMXlsxImporterBenchmarkKernel::ParseArray: return TEXT("ParseArray");
+	case EPMXlsxImporterBenchmarkKernel::ParseFloatArray: return TEXT("ParseFloatArray");
+	case EPMXlsxImporterBenchmarkKernel::ParseNameArray: return TEXT("ParseNameArray");
+	case EPMXlsxImporterBenchmarkKernel::ParseEnumArray: return TEXT("ParseEnumArray");
+	case EPMXlsxImporterBenchmarkKernel::ParseStringArray: return TEXT("ParseStringArray");
+	case EPMXlsxImporterBenchmarkKernel::ParseVector: return TEXT("ParseVector");
+	case EPMXlsxImporterBenchmarkKernel::ImportTextVector: return TEXT("ImportTextVector");
+	case EPMXlsxImporterBenchmarkKernel::ParseVector2D: return TEXT("ParseVector2D");
+	case EPMXlsxImporterBenchmarkKernel::ImportTextVector2D: return TEXT("ImportTextVector2D");
+	case EPMXlsxImporterBenchmarkKernel::ParseRotator: return TEXT("ParseRotator");
+	case EPMXlsxImporterBenchmarkKernel::ImportTextRotator: return TEXT("ImportTextRotator");
+	case EPMXlsxImporterBenchmarkKernel::ParseLinearColor: return TEXT("ParseLinearColor");
+	case EPMXlsxImporterBenchmarkKernel::ImportTextLinearColor: return TEXT("ImportTextLinearColor");
+	case EPMXlsxImporterBenchmarkKernel::ParseIntPoint: return TEXT("ParseIntPoint");
+	case EPMXlsxImporterBenchmarkKernel::ImportTextIntPoint: return TEXT("ImportTextIntPoint");
+	case EPMXlsxImporterBenchmarkKernel::ParsePrimaryAssetId: return TEXT("ParsePrimaryAssetId");
+	case EPMXlsxImporterBenchmarkKernel::ImportTextPrimaryAssetId: return TEXT("ImportTextPrimaryAssetId");
+	case EPMXlsxImporterBenchmarkKernel::ParseSoftObjectPath: return TEXT("ParseSoftObjectPath");
+	case EPMXlsxImporterBenchmarkKernel::ImportTextSoftObjectPath: return TEXT("ImportTextSoftObjectPath");
+	default: return TEXT("Unknown");
+	}
+}
+
+void UPMXlsxImporterBenchmarkDataAsset::GenerateKernelValues(EPMXlsxImporterBenchmarkKernel Kernel, int32 NumValues, int32 ArrayLength, FRandomStream& Random, TArray<FString>& OutValues)
+{
+	const UEnum& Enum = *StaticEnum<EPMXlsxImporterBenchmarkEnum>();
+	// Skip the hidden _MAX value
+	const int32 NumEnumValues = Enum.NumEnums() - 1;
+
+	const auto RandomFloat = [&Random](float Min, float Max) { return FString::SanitizeFloat(Random.FRandRange(Min, Max)); };
+
+	OutValues.Reset(NumValues);
+	for (int32 Index = 0; Index < NumValues; ++Index)
+	{
+		FString& Value = OutValues.AddDefaulted_GetRef();
+		switch (Kernel)
+		{
+		case EPMXlsxImporterBenchmarkKernel::ParseInt:
+			Value = FString::FromInt(Random.RandRange(-1000000, 1000000));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseIntFromDouble:
+			Value = FString::Printf(TEXT("%i.0"), Random.RandRange(-1000000, 1000000));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseIntOutOfRange:
+			Value = FString::FromInt(Random.RandRange(1000, 1000000));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseEnumByName:
+			Value = Enum.GetNameStringByIndex(Random.RandRange(0, NumEnumValues - 1));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseEnumByValue:
+			Value = FString::FromInt((int32)Enum.GetValueByIndex(Random.RandRange(0, NumEnumValues - 1)));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseBool:
+			Value = Random.RandRange(0, 1) ? TEXT("TRUE") : TEXT("false");
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseDateTime:
+			Value = (FDateTime(2000, 1, 1) + FTimespan::FromSeconds(Random.RandRange(0, MAX_int32 - 1))).ToIso8601();
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseText:
+			Value = FString::Printf(TEXT("Benchmark text %i"), Random.RandRange(0, MAX_int32 - 1));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseArray:
+			for (int32 Element = 0; Element < ArrayLength; ++Element)
+			{
+				Value += FString::Printf(Element == 0 ? TEXT("%i") : TEXT(", %i"), Random.RandRange(-1000000, 1000000));
+			}
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseFloatArray:
+			for (int32 Element = 0; Element < ArrayLength; ++Element)
+			{
+				Value += (Element == 0 ? TEXT("") : TEXT(", ")) + FString::SanitizeFloat(Random.FRandRange(-1000.0f, 1000.0f));
+			}
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseEnumArray:
+			// Half by name, half by value, like the enum cells in the import benchmark
+			for (int32 Element = 0; Element < ArrayLength; ++Element)
+			{
+				const int32 EnumIndex = Random.RandRange(0, NumEnumValues - 1);
+				Value += Element == 0 ? TEXT("") : TEXT(", ");
+				Value += Random.RandRange(0, 1) ? Enum.GetNameStringByIndex(EnumIndex) : FString::FromInt((int32)Enum.GetValueByIndex(EnumIndex));
+			}
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseNameArray:
+		case EPMXlsxImporterBenchmarkKernel::ParseStringArray:
+			for (int32 Element = 0; Element < ArrayLength; ++Element)
+			{
+				Value += FString::Printf(Element == 0 ? TEXT("Element%i") : TEXT(", Element%i"), Random.RandRange(0, 1023));
+			}
+			break;
+		// In the form ImportText takes, so the ImportText kernels can parse the same values
+		case EPMXlsxImporterBenchmarkKernel::ParseVector:
+		case EPMXlsxImporterBenchmarkKernel::ImportTextVector:
+			Value = FString::Printf(TEXT("(X=%s,Y=%s,Z=%s)"), *RandomFloat(-100.0f, 100.0f), *RandomFloat(-100.0f, 100.0f), *RandomFloat(-100.0f, 100.0f));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseVector2D:
+		case EPMXlsxImporterBenchmarkKernel::ImportTextVector2D:
+			Value = FString::Printf(TEXT("(X=%s,Y=%s)"), *RandomFloat(-100.0f, 100.0f), *RandomFloat(-100.0f, 100.0f));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseRotator:
+		case EPMXlsxImporterBenchmarkKernel::ImportTextRotator:
+			Value = FString::Printf(TEXT("(Pitch=%s,Yaw=%s,Roll=%s)"), *RandomFloat(-90.0f, 90.0f), *RandomFloat(-180.0f, 180.0f), *RandomFloat(-180.0f, 180.0f));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseLinearColor:
+		case EPMXlsxImporterBenchmarkKernel::ImportTextLinearColor:
+			Value = FString::Printf(TEXT("(R=%s,G=%s,B=%s,A=%s)"), *RandomFloat(0.0f, 1.0f), *RandomFloat(0.0f, 1.0f), *RandomFloat(0.0f, 1.0f), *RandomFloat(0.0f, 1.0f));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseIntPoint:
+		case EPMXlsxImporterBenchmarkKernel::ImportTextIntPoint:
+			Value = FString::Printf(TEXT("(X=%i,Y=%i)"), Random.RandRange(-10000, 10000), Random.RandRange(-10000, 10000));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParsePrimaryAssetId:
+		case EPMXlsxImporterBenchmarkKernel::ImportTextPrimaryAssetId:
+			Value = FString::Printf(TEXT("PMXlsxImporterBenchmark:Row%07i"), Random.RandRange(0, 1023));
+			break;
+		case EPMXlsxImporterBenchmarkKernel::ParseSoftObjectPath:
+		case EPMXlsxImporterBenchmarkKernel::ImportTextSoftObjectPath:
+		{
+			const int32 AssetIndex = Random.RandRange(0, 1023);
+			Value = FString::Printf(TEXT("/Game/PMXlsxImporterBenchmark/Asset%i.Asset%i"), AssetIndex, AssetIndex);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+}
+
+int32 UPMXlsxImporterBenchmarkDataAsset::RunKernel(EPMXlsxImporterBenchmarkKernel Kernel, const TArray<FString>& Values, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	int32 NumParsed = 0;
+	switch (Kernel)
+	{
+	case EPMXlsxImporterBenchmarkKernel::ParseInt:
+	case EPMXlsxImporterBenchmarkKernel::ParseIntFromDouble:
+		for (const FString& Value : Values)
+		{
+			NumParsed += ParseInt<int32>(Value, Int32Value, InOutErrors) ? 1 : 0;
+		}
+		break;
+
+	case EPMXlsxImporterBenchmarkKernel::ParseIntOutOfRange:
+		for (const FString& Value : Values)
+		{
+			NumParsed += ParseInt<int8>(Value, Int8Value, InOutErrors) ? 1 : 0;
+		}
+		break;
+
+	case EPMXlsxImporterBenchmarkKernel::ParseEnumByName:
+	case EPMXlsxImporterBenchmarkKernel::ParseEnumByValue:
+	{
+		const UEnum& Enum = *StaticEnum<EPMXlsxImporterBenchmarkEnum>();
+		uint8 Result = 0;
+		for (const FString& Value : Values)
+		{
+			NumParsed += ParseEnum<uint8>(Value, Enum, Result, InOutErrors) ? 1 : 0;
+		}
+		EnumValue = (EPMXlsxImporterBenchmarkEnum)Result;
+		break;
+	}
+
+	case EPMXlsxImporterBenchmarkKernel::ParseBool:
+		for (const FString& Value : Values)
+		{
+			NumParsed += ParseBool(Value, BoolValue, InOutErrors) ? 1 : 0;
+		}
+		break;
+
+	case EPMXlsxImporterBenchmarkKernel::ParseDateTime:
+		for (const FString& Value : Values)
+		{
+			NumParsed += ParseDateTime(Value, DateTimeValue, InOutErrors) ? 1 : 0;
+		}
+		break;
+
+	case EPMXlsxImporterBenchmarkKernel::ParseText:
+	{
+		const FString PropName = GET_MEMBER_NAME_STRING_CHECKED(UPMXlsxImporterBenchmarkDataAsset, TextValue);
+		for (const FString& Value : Values)
+		{
+			NumParsed += ParseText(PropName, Value, TextValue, InOutErrors) ? 1 : 0;
+		}
+		break;
+	}
+
+	case EPMXlsxImporterBenchmarkKernel::ParseArray:
+		NumParsed += RunArrayKernel(GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, IntArray), &IntArray, Values, InOutErrors);
+		break;
+
+	case EPMXlsxImporterBenchmarkKernel::ParseFloatArray:
+		NumParsed += RunArrayKernel(GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, FloatArray), &FloatArray, Values, InOutErrors);
+		break;
+
+	case EPMXlsxImporterBenchmarkKernel::ParseNameArray:
+		NumParsed += RunArrayKernel(GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, NameArray), &NameArray, Values, InOutErrors);
+		break;
+
+	case EPMXlsxImporterBenchmarkKernel::ParseEnumArray:
+		NumParsed += RunArrayKernel(GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, EnumArray), &EnumArray, Values, InOutErrors);
+		break;
+
+	case EPMXlsxImporterBenchmarkKernel::ParseStringArray:
+		NumParsed += RunArrayKernel(GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, StringArray), &StringArray, Values, InOutErrors);
+		break;
+
+	case EPMXlsxImporterBenchmarkKernel::ParseVector:
+	case EPMXlsxImporterBenchmarkKernel::ParseVector2D:
+	case EPMXlsxImporterBenchmarkKernel::ParseRotator:
+	case EPMXlsxImporterBenchmarkKernel::ParseLinearColor:
+	case EPMXlsxImporterBenchmarkKernel::ParseIntPoint:
+	case EPMXlsxImporterBenchmarkKernel::ParsePrimaryAssetId:
+	case EPMXlsxImporterBenchmarkKernel::ParseSoftObjectPath:
+		NumParsed += RunStructKernel(*GetStructKernelProperty(Kernel), /*bImportText:*/ false, Values, InOutErrors);
+		break;
+
+	case EPMXlsxImporterBenchmarkKernel::ImportTextVector:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextVector2D:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextRotator:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextLinearColor:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextIntPoint:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextPrimaryAssetId:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextSoftObjectPath:
+		NumParsed += RunStructKernel(*GetStructKernelProperty(Kernel), /*bImportText:*/ true, Values, InOutErrors);
+		break;
+
+	default:
+		break;
+	}
+	return NumParsed;
+}
+
+FStructProperty* UPMXlsxImporterBenchmarkDataAsset::GetStructKernelProperty(EPMXlsxImporterBenchmarkKernel Kernel) const
+{
+	FName PropertyName;
+	switch (Kernel)
+	{
+	case EPMXlsxImporterBenchmarkKernel::ParseVector:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextVector:
+		PropertyName = GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, VectorValue);
+		break;
+	case EPMXlsxImporterBenchmarkKernel::ParseVector2D:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextVector2D:
+		PropertyName = GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, Vector2DValue);
+		break;
+	case EPMXlsxImporterBenchmarkKernel::ParseRotator:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextRotator:
+		PropertyName = GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, RotatorValue);
+		break;
+	case EPMXlsxImporterBenchmarkKernel::ParseLinearColor:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextLinearColor:
+		PropertyName = GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, LinearColorValue);
+		break;
+	case EPMXlsxImporterBenchmarkKernel::ParseIntPoint:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextIntPoint:
+		PropertyName = GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, IntPointValue);
+		break;
+	case EPMXlsxImporterBenchmarkKernel::ParsePrimaryAssetId:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextPrimaryAssetId:
+		PropertyName = GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, PrimaryAssetIdValue);
+		break;
+	case EPMXlsxImporterBenchmarkKernel::ParseSoftObjectPath:
+	case EPMXlsxImporterBenchmarkKernel::ImportTextSoftObjectPath:
+		PropertyName = GET_MEMBER_NAME_CHECKED(UPMXlsxImporterBenchmarkDataAsset, SoftObjectPathValue);
+		break;
+	default:
+		return nullptr;
+	}
+	return FindFieldChecked<FStructProperty>(GetClass(), PropertyName);
+}
+
+int32 UPMXlsxImporterBenchmarkDataAsset::CountStructMismatches(FStructProperty& Property, const TArray<FString>& Values, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	FStructOnScope Parsed(Property.Struct);
+	FStructOnScope Imported(Property.Struct);
+	int32 NumMismatches = 0;
+	for (const FString& Value : Values)
+	{
+		const bool bParsed = ParseValue(Property, Value, Parsed.GetStructMemory(), InOutErrors);
+		const bool bImported = Property.ImportText(*Value, Imported.GetStructMemory(), PPF_None, this, &InOutErrors) != nullptr;
+		if (bParsed != bImported || !Property.Identical(Parsed.GetStructMemory(), Imported.GetStructMemory(), PPF_None))
+		{
+			FString ParsedText;
+			FString ImportedText;
+			Property.ExportTextItem(ParsedText, Parsed.GetStructMemory(), nullptr, this, PPF_None);
+			Property.ExportTextItem(ImportedText, Imported.GetStructMemory(), nullptr, this, PPF_None);
+			InOutErrors.Logf(TEXT("%s parsed as %s, but ImportText gives %s"), *Value, *ParsedText, *ImportedText);
+			++NumMismatches;
+		}
+	}
+	return NumMismatches;
+}
+
+int32 UPMXlsxImporterBenchmarkDataAsset::RunArrayKernel(FName PropertyName, void* Array, const TArray<FString>& Values, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	const FArrayProperty& Property = *FindFieldChecked<FArrayProperty>(GetClass(), PropertyName);
+	int32 NumParsed = 0;
+	for (const FString& Value : Values)
+	{
+		NumParsed += ParseArray(Property, Value, Array, InOutErrors) ? 1 : 0;
+	}
+	return NumParsed;
+}
+
+int32 UPMXlsxImporterBenchmarkDataAsset::RunStructKernel(FStructProperty& Property, bool bImportText, const TArray<FString>& Values, FPMXlsxImporterContextLogger& InOutErrors)
+{
+	void* Result = Property.ContainerPtrToValuePtr<void>(this);
+	int32 NumParsed = 0;
+	for (const FString& Value : Values)
+	{
+		if (bImportText)
+		{
+			NumParsed += Property.ImportText(*Value, Result, PPF_None, this, &InOutErrors) != nullptr ? 1 : 0;
+		}
+		else
+		{
+			NumParsed += ParseValue(Property, Value, Result, InOutErrors) ? 1 : 0;
+		}
+	}
+	return NumParsed;
+}
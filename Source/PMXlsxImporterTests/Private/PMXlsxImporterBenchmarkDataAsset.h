@@ -0,0 +1,205 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXlsxDataAsset.h"
+#include "GameplayTagContainer.h"
+#include "PMXlsxImporterBenchmarkDataAsset.generated.h"
+
+UENUM()
+enum class EPMXlsxImporterBenchmarkEnum : uint8
+{
+	First,
+	Second,
+	Third,
+	Fourth,
+};
+
+// The UPMXlsxDataAsset parsing functions measured by UPMXlsxImporterBenchmarkCommandlet's -kernels mode
+enum class EPMXlsxImporterBenchmarkKernel : uint8
+{
+	ParseInt,
+	// Integers written as doubles, e.g. "2.0"
+	ParseIntFromDouble,
+	// Parsed into an int8, so every value fails
+	ParseIntOutOfRange,
+	ParseEnumByName,
+	ParseEnumByValue,
+	ParseBool,
+	ParseDateTime,
+	ParseText,
+	// Comma separated lists parsed into IntArray
+	ParseArray,
+	// Comma separated lists parsed into FloatArray, NameArray, EnumArray and StringArray. Int, float, name and enum
+	// arrays are parsed in bulk, string arrays one element at a time through ParseValue.
+	ParseFloatArray,
+	ParseNameArray,
+	ParseEnumArray,
+	ParseStringArray,
+	// Engine structs parsed by their FPMXlsxImporterStructParsers, each followed by the same values parsed by
+	// FProperty::ImportText, which is what they used before they had a parser
+	ParseVector,
+	ImportTextVector,
+	ParseVector2D,
+	ImportTextVector2D,
+	ParseRotator,
+	ImportTextRotator,
+	ParseLinearColor,
+	ImportTextLinearColor,
+	ParseIntPoint,
+	ImportTextIntPoint,
+	ParsePrimaryAssetId,
+	ImportTextPrimaryAssetId,
+	ParseSoftObjectPath,
+	ImportTextSoftObjectPath,
+	Num,
+};
+
+// Imported by UPMXlsxImporterBenchmarkCommandlet. Has one property of every type UPMXlsxDataAsset::ParseValue
+// supports, including the ones that fall back on FProperty::ImportText. Hidden from class pickers, but not Transient,
+// since the benchmark saves the assets it imports.
+UCLASS(HideDropdown, NotBlueprintable)
+class UPMXlsxImporterBenchmarkDataAsset : public UPMXlsxDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Set by the commandlet's -serial switch to measure the import without worker threads
+	static bool bUseWorkerThreads;
+
+	static const TCHAR* GetKernelName(EPMXlsxImporterBenchmarkKernel Kernel);
+
+	// Random values for Kernel to parse, in the form the import benchmark's workbooks hold them. Every value is meant
+	// to parse, except ParseIntOutOfRange's. ImportText kernels get the same values as the struct kernel before them.
+	static void GenerateKernelValues(EPMXlsxImporterBenchmarkKernel Kernel, int32 NumValues, int32 ArrayLength, FRandomStream& Random, TArray<FString>& OutValues);
+
+	// Calls Kernel's parsing function once with each of Values, logging into InOutErrors. Returns how many parsed.
+	int32 RunKernel(EPMXlsxImporterBenchmarkKernel Kernel, const TArray<FString>& Values, FPMXlsxImporterContextLogger& InOutErrors);
+
+	// Returns the struct property Kernel parses into, or nullptr if it isn't one of the struct kernels
+	FStructProperty* GetStructKernelProperty(EPMXlsxImporterBenchmarkKernel Kernel) const;
+
+	// Returns how many of Values Property's registered parser gives a different result for than ImportText
+	int32 CountStructMismatches(FStructProperty& Property, const TArray<FString>& Values, FPMXlsxImporterContextLogger& InOutErrors);
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	bool BoolValue = false;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	int8 Int8Value = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	int16 Int16Value = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	int32 Int32Value = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	int64 Int64Value = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	uint8 UInt8Value = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	uint16 UInt16Value = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	uint32 UInt32Value = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	float FloatValue = 0.0f;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	double DoubleValue = 0.0;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FString StringValue;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FName NameValue;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FText TextValue;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	EPMXlsxImporterBenchmarkEnum EnumValue = EPMXlsxImporterBenchmarkEnum::First;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FDateTime DateTimeValue;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FPrimaryAssetType PrimaryAssetTypeValue;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FPrimaryAssetId PrimaryAssetIdValue;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FVector VectorValue = FVector::ZeroVector;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FVector2D Vector2DValue = FVector2D::ZeroVector;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FRotator RotatorValue = FRotator::ZeroRotator;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FLinearColor LinearColorValue = FLinearColor::White;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FIntPoint IntPointValue = FIntPoint::ZeroValue;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FSoftObjectPath SoftObjectPathValue;
+
+	// Left empty by the workbook, since the benchmark doesn't register any tags
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	FGameplayTag GameplayTagValue;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	TArray<int32> IntArray;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	TArray<float> FloatArray;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	TArray<FString> StringArray;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	TArray<FName> NameArray;
+
+	UPROPERTY(VisibleAnywhere, Category = Benchmark, meta = (ImportFromXLSX))
+	TArray<EPMXlsxImporterBenchmarkEnum> EnumArray;
+
+protected:
+	// Parses each of Values into Array, the array property named PropertyName
+	int32 RunArrayKernel(FName PropertyName, void* Array, const TArray<FString>& Values, FPMXlsxImporterContextLogger& InOutErrors);
+
+	// Parses each of Values into Property, through its registered parser or, if bImportText, FProperty::ImportText
+	int32 RunStructKernel(FStructProperty& Property, bool bImportText, const TArray<FString>& Values, FPMXlsxImporterContextLogger& InOutErrors);
+
+	virtual bool RequiresValueMap() const override
+	{
+		return false;
+	}
+
+	virtual bool RequiresOriginalForWasModified() const override
+	{
+		return false;
+	}
+
+	virtual bool CanParseArraysInBulk() const override
+	{
+		return true;
+	}
+
+	virtual bool CanParseOnWorkerThreads() const override
+	{
+		return bUseWorkerThreads;
+	}
+
+	virtual bool CanValidateOnWorkerThreads() const override
+	{
+		return bUseWorkerThreads;
+	}
+};
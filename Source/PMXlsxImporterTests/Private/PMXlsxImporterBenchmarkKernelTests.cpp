@@ -0,0 +1,63 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterBenchmarkDataAsset.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const int32 TEST_FLAGS = EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter;
+
+// Values generated for each kernel, with a fixed seed so that failures can be reproduced
+static const int32 NUM_KERNEL_VALUES = 10000;
+static const int32 KERNEL_ARRAY_LENGTH = 8;
+static const int32 RANDOM_SEED = 0;
+
+// Only the first few errors of each kernel are reported, in case something is badly broken
+static const int32 MAX_ERRORS_PER_KERNEL = 5;
+
+// Runs every kernel UPMXlsxImporterBenchmarkCommandlet's -kernels mode times on the values it generates, so that the
+// timings it writes are for parsers that work. Each struct parser also has to give exactly the same results as
+// ImportText, which is what those structs were parsed with before they had a parser.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPMXlsxImporterBenchmarkKernelsTest, "PMXlsxImporter.Benchmark.Kernels", TEST_FLAGS)
+bool FPMXlsxImporterBenchmarkKernelsTest::RunTest(const FString& Parameters)
+{
+	UPMXlsxImporterBenchmarkDataAsset* Asset = NewObject<UPMXlsxImporterBenchmarkDataAsset>(GetTransientPackage());
+	FRandomStream Random(RANDOM_SEED);
+
+	TArray<FString> Values;
+	FStructProperty* PreviousStructProperty = nullptr;
+	for (int32 KernelIndex = 0; KernelIndex < (int32)EPMXlsxImporterBenchmarkKernel::Num; ++KernelIndex)
+	{
+		const EPMXlsxImporterBenchmarkKernel Kernel = (EPMXlsxImporterBenchmarkKernel)KernelIndex;
+		const TCHAR* KernelName = UPMXlsxImporterBenchmarkDataAsset::GetKernelName(Kernel);
+		// Each ImportText kernel parses the same values as the struct kernel before it
+		FStructProperty* StructProperty = Asset->GetStructKernelProperty(Kernel);
+		const bool bImportTextKernel = StructProperty != nullptr && StructProperty == PreviousStructProperty;
+		PreviousStructProperty = StructProperty;
+		if (!bImportTextKernel)
+		{
+			UPMXlsxImporterBenchmarkDataAsset::GenerateKernelValues(Kernel, NUM_KERNEL_VALUES, KERNEL_ARRAY_LENGTH, Random, Values);
+		}
+
+		FPMXlsxImporterContextLogger Errors;
+		const int32 NumParsed = Asset->RunKernel(Kernel, Values, Errors);
+		const int32 ExpectedNumParsed = Kernel == EPMXlsxImporterBenchmarkKernel::ParseIntOutOfRange ? 0 : Values.Num();
+		TestEqual(FString::Printf(TEXT("Values parsed by %s"), KernelName), NumParsed, ExpectedNumParsed);
+
+		if (StructProperty != nullptr && !bImportTextKernel)
+		{
+			FPMXlsxImporterContextLogger MismatchErrors;
+			const int32 NumMismatches = Asset->CountStructMismatches(*StructProperty, Values, MismatchErrors);
+			const TArray<FPMXlsxImporterErrorRecord>& Mismatches = MismatchErrors.GetErrors();
+			for (int32 Index = 0; Index < FMath::Min(Mismatches.Num(), MAX_ERRORS_PER_KERNEL); ++Index)
+			{
+				AddError(FString::Printf(TEXT("%s: %s"), KernelName, *Mismatches[Index].Message));
+			}
+			TestEqual(FString::Printf(TEXT("Values %s parsed differently from ImportText"), KernelName), NumMismatches, 0);
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,431 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterBenchmarkWorkbook.h"
+#include "PMXlsxImporterTestsLog.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+const TCHAR* const FPMXlsxImporterBenchmarkWorkbook::WorksheetName = TEXT("Benchmark");
+
+static const TCHAR* const ENUM_NAMES[] = { TEXT("First"), TEXT("Second"), TEXT("Third"), TEXT("Fourth") };
+
+static void AppendAnsi(TArray<uint8>& Out, const ANSICHAR* String)
+{
+	Out.Append((const uint8*)String, FCStringAnsi::Strlen(String));
+}
+
+static void AppendXmlEscaped(TArray<uint8>& Out, const FString& String)
+{
+	const FTCHARToUTF8 UTF8(*String);
+	for (int32 Index = 0; Index < UTF8.Length(); ++Index)
+	{
+		const ANSICHAR Char = UTF8.Get()[Index];
+		switch (Char)
+		{
+		case '&': AppendAnsi(Out, "&amp;"); break;
+		case '<': AppendAnsi(Out, "&lt;"); break;
+		case '>': AppendAnsi(Out, "&gt;"); break;
+		case '"': AppendAnsi(Out, "&quot;"); break;
+		default: Out.Add((uint8)Char); break;
+		}
+	}
+}
+
+static FString GetColumnName(int32 ColumnIndex)
+{
+	FString Name;
+	for (int32 Column = ColumnIndex + 1; Column > 0; Column = (Column - 1) / 26)
+	{
+		Name.InsertAt(0, (TCHAR)(TEXT('A') + (Column - 1) % 26));
+	}
+	return Name;
+}
+
+// Writes the cells of xl/worksheets/sheet1.xml and collects the shared strings they use
+class FPMXlsxImporterBenchmarkSheetWriter
+{
+public:
+	FPMXlsxImporterBenchmarkSheetWriter(const FPMXlsxImporterBenchmarkWorkbookOptions& InOptions)
+		: Options(InOptions)
+		, Random(InOptions.Seed)
+	{
+	}
+
+	void BeginRow(int32 InRowNumber)
+	{
+		RowNumber = InRowNumber;
+		Column = 0;
+		AppendAnsi(Sheet, "<row r=\"");
+		AppendAnsi(Sheet, TCHAR_TO_ANSI(*FString::FromInt(RowNumber)));
+		AppendAnsi(Sheet, "\">");
+	}
+
+	void EndRow()
+	{
+		AppendAnsi(Sheet, "</row>");
+	}
+
+	void AddNumber(const FString& Value)
+	{
+		BeginCell(nullptr);
+		AppendAnsi(Sheet, "<v>");
+		AppendXmlEscaped(Sheet, Value);
+		AppendAnsi(Sheet, "</v></c>");
+	}
+
+	void AddBool(bool bValue)
+	{
+		BeginCell("b");
+		AppendAnsi(Sheet, bValue ? "<v>1</v></c>" : "<v>0</v></c>");
+	}
+
+	void AddString(const FString& Value, bool bForceShared = false)
+	{
+		if (bForceShared || Random.FRand() < Options.SharedStringRatio)
+		{
+			int32* Index = SharedStringIndices.Find(Value);
+			if (Index == nullptr)
+			{
+				Index = &SharedStringIndices.Add(Value, SharedStrings.Add(Value));
+			}
+			++NumSharedStringReferences;
+
+			BeginCell("s");
+			AppendAnsi(Sheet, "<v>");
+			AppendAnsi(Sheet, TCHAR_TO_ANSI(*FString::FromInt(*Index)));
+			AppendAnsi(Sheet, "</v></c>");
+		}
+		else
+		{
+			BeginCell("inlineStr");
+			AppendAnsi(Sheet, "<is><t>");
+			AppendXmlEscaped(Sheet, Value);
+			AppendAnsi(Sheet, "</t></is></c>");
+		}
+	}
+
+	FRandomStream& GetRandom()
+	{
+		return Random;
+	}
+
+	TArray<uint8> FinishSheet()
+	{
+		TArray<uint8> Part;
+		AppendAnsi(Part, "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n");
+		AppendAnsi(Part, "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\"><sheetData>");
+		Part.Append(Sheet);
+		AppendAnsi(Part, "</sheetData></worksheet>");
+		Sheet.Empty();
+		return Part;
+	}
+
+	TArray<uint8> FinishSharedStrings() const
+	{
+		TArray<uint8> Part;
+		AppendAnsi(Part, "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n");
+		AppendAnsi(Part, TCHAR_TO_ANSI(*FString::Printf(TEXT("<sst xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" count=\"%i\" uniqueCount=\"%i\">"),
+			NumSharedStringReferences, SharedStrings.Num())));
+		for (const FString& String : SharedStrings)
+		{
+			AppendAnsi(Part, "<si><t>");
+			AppendXmlEscaped(Part, String);
+			AppendAnsi(Part, "</t></si>");
+		}
+		AppendAnsi(Part, "</sst>");
+		return Part;
+	}
+
+private:
+	void BeginCell(const ANSICHAR* Type)
+	{
+		AppendAnsi(Sheet, "<c r=\"");
+		AppendAnsi(Sheet, TCHAR_TO_ANSI(*FString::Printf(TEXT("%s%i"), *GetColumnName(Column++), RowNumber)));
+		if (Type != nullptr)
+		{
+			AppendAnsi(Sheet, "\" t=\"");
+			AppendAnsi(Sheet, Type);
+		}
+		AppendAnsi(Sheet, "\">");
+	}
+
+	const FPMXlsxImporterBenchmarkWorkbookOptions& Options;
+	FRandomStream Random;
+
+	TArray<uint8> Sheet;
+	int32 RowNumber = 0;
+	int32 Column = 0;
+
+	TArray<FString> SharedStrings;
+	TMap<FString, int32> SharedStringIndices;
+	int32 NumSharedStringReferences = 0;
+};
+
+// Writes every zip entry stored (uncompressed), which the XLSX format allows
+class FPMXlsxImporterBenchmarkZipWriter
+{
+public:
+	bool AddEntry(const ANSICHAR* Name, const TArray<uint8>& Data)
+	{
+		if ((int64)Zip.Num() + Data.Num() > MAX_uint32)
+		{
+			UE_LOG(LogPMXlsxImporterTests, Error, TEXT("Benchmark workbook is too large for a zip file without zip64"));
+			return false;
+		}
+
+		FEntry& Entry = Entries.AddDefaulted_GetRef();
+		Entry.Name = Name;
+		Entry.Crc32 = crc32(0L, (const Bytef*)Data.GetData(), Data.Num());
+		Entry.Size = Data.Num();
+		Entry.LocalHeaderOffset = Zip.Num();
+
+		WriteUInt32(0x04034b50); // Local file header signature
+		WriteUInt16(20); // Version needed to extract
+		WriteUInt16(0); // Flags
+		WriteUInt16(0); // Compression method: stored
+		WriteUInt16(0); // Modification time
+		WriteUInt16(0x21); // Modification date: 1980-01-01
+		WriteUInt32(Entry.Crc32);
+		WriteUInt32(Entry.Size); // Compressed size
+		WriteUInt32(Entry.Size); // Uncompressed size
+		WriteUInt16(FCStringAnsi::Strlen(Name));
+		WriteUInt16(0); // Extra field length
+		AppendAnsi(Zip, Name);
+		Zip.Append(Data);
+		return true;
+	}
+
+	bool Save(const FString& AbsoluteFilePath)
+	{
+		const uint32 CentralDirectoryOffset = Zip.Num();
+		for (const FEntry& Entry : Entries)
+		{
+			WriteUInt32(0x02014b50); // Central directory header signature
+			WriteUInt16(20); // Version made by
+			WriteUInt16(20); // Version needed to extract
+			WriteUInt16(0); // Flags
+			WriteUInt16(0); // Compression method: stored
+			WriteUInt16(0); // Modification time
+			WriteUInt16(0x21); // Modification date
+			WriteUInt32(Entry.Crc32);
+			WriteUInt32(Entry.Size); // Compressed size
+			WriteUInt32(Entry.Size); // Uncompressed size
+			WriteUInt16(FCStringAnsi::Strlen(Entry.Name));
+			WriteUInt16(0); // Extra field length
+			WriteUInt16(0); // Comment length
+			WriteUInt16(0); // Disk number
+			WriteUInt16(0); // Internal attributes
+			WriteUInt32(0); // External attributes
+			WriteUInt32(Entry.LocalHeaderOffset);
+			AppendAnsi(Zip, Entry.Name);
+		}
+		const uint32 CentralDirectorySize = Zip.Num() - CentralDirectoryOffset;
+
+		WriteUInt32(0x06054b50); // End of central directory signature
+		WriteUInt16(0); // This disk
+		WriteUInt16(0); // Disk with the central directory
+		WriteUInt16(Entries.Num()); // Entries on this disk
+		WriteUInt16(Entries.Num()); // Total entries
+		WriteUInt32(CentralDirectorySize);
+		WriteUInt32(CentralDirectoryOffset);
+		WriteUInt16(0); // Comment length
+
+		if (!FFileHelper::SaveArrayToFile(Zip, *AbsoluteFilePath))
+		{
+			UE_LOG(LogPMXlsxImporterTests, Error, TEXT("Unable to write benchmark workbook %s"), *AbsoluteFilePath);
+			return false;
+		}
+		return true;
+	}
+
+private:
+	struct FEntry
+	{
+		const ANSICHAR* Name;
+		uint32 Crc32;
+		uint32 Size;
+		uint32 LocalHeaderOffset;
+	};
+
+	void WriteUInt16(uint16 Value)
+	{
+		Zip.Add(Value & 0xFF);
+		Zip.Add(Value >> 8);
+	}
+
+	void WriteUInt32(uint32 Value)
+	{
+		WriteUInt16(Value & 0xFFFF);
+		WriteUInt16(Value >> 16);
+	}
+
+	TArray<uint8> Zip;
+	TArray<FEntry> Entries;
+};
+
+static TArray<uint8> ToUTF8(const ANSICHAR* String)
+{
+	TArray<uint8> Data;
+	AppendAnsi(Data, String);
+	return Data;
+}
+
+bool FPMXlsxImporterBenchmarkWorkbook::Write(const FString& AbsoluteFilePath, const FPMXlsxImporterBenchmarkWorkbookOptions& Options, const FPrimaryAssetType& AssetType)
+{
+	FPMXlsxImporterBenchmarkSheetWriter Writer(Options);
+	FRandomStream& Random = Writer.GetRandom();
+
+	// Must match the order of the cells written for each row below
+	TArray<FString> Headers = {
+		TEXT("Name"), TEXT("BoolValue"), TEXT("Int8Value"), TEXT("Int16Value"), TEXT("Int32Value"), TEXT("Int64Value"),
+		TEXT("UInt8Value"), TEXT("UInt16Value"), TEXT("UInt32Value"), TEXT("FloatValue"), TEXT("DoubleValue"),
+		TEXT("StringValue"), TEXT("NameValue"), TEXT("TextValue"), TEXT("EnumValue"), TEXT("DateTimeValue"),
+		TEXT("PrimaryAssetTypeValue"), TEXT("PrimaryAssetIdValue"), TEXT("VectorValue"), TEXT("Vector2DValue"),
+		TEXT("RotatorValue"), TEXT("LinearColorValue"), TEXT("IntPointValue"), TEXT("SoftObjectPathValue"), TEXT("GameplayTagValue"),
+		TEXT("IntArray"), TEXT("FloatArray"), TEXT("StringArray"), TEXT("EnumArray"), TEXT("NameArray"),
+	};
+	for (int32 Index = 0; Index < Options.NumExtraColumns; ++Index)
+	{
+		Headers.Add(FString::Printf(TEXT("Extra%i"), Index));
+	}
+
+	Writer.BeginRow(1);
+	for (const FString& Header : Headers)
+	{
+		Writer.AddString(Header, /*bForceShared:*/ true);
+	}
+	Writer.EndRow();
+
+	// Strings are drawn from pools so that some of them repeat, like they do in real data
+	const int32 StringPoolSize = FMath::Max(1, Options.NumRows / 4);
+	const FDateTime FirstDate(2000, 1, 1);
+	const FString AssetTypeString = AssetType.ToString();
+
+	for (int32 Row = 0; Row < Options.NumRows; ++Row)
+	{
+		Writer.BeginRow(Row + 2);
+		Writer.AddString(FString::Printf(TEXT("Row%07i"), Row));
+		Writer.AddBool(Random.FRand() < 0.5f);
+		Writer.AddNumber(FString::FromInt(Random.RandRange(MIN_int8, MAX_int8)));
+		Writer.AddNumber(FString::FromInt(Random.RandRange(MIN_int16, MAX_int16)));
+		Writer.AddNumber(FString::FromInt(Random.RandRange(-1000000, 1000000)));
+		Writer.AddNumber(FString::Printf(TEXT("%lld"), (int64)Random.RandRange(-1000000, 1000000) * 1000003));
+		Writer.AddNumber(FString::FromInt(Random.RandRange(0, MAX_uint8)));
+		Writer.AddNumber(FString::FromInt(Random.RandRange(0, MAX_uint16)));
+		Writer.AddNumber(FString::FromInt(Random.RandRange(0, MAX_int32 - 1)));
+		Writer.AddNumber(FString::SanitizeFloat(Random.FRandRange(-1000.0f, 1000.0f)));
+		Writer.AddNumber(FString::SanitizeFloat(Random.FRandRange(-1000.0f, 1000.0f) * 1000.0));
+		Writer.AddString(FString::Printf(TEXT("String %i"), Random.RandRange(0, StringPoolSize - 1)));
+		Writer.AddString(FString::Printf(TEXT("Name%i"), Random.RandRange(0, 63)));
+		Writer.AddString(FString::Printf(TEXT("Text for row %i"), Row));
+		// Half by name, half by value
+		const int32 EnumIndex = Random.RandRange(0, UE_ARRAY_COUNT(ENUM_NAMES) - 1);
+		if (Random.FRand() < 0.5f)
+		{
+			Writer.AddString(ENUM_NAMES[EnumIndex]);
+		}
+		else
+		{
+			Writer.AddNumber(FString::FromInt(EnumIndex));
+		}
+		Writer.AddString((FirstDate + FTimespan::FromDays(Random.RandRange(0, 10000))).ToIso8601());
+		Writer.AddString(AssetTypeString);
+		Writer.AddString(FString());
+		Writer.AddString(FString::Printf(TEXT("(X=%s,Y=%s,Z=%s)"),
+			*FString::SanitizeFloat(Random.FRandRange(-100.0f, 100.0f)),
+			*FString::SanitizeFloat(Random.FRandRange(-100.0f, 100.0f)),
+			*FString::SanitizeFloat(Random.FRandRange(-100.0f, 100.0f))));
+		// The shorter forms people type into cells, which ImportText doesn't accept
+		Writer.AddString(FString::Printf(TEXT("%s, %s"),
+			*FString::SanitizeFloat(Random.FRandRange(-100.0f, 100.0f)),
+			*FString::SanitizeFloat(Random.FRandRange(-100.0f, 100.0f))));
+		Writer.AddString(FString::Printf(TEXT("P=%s Y=%s R=%s"),
+			*FString::SanitizeFloat(Random.FRandRange(-90.0f, 90.0f)),
+			*FString::SanitizeFloat(Random.FRandRange(-180.0f, 180.0f)),
+			*FString::SanitizeFloat(Random.FRandRange(-180.0f, 180.0f))));
+		Writer.AddString(FString::Printf(TEXT("%s,%s,%s"),
+			*FString::SanitizeFloat(Random.FRand()),
+			*FString::SanitizeFloat(Random.FRand()),
+			*FString::SanitizeFloat(Random.FRand())));
+		Writer.AddString(FString::Printf(TEXT("%i,%i"), Random.RandRange(-1000, 1000), Random.RandRange(-1000, 1000)));
+		Writer.AddString(FString::Printf(TEXT("/Game/Benchmark/Asset%i.Asset%i"), Row % 64, Row % 64));
+		Writer.AddString(FString());
+
+		TArray<FString> IntElements;
+		TArray<FString> FloatElements;
+		TArray<FString> StringElements;
+		TArray<FString> EnumElements;
+		TArray<FString> NameElements;
+		for (int32 Element = 0; Element < Options.ArrayLength; ++Element)
+		{
+			IntElements.Add(FString::FromInt(Random.RandRange(-1000, 1000)));
+			FloatElements.Add(FString::SanitizeFloat(Random.FRandRange(-1000.0f, 1000.0f)));
+			StringElements.Add(FString::Printf(TEXT("Element%i"), Random.RandRange(0, StringPoolSize - 1)));
+			EnumElements.Add(ENUM_NAMES[Random.RandRange(0, UE_ARRAY_COUNT(ENUM_NAMES) - 1)]);
+			NameElements.Add(FString::Printf(TEXT("Name%i"), Random.RandRange(0, 63)));
+		}
+		Writer.AddString(FString::Join(IntElements, TEXT(",")));
+		Writer.AddString(FString::Join(FloatElements, TEXT(", ")));
+		Writer.AddString(FString::Join(StringElements, TEXT(",")));
+		Writer.AddString(FString::Join(EnumElements, TEXT(",")));
+		Writer.AddString(FString::Join(NameElements, TEXT(",")));
+
+		for (int32 Index = 0; Index < Options.NumExtraColumns; ++Index)
+		{
+			if (Random.FRand() < Options.ExtraNumericRatio)
+			{
+				Writer.AddNumber(FString::FromInt(Random.RandRange(0, 1000000)));
+			}
+			else
+			{
+				Writer.AddString(FString::Printf(TEXT("Extra %i"), Random.RandRange(0, StringPoolSize - 1)));
+			}
+		}
+		Writer.EndRow();
+	}
+
+	const TArray<uint8> SheetPart = Writer.FinishSheet();
+	const TArray<uint8> SharedStringsPart = Writer.FinishSharedStrings();
+
+	FPMXlsxImporterBenchmarkZipWriter Zip;
+	return Zip.AddEntry("[Content_Types].xml", ToUTF8(
+			"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+			"<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+			"<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+			"<Default Extension=\"xml\" ContentType=\"application/xml\"/>"
+			"<Override PartName=\"/xl/workbook.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml\"/>"
+			"<Override PartName=\"/xl/worksheets/sheet1.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>"
+			"<Override PartName=\"/xl/sharedStrings.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sharedStrings+xml\"/>"
+			"<Override PartName=\"/xl/styles.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml\"/>"
+			"</Types>")) &&
+		Zip.AddEntry("_rels/.rels", ToUTF8(
+			"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+			"<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+			"<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument\" Target=\"xl/workbook.xml\"/>"
+			"</Relationships>")) &&
+		Zip.AddEntry("xl/workbook.xml", ToUTF8(
+			"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+			"<workbook xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">"
+			"<sheets><sheet name=\"Benchmark\" sheetId=\"1\" r:id=\"rId1\"/></sheets>"
+			"</workbook>")) &&
+		Zip.AddEntry("xl/_rels/workbook.xml.rels", ToUTF8(
+			"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+			"<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+			"<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet1.xml\"/>"
+			"<Relationship Id=\"rId2\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/sharedStrings\" Target=\"sharedStrings.xml\"/>"
+			"<Relationship Id=\"rId3\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles\" Target=\"styles.xml\"/>"
+			"</Relationships>")) &&
+		Zip.AddEntry("xl/styles.xml", ToUTF8(
+			"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+			"<styleSheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+			"<fonts count=\"1\"><font/></fonts><fills count=\"1\"><fill/></fills><borders count=\"1\"><border/></borders>"
+			"<cellStyleXfs count=\"1\"><xf/></cellStyleXfs><cellXfs count=\"1\"><xf/></cellXfs>"
+			"</styleSheet>")) &&
+		Zip.AddEntry("xl/worksheets/sheet1.xml", SheetPart) &&
+		Zip.AddEntry("xl/sharedStrings.xml", SharedStringsPart) &&
+		Zip.Save(AbsoluteFilePath);
+}
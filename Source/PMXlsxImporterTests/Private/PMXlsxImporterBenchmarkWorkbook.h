@@ -0,0 +1,32 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/PrimaryAssetId.h"
+
+struct FPMXlsxImporterBenchmarkWorkbookOptions
+{
+	int32 NumRows = 1000;
+	// Columns without a matching property, which get read and then ignored
+	int32 NumExtraColumns = 0;
+	// Fraction of the extra columns that hold numbers rather than text
+	float ExtraNumericRatio = 0.5f;
+	// Number of elements in each array cell
+	int32 ArrayLength = 8;
+	// Fraction of text cells written to the shared strings part. The rest are inline strings.
+	float SharedStringRatio = 0.5f;
+	int32 Seed = 0;
+};
+
+// Generates synthetic XLSX files for UPMXlsxImporterBenchmarkCommandlet. Zip entries are stored rather than deflated,
+// so generating a large workbook costs little more than writing it to disk.
+class FPMXlsxImporterBenchmarkWorkbook
+{
+public:
+	static const TCHAR* const WorksheetName;
+
+	// Writes a workbook with a single worksheet whose columns match UPMXlsxImporterBenchmarkDataAsset's properties.
+	// Every value parses without errors. PrimaryAssetTypeValue is set to AssetType.
+	static bool Write(const FString& AbsoluteFilePath, const FPMXlsxImporterBenchmarkWorkbookOptions& Options, const FPrimaryAssetType& AssetType);
+};
@@ -0,0 +1,121 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterCountingMalloc.h"
+#include "HAL/PlatformTLS.h"
+
+FPMXlsxImporterCountingMalloc& FPMXlsxImporterCountingMalloc::Get()
+{
+	// Leaked on purpose, since threads that read GMalloc before Uninstall may call into it at any time
+	static FPMXlsxImporterCountingMalloc* Instance = new FPMXlsxImporterCountingMalloc();
+	return *Instance;
+}
+
+void FPMXlsxImporterCountingMalloc::Install()
+{
+	check(IsInGameThread());
+	// Inner is kept after Uninstall, so it must still be the allocator in use
+	check(GMalloc != this && (Inner == nullptr || Inner == GMalloc));
+	Inner = GMalloc;
+	ThreadId = FPlatformTLS::GetCurrentThreadId();
+	NumAllocations = 0;
+	FPlatformMisc::MemoryBarrier();
+	GMalloc = this;
+}
+
+void FPMXlsxImporterCountingMalloc::Uninstall()
+{
+	check(GMalloc == this);
+	GMalloc = Inner;
+	FPlatformMisc::MemoryBarrier();
+	// Other threads may still be inside one of the functions below, so Inner is left as it is
+}
+
+void FPMXlsxImporterCountingMalloc::CountAllocation()
+{
+	if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+	{
+		++NumAllocations;
+	}
+}
+
+void* FPMXlsxImporterCountingMalloc::Malloc(SIZE_T Count, uint32 Alignment)
+{
+	CountAllocation();
+	return Inner->Malloc(Count, Alignment);
+}
+
+void* FPMXlsxImporterCountingMalloc::Realloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	void* Result = Inner->Realloc(Original, Count, Alignment);
+	// Growing in place isn't a new allocation. Shrinking to 0 frees Original.
+	if (Result != Original && Count > 0)
+	{
+		CountAllocation();
+	}
+	return Result;
+}
+
+void FPMXlsxImporterCountingMalloc::Free(void* Original)
+{
+	Inner->Free(Original);
+}
+
+SIZE_T FPMXlsxImporterCountingMalloc::QuantizeSize(SIZE_T Count, uint32 Alignment)
+{
+	return Inner->QuantizeSize(Count, Alignment);
+}
+
+bool FPMXlsxImporterCountingMalloc::GetAllocationSize(void* Original, SIZE_T& SizeOut)
+{
+	return Inner->GetAllocationSize(Original, SizeOut);
+}
+
+void FPMXlsxImporterCountingMalloc::Trim(bool bTrimThreadCaches)
+{
+	Inner->Trim(bTrimThreadCaches);
+}
+
+void FPMXlsxImporterCountingMalloc::SetupTLSCachesOnCurrentThread()
+{
+	Inner->SetupTLSCachesOnCurrentThread();
+}
+
+void FPMXlsxImporterCountingMalloc::ClearAndDisableTLSCachesOnCurrentThread()
+{
+	Inner->ClearAndDisableTLSCachesOnCurrentThread();
+}
+
+void FPMXlsxImporterCountingMalloc::InitializeStatsMetadata()
+{
+	Inner->InitializeStatsMetadata();
+}
+
+void FPMXlsxImporterCountingMalloc::UpdateStats()
+{
+	Inner->UpdateStats();
+}
+
+void FPMXlsxImporterCountingMalloc::GetAllocatorStats(FGenericMemoryStats& OutStats)
+{
+	Inner->GetAllocatorStats(OutStats);
+}
+
+void FPMXlsxImporterCountingMalloc::DumpAllocatorStats(FOutputDevice& Ar)
+{
+	Inner->DumpAllocatorStats(Ar);
+}
+
+bool FPMXlsxImporterCountingMalloc::IsInternallyThreadSafe() const
+{
+	return Inner->IsInternallyThreadSafe();
+}
+
+bool FPMXlsxImporterCountingMalloc::ValidateHeap()
+{
+	return Inner->ValidateHeap();
+}
+
+const TCHAR* FPMXlsxImporterCountingMalloc::GetDescriptiveName()
+{
+	return TEXT("PMXlsxImporterCountingMalloc");
+}
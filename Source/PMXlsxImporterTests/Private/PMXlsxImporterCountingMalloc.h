@@ -0,0 +1,53 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+
+// Forwards everything to the allocator that was GMalloc when it was installed, counting the allocations made by the
+// thread that installed it. Used by UPMXlsxImporterBenchmarkCommandlet to report allocations per parsed cell.
+// Memory allocated before Install can be freed while it's installed and vice versa, since both go to the same allocator.
+class FPMXlsxImporterCountingMalloc final : public FMalloc
+{
+public:
+	// The one instance, which is never destroyed. Other threads can still be calling into it after Uninstall.
+	static FPMXlsxImporterCountingMalloc& Get();
+
+	// Replaces GMalloc with this until Uninstall is called. Resets the count.
+	void Install();
+	void Uninstall();
+
+	// Calls to Malloc, and to Realloc that allocate new memory, since Install
+	uint64 GetNumAllocations() const
+	{
+		return NumAllocations;
+	}
+
+	// FMalloc interface
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment) override;
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override;
+	virtual void Free(void* Original) override;
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override;
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override;
+	virtual void Trim(bool bTrimThreadCaches) override;
+	virtual void SetupTLSCachesOnCurrentThread() override;
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override;
+	virtual void InitializeStatsMetadata() override;
+	virtual void UpdateStats() override;
+	virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override;
+	virtual void DumpAllocatorStats(FOutputDevice& Ar) override;
+	virtual bool IsInternallyThreadSafe() const override;
+	virtual bool ValidateHeap() override;
+	virtual const TCHAR* GetDescriptiveName() override;
+
+private:
+	FPMXlsxImporterCountingMalloc() = default;
+
+	void CountAllocation();
+
+	FMalloc* Inner = nullptr;
+	uint32 ThreadId = 0;
+	// Only written by ThreadId, so it doesn't need to be atomic
+	uint64 NumAllocations = 0;
+};
@@ -0,0 +1,74 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterTestDataAssets.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const int32 TEST_FLAGS = EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter;
+
+// One worksheet row of string cells under Headers
+static TSharedRef<FPMXlsxImporterWorksheet> MakeTestWorksheet(TArray<FString>&& Headers, const TArray<FString>& Values)
+{
+	TSharedRef<FPMXlsxImporterWorksheet> Worksheet = MakeShared<FPMXlsxImporterWorksheet>(TEXT("Test"));
+	Worksheet->SetHeaders(MoveTemp(Headers));
+	const int32 Row = Worksheet->AddRow();
+	for (int32 Column = 0; Column < Values.Num(); ++Column)
+	{
+		FPMXlsxImporterPythonBridgeCell Cell;
+		Cell.Type = Values[Column].IsEmpty() ? EPMXlsxImporterCellType::Empty : EPMXlsxImporterCellType::String;
+		Worksheet->SetCell(Row, Column, Worksheet->AddString(Values[Column]), Cell);
+	}
+	return Worksheet;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPMXlsxImporterValueMapTest, "PMXlsxImporter.DataAsset.ValueMap", TEST_FLAGS)
+bool FPMXlsxImporterValueMapTest::RunTest(const FString& Parameters)
+{
+	const TSharedRef<FPMXlsxImporterWorksheet> Worksheet = MakeTestWorksheet({ TEXT("Name"), TEXT("IntValue"), TEXT("Notes") }, { TEXT("Asset"), TEXT("42"), TEXT("Not a property") });
+	UPMXlsxImporterValueMapTestDataAsset* Asset = NewObject<UPMXlsxImporterValueMapTestDataAsset>(GetTransientPackage());
+
+	FPMXlsxImporterContextLogger Errors;
+	FPMXlsxImporterTestAccess::ImportRow(*Asset, *Worksheet, 0, Errors);
+
+	TestEqual(TEXT("Errors"), Errors.Num(), 0);
+	TestEqual(TEXT("IntValue"), Asset->IntValue, 42);
+	TestEqual(TEXT("Number of values"), Asset->ImportedValues.Num(), 3);
+	const FString* Notes = Asset->ImportedValues.Find(TEXT("Notes"));
+	if (TestNotNull(TEXT("Notes value"), Notes))
+	{
+		TestEqual(TEXT("Notes value"), *Notes, FString(TEXT("Not a property")));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPMXlsxImporterArrayParseValueTest, "PMXlsxImporter.DataAsset.ArrayElementsUseParseValue", TEST_FLAGS)
+bool FPMXlsxImporterArrayParseValueTest::RunTest(const FString& Parameters)
+{
+	const TSharedRef<FPMXlsxImporterWorksheet> Worksheet = MakeTestWorksheet({ TEXT("Name"), TEXT("IntArray") }, { TEXT("Asset"), TEXT("1, Ten, 3") });
+	UPMXlsxImporterParseValueTestDataAsset* Asset = NewObject<UPMXlsxImporterParseValueTestDataAsset>(GetTransientPackage());
+
+	FPMXlsxImporterContextLogger Errors;
+	FPMXlsxImporterTestAccess::ImportRow(*Asset, *Worksheet, 0, Errors);
+
+	TestEqual(TEXT("Errors"), Errors.Num(), 0);
+	TestTrue(TEXT("IntArray is 1, 10, 3"), Asset->IntArray == TArray<int32>({ 1, 10, 3 }));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPMXlsxImporterWasModifiedOverrideTest, "PMXlsxImporter.DataAsset.WasModifiedOverride", TEST_FLAGS)
+bool FPMXlsxImporterWasModifiedOverrideTest::RunTest(const FString& Parameters)
+{
+	const TSharedRef<FPMXlsxImporterWorksheet> Worksheet = MakeTestWorksheet({ TEXT("Name"), TEXT("IntValue") }, { TEXT("Asset"), TEXT("7") });
+	UPMXlsxImporterWasModifiedTestDataAsset* Asset = NewObject<UPMXlsxImporterWasModifiedTestDataAsset>(GetTransientPackage());
+
+	FPMXlsxImporterContextLogger Errors;
+	FPMXlsxImporterTestAccess::ImportRow(*Asset, *Worksheet, 0, Errors);
+
+	TestEqual(TEXT("Errors"), Errors.Num(), 0);
+	TestEqual(TEXT("IntValue"), Asset->IntValue, 7);
+	TestEqual(TEXT("WasModified calls"), Asset->NumWasModifiedCalls, 1);
+	return true;
+}
+
+#endif
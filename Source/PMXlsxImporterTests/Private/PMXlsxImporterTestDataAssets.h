@@ -0,0 +1,113 @@
+// Copyright 2022 Proletariat, Inc.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXlsxDataAsset.h"
+#include "PMXlsxImporterWorksheet.h"
+#include "PMXlsxImporterTestDataAssets.generated.h"
+
+// Calls UPMXlsxDataAsset's private import and parsing functions, which are otherwise only called by
+// FPMXlsxImporterSettingsEntry::ParseData
+struct FPMXlsxImporterTestAccess
+{
+	static bool ImportRow(UPMXlsxDataAsset& Asset, const FPMXlsxImporterWorksheet& Worksheet, int32 Row, FPMXlsxImporterContextLogger& InOutErrors)
+	{
+		return Asset.ImportRowFromXLSX(Worksheet, Row, InOutErrors);
+	}
+
+	static bool ParseValue(UPMXlsxDataAsset& Asset, FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors)
+	{
+		return Asset.ParseValue(Property, Value, Result, InOutErrors);
+	}
+
+	static bool ParseInt64(UPMXlsxDataAsset& Asset, const FString& Value, int64& OutResult)
+	{
+		return Asset.ParseInt64Internal(Value, OutResult);
+	}
+};
+
+// Overrides ImportFromXLSXImpl with the signature from before rows were stored by column, and keeps the Values it
+// was given
+UCLASS(HideDropdown, NotBlueprintable)
+class UPMXlsxImporterValueMapTestDataAsset : public UPMXlsxDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, Category = Test, meta = (ImportFromXLSX))
+	int32 IntValue = 0;
+
+	TMap<FString, FString> ImportedValues;
+
+protected:
+	virtual void ImportFromXLSXImpl(const TMap<FString, FString>& Values, FPMXlsxImporterContextLogger& InOutErrors) override
+	{
+		ImportedValues = Values;
+		Super::ImportFromXLSXImpl(Values, InOutErrors);
+	}
+};
+
+// Overrides ParseValue to accept "Ten" for int32s, including array elements
+UCLASS(HideDropdown, NotBlueprintable)
+class UPMXlsxImporterParseValueTestDataAsset : public UPMXlsxDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, Category = Test, meta = (ImportFromXLSX))
+	TArray<int32> IntArray;
+
+protected:
+	virtual bool RequiresValueMap() const override
+	{
+		return false;
+	}
+
+	virtual bool ParseValue(FProperty& Property, const FString& Value, void* Result, FPMXlsxImporterContextLogger& InOutErrors) override
+	{
+		if (Property.IsA<FIntProperty>() && Value == TEXT("Ten"))
+		{
+			*(int32*)Result = 10;
+			return true;
+		}
+		return Super::ParseValue(Property, Value, Result, InOutErrors);
+	}
+};
+
+// Overrides WasModified without overriding RequiresOriginalForWasModified, like subclasses written before the
+// snapshot comparison existed
+UCLASS(HideDropdown, NotBlueprintable)
+class UPMXlsxImporterWasModifiedTestDataAsset : public UPMXlsxDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, Category = Test, meta = (ImportFromXLSX))
+	int32 IntValue = 0;
+
+	int32 NumWasModifiedCalls = 0;
+
+protected:
+	virtual bool RequiresValueMap() const override
+	{
+		return false;
+	}
+
+	virtual bool WasModified(UPMXlsxDataAsset* Original) override
+	{
+		++NumWasModifiedCalls;
+		return Super::WasModified(Original);
+	}
+};
+
+// Parsed into by the value parser tests
+UCLASS(HideDropdown, NotBlueprintable)
+class UPMXlsxImporterNumberTestDataAsset : public UPMXlsxDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, Category = Test, meta = (ImportFromXLSX))
+	double DoubleValue = 0.0;
+};
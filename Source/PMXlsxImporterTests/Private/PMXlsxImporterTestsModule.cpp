@@ -0,0 +1,8 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterTestsLog.h"
+#include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY(LogPMXlsxImporterTests);
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, PMXlsxImporterTests)
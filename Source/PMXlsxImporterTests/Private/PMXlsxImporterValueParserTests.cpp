@@ -0,0 +1,190 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterTestDataAssets.h"
+#include "PMXlsxImporterValueParser.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/DefaultValueHelper.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const int32 TEST_FLAGS = EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter;
+
+// Random values of each kind parsed by the equivalence test, with a fixed seed so that failures can be reproduced
+static const int32 NUM_RANDOM_VALUES = 100000;
+static const int32 RANDOM_SEED = 0;
+
+// Values on the edges of what FPMXlsxImporterValueParser accepts, parsed as both integers and decimals
+static const TCHAR* const EDGE_CASE_NUMBERS[] = {
+	TEXT(""), TEXT(" "), TEXT("0"), TEXT("-0"), TEXT("+5"), TEXT(" 42 "), TEXT("\t7"), TEXT("007"), TEXT("2.0"), TEXT("2.5"),
+	TEXT("1."), TEXT(".5"), TEXT("-.5"), TEXT("1e3"), TEXT("1E+3"), TEXT("1e-5"), TEXT("1.5E400"), TEXT("1e"), TEXT("0x1F"),
+	TEXT("1,000"), TEXT("1f"), TEXT("inf"), TEXT("nan"), TEXT("--1"), TEXT("9223372036854775807"),
+	TEXT("-9223372036854775808"), TEXT("9223372036854775808"), TEXT("12345678901234567890"), TEXT("0.1"),
+	TEXT("123456789012345678"), TEXT("1.7976931348623157E308"), TEXT("4.9E-324"),
+};
+
+// How UPMXlsxDataAsset::ParseInt64Internal parsed integers before it used FPMXlsxImporterValueParser
+static bool ParseInt64WithHelpers(const FString& Value, int64& OutResult)
+{
+	if (FDefaultValueHelper::ParseInt64(Value, OutResult))
+	{
+		return true;
+	}
+
+	double DoubleResult = 0.0;
+	if (FDefaultValueHelper::ParseDouble(Value, DoubleResult) && FMath::RoundToZero(DoubleResult) == DoubleResult)
+	{
+		OutResult = (int64)DoubleResult;
+		return true;
+	}
+	return false;
+}
+
+// Random digits with a decimal point and exponent somewhere, the way Excel and people write numbers
+static FString GenerateDecimalString(FRandomStream& Random)
+{
+	FString Digits;
+	const int32 NumDigits = Random.RandRange(1, 20);
+	for (int32 Index = 0; Index < NumDigits; ++Index)
+	{
+		Digits.AppendChar(TEXT('0') + Random.RandRange(0, 9));
+	}
+
+	const int32 PointIndex = Random.RandRange(0, NumDigits);
+	if (PointIndex < NumDigits)
+	{
+		Digits.InsertAt(PointIndex, TEXT('.'));
+	}
+	if (Random.FRand() < 0.3f)
+	{
+		Digits += FString::Printf(TEXT("%s%i"), Random.FRand() < 0.5f ? TEXT("E") : TEXT("e-"), Random.RandRange(0, 30));
+	}
+	return (Random.FRand() < 0.5f ? TEXT("-") : TEXT("")) + Digits;
+}
+
+// Integers as cells hold them, including "2.0", exponents and whitespace
+static FString GenerateIntegerString(FRandomStream& Random)
+{
+	const int64 Value = ((int64)Random.RandRange(MIN_int32, MAX_int32) << Random.RandRange(0, 31)) + Random.RandRange(0, 1000);
+	switch (Random.RandRange(0, 4))
+	{
+	case 0: return FString::Printf(TEXT("%lld"), Value);
+	case 1: return FString::Printf(TEXT("%lld.0"), Value);
+	case 2: return FString::Printf(TEXT(" %lld\t"), Value);
+	case 3: return FString::Printf(TEXT("%lldE%i"), Value % 100000, Random.RandRange(0, 12));
+	default: return FString::Printf(TEXT("%i.%iE%i"), Random.RandRange(-9, 9), Random.RandRange(0, 999), Random.RandRange(0, 6));
+	}
+}
+
+// Valid and invalid dates with every precision FDateTime::ParseIso8601 accepts
+static FString GenerateDateString(FRandomStream& Random)
+{
+	const FDateTime DateTime(FDateTime::MinValue().GetTicks() + (int64)(Random.GetFraction() * (double)FDateTime::MaxValue().GetTicks()));
+	switch (Random.RandRange(0, 4))
+	{
+	case 0: return DateTime.ToIso8601();
+	case 1: return FString::Printf(TEXT("%04i-%02i-%02i"), DateTime.GetYear(), DateTime.GetMonth(), DateTime.GetDay());
+	case 2: return FString::Printf(TEXT("%04i-%02i-%02iT%02i:%02i:%02i.%i"), DateTime.GetYear(), DateTime.GetMonth(), DateTime.GetDay(), DateTime.GetHour(), DateTime.GetMinute(), DateTime.GetSecond(), Random.RandRange(0, 99));
+	case 3: return FString::Printf(TEXT("%04i-%02i-%02iT%02i:%02i:%02iZ"), DateTime.GetYear(), DateTime.GetMonth(), DateTime.GetDay(), DateTime.GetHour(), DateTime.GetMinute(), DateTime.GetSecond());
+	default: return FString::Printf(TEXT("%04i-%02i-%02iT%02i:%02i:%02i"), DateTime.GetYear(), Random.RandRange(0, 13), Random.RandRange(0, 32), Random.RandRange(0, 24), Random.RandRange(0, 60), Random.RandRange(0, 60));
+	}
+}
+
+// Parses values the way UPMXlsxDataAsset does now, and the way it did before FPMXlsxImporterValueParser, and counts
+// every value that one accepts and the other rejects, or that both accept with different results. Values
+// FPMXlsxImporterValueParser rejects fall back on the old parsers, so any difference is a change in behavior.
+class FPMXlsxImporterValueParserComparison
+{
+public:
+	FPMXlsxImporterValueParserComparison(FAutomationTestBase& InTest)
+		: Test(InTest)
+		, Asset(NewObject<UPMXlsxImporterNumberTestDataAsset>(GetTransientPackage()))
+		, DoubleProperty(*FindFProperty<FProperty>(UPMXlsxImporterNumberTestDataAsset::StaticClass(), GET_MEMBER_NAME_CHECKED(UPMXlsxImporterNumberTestDataAsset, DoubleValue)))
+	{
+	}
+
+	void CompareInteger(const FString& Value)
+	{
+		int64 Expected = 0;
+		int64 Actual = 0;
+		const bool bExpected = ParseInt64WithHelpers(Value, Expected);
+		const bool bActual = FPMXlsxImporterTestAccess::ParseInt64(*Asset, Value, Actual);
+		Compare(TEXT("Integer"), Value, bExpected, bActual, bExpected && bActual && Expected != Actual,
+			FString::Printf(TEXT("%lld"), Expected), FString::Printf(TEXT("%lld"), Actual));
+	}
+
+	// Float properties were parsed by ImportText, which converts through a double
+	void CompareDecimal(const FString& Value)
+	{
+		FPMXlsxImporterContextLogger Errors;
+		double Expected = 0.0;
+		double Actual = 0.0;
+		const bool bExpected = DoubleProperty.ImportText(*Value, &Expected, PPF_None, Asset, &Errors) != nullptr;
+		const bool bActual = FPMXlsxImporterTestAccess::ParseValue(*Asset, DoubleProperty, Value, &Actual, Errors);
+		Compare(TEXT("Decimal"), Value, bExpected, bActual, bExpected && bActual && FMemory::Memcmp(&Expected, &Actual, sizeof(double)) != 0,
+			FString::Printf(TEXT("%.17g"), Expected), FString::Printf(TEXT("%.17g"), Actual));
+	}
+
+	// Only the ISO8601 part of UPMXlsxDataAsset::ParseDateTime. Serial dates are new, and aren't ISO8601 strings.
+	void CompareDate(const FString& Value)
+	{
+		FDateTime Expected;
+		FDateTime Actual;
+		const bool bExpected = FDateTime::ParseIso8601(*Value, Expected);
+		const bool bActual = FPMXlsxImporterValueParser::ParseIso8601(FStringView(*Value, Value.Len()), Actual) || FDateTime::ParseIso8601(*Value, Actual);
+		Compare(TEXT("Date"), Value, bExpected, bActual, bExpected && bActual && Expected != Actual,
+			Expected.ToIso8601(), Actual.ToIso8601());
+	}
+
+	int32 GetNumDifferences() const
+	{
+		return NumDifferences;
+	}
+
+private:
+	void Compare(const TCHAR* Kind, const FString& Value, bool bExpected, bool bActual, bool bDifferentResult, const FString& Expected, const FString& Actual)
+	{
+		if (bExpected == bActual && !bDifferentResult)
+		{
+			return;
+		}
+
+		// Only the first few, in case something is badly broken
+		if (++NumDifferences <= 20)
+		{
+			Test.AddError(FString::Printf(TEXT("%s \"%s\" %s, expected it to %s"), Kind, *Value,
+				bActual ? *FString::Printf(TEXT("parsed as %s"), *Actual) : TEXT("didn't parse"),
+				bExpected ? *FString::Printf(TEXT("parse as %s"), *Expected) : TEXT("fail to parse")
+			));
+		}
+	}
+
+	FAutomationTestBase& Test;
+	UPMXlsxImporterNumberTestDataAsset* Asset;
+	FProperty& DoubleProperty;
+	int32 NumDifferences = 0;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPMXlsxImporterValueParserEquivalenceTest, "PMXlsxImporter.ValueParser.MatchesEngineParsers", TEST_FLAGS)
+bool FPMXlsxImporterValueParserEquivalenceTest::RunTest(const FString& Parameters)
+{
+	FPMXlsxImporterValueParserComparison Comparison(*this);
+
+	for (const TCHAR* Value : EDGE_CASE_NUMBERS)
+	{
+		Comparison.CompareInteger(Value);
+		Comparison.CompareDecimal(Value);
+	}
+
+	FRandomStream Random(RANDOM_SEED);
+	for (int32 Index = 0; Index < NUM_RANDOM_VALUES; ++Index)
+	{
+		Comparison.CompareInteger(GenerateIntegerString(Random));
+		Comparison.CompareDecimal(GenerateDecimalString(Random));
+		Comparison.CompareDate(GenerateDateString(Random));
+	}
+
+	TestEqual(TEXT("Values parsed differently"), Comparison.GetNumDifferences(), 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,44 @@
+// Copyright 2022 Proletariat, Inc.
+
+#include "PMXlsxImporterWorksheet.h"
+#include "PMXlsxImporterPythonBridge.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const int32 TEST_FLAGS = EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter;
+
+// Rows like the ones the Python reader returns for a worksheet whose "Notes" column is blank in every row
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPMXlsxImporterWorksheetBlankColumnTest, "PMXlsxImporter.Worksheet.BlankColumn", TEST_FLAGS)
+bool FPMXlsxImporterWorksheetBlankColumnTest::RunTest(const FString& Parameters)
+{
+	TArray<FPMXlsxImporterPythonBridgeDataAssetInfo> Rows;
+	for (const TCHAR* AssetName : { TEXT("First"), TEXT("Second") })
+	{
+		FPMXlsxImporterPythonBridgeDataAssetInfo& Row = Rows.AddDefaulted_GetRef();
+		Row.AssetName = AssetName;
+		Row.Data.Add(TEXT("Name"), AssetName);
+		Row.Data.Add(TEXT("Notes"), FString());
+	}
+
+	const TSharedRef<FPMXlsxImporterWorksheet> Worksheet = FPMXlsxImporterWorksheet::FromRows(TEXT("Test"), Rows);
+
+	TestEqual(TEXT("Number of rows"), Worksheet->GetNumRows(), 2);
+	TestEqual(TEXT("Number of columns"), Worksheet->GetNumColumns(), 2);
+	const int32 NotesColumn = Worksheet->FindColumn(TEXT("Notes"));
+	if (TestNotEqual(TEXT("Notes column"), NotesColumn, int32(INDEX_NONE)))
+	{
+		for (int32 Row = 0; Row < Worksheet->GetNumRows(); ++Row)
+		{
+			TestTrue(TEXT("Notes value is empty"), Worksheet->GetValue(Row, NotesColumn).IsEmpty());
+			TestTrue(TEXT("Notes cell is empty"), Worksheet->GetCell(Row, NotesColumn).Type == EPMXlsxImporterCellType::Empty);
+		}
+
+		TMap<FString, FString> Values;
+		Worksheet->MakeValueMap(0, Values);
+		TestTrue(TEXT("Value map has Notes"), Values.Contains(TEXT("Notes")));
+	}
+	return true;
+}
+
+#endif